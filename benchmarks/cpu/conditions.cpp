@@ -0,0 +1,145 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <vector>
+
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+
+namespace {
+
+using namespace fgba;
+
+// what conditions used to be checked with, kept around to compare the table against
+[[nodiscard]]constexpr auto switch_condition_passed(u32 const psr, u32 const cond) noexcept
+    -> bool {
+    bool const n = (psr & cpu::ccf::n) != 0;
+    bool const z = (psr & cpu::ccf::z) != 0;
+    bool const c = (psr & cpu::ccf::c) != 0;
+    bool const v = (psr & cpu::ccf::v) != 0;
+    switch (cond) {
+        case 0x0: return z;
+        case 0x1: return not z;
+        case 0x2: return c;
+        case 0x3: return not c;
+        case 0x4: return n;
+        case 0x5: return not n;
+        case 0x6: return v;
+        case 0x7: return not v;
+        case 0x8: return c and not z;
+        case 0x9: return not c or z;
+        case 0xa: return n == v;
+        case 0xb: return n != v;
+        case 0xc: return not z and n == v;
+        case 0xd: return z or n != v;
+        case 0xe: return true;
+        default:  return false;
+    }
+}
+
+struct check {
+    u32 psr;
+    cpu::arm::instruction instruction;
+};
+
+// one in al_every instructions is al, the rest have random conditions
+[[nodiscard]]auto condition_stream(u32 const al_every)
+    -> std::vector<check> {
+    auto random = bench::noise{};
+    auto result = std::vector<check>(bench::stream_length);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        auto const cond = i % al_every == 0 ? 0xe_u32 : random() % 15;
+        result[i] = {.psr = random() & 0xf000'0000, .instruction = cpu::arm::instruction{word{cond << 28}}};
+    }
+    return result;
+}
+
+// pseudo random r3 to test against: eor r3, r3, r3, lsl #13 / lsr #17 / lsl #5
+constexpr u32 xorshift_r3[] = {0xe023'3683, 0xe023'38a3, 0xe023'3283};
+// r3 is zero after reset, so adding the seed sets it
+constexpr u32 add_r3_seed   = 0xe283'3091;
+constexpr u32 tst_r3_bit0   = 0xe313'0001;
+// skips the one instruction right after it
+constexpr u32 beq_skip      = 0x0a00'0000;
+constexpr u32 add_r2_1      = 0xe282'2001;
+constexpr u32 addne_r2_1    = 0x1282'2001;
+constexpr u32 loop_start    = 0x4;
+constexpr u32 unit_count    = 512;
+
+// count of set bits in r3 as it changes, either jumping over the add or predicating it.
+// ends with a branch back to the start of the loop
+[[nodiscard]]auto counting_program(bool const predicated)
+    -> bench::flat_memory {
+    auto memory = bench::flat_memory{};
+    auto at = u32{0};
+    memory.storage[at++] = add_r3_seed;
+    for (u32 unit = 0; unit < unit_count; ++unit) {
+        for (auto const op : xorshift_r3) memory.storage[at++] = op;
+        // bit rotates through all 16 even rotations of 1
+        memory.storage[at++] = tst_r3_bit0 | ((unit % 16) << 8);
+        if (predicated) {
+            memory.storage[at++] = addne_r2_1;
+        } else {
+            memory.storage[at++] = beq_skip;
+            memory.storage[at++] = add_r2_1;
+        }
+    }
+    auto const offset = (loop_start - (at * 4 + 8)) >> 2;
+    memory.storage[at] = 0xea00'0000 | (offset & 0x00ff'ffff);
+    return memory;
+}
+
+// one trip through the loop
+auto run_loop(cpu::arm7tdmi& processor)
+    -> u32 {
+    do {
+        processor.execute_block();
+    } while (processor.get_regitsters_contents()[cpu::pc].value - 8 != loop_start);
+    return processor.get_regitsters_contents()[2].value;
+}
+
+} // namespace
+
+TEST_CASE("condition check throughput", "[!benchmark][conditions]") {
+    auto const mixed   = condition_stream(1);
+    auto const typical = condition_stream(16);
+    for (auto const& [psr, instruction] : mixed) {
+        REQUIRE(switch_condition_passed(psr, instruction.value >> 28) == cpu::condition_passed(psr, instruction.value >> 28));
+    }
+
+    BENCHMARK("switch, random conditions, 4096 checks") {
+        auto passed = u32{0};
+        for (auto const& [psr, instruction] : mixed) passed += switch_condition_passed(psr, instruction.value >> 28);
+        return passed;
+    };
+    BENCHMARK("table, random conditions, 4096 checks") {
+        auto passed = u32{0};
+        for (auto const& [psr, instruction] : mixed) passed += cpu::condition_passed(psr, instruction.value >> 28);
+        return passed;
+    };
+    BENCHMARK("switch, mostly al, 4096 checks") {
+        auto passed = u32{0};
+        for (auto const& [psr, instruction] : typical) passed += switch_condition_passed(psr, instruction.value >> 28);
+        return passed;
+    };
+    BENCHMARK("table with al fast path, mostly al, 4096 checks") {
+        auto passed = u32{0};
+        for (auto const& [psr, instruction] : typical) {
+            passed += cpu::is_unconditional(instruction) or cpu::condition_passed(psr, instruction.value >> 28);
+        }
+        return passed;
+    };
+}
+
+TEST_CASE("branchy against predicated code", "[!benchmark][conditions]") {
+    for (auto const predicated : {false, true}) {
+        auto memory = counting_program(predicated);
+        cpu::arm7tdmi processor;
+        processor.connect_bus(cpu::connector{memory});
+        processor.reset();
+        BENCHMARK(predicated ? "predicated add, 512 tests" : "add skipped by a branch, 512 tests") {
+            return run_loop(processor);
+        };
+    }
+}
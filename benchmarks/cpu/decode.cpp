@@ -0,0 +1,67 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+#include <vector>
+
+#include "emulator/cpu/opcodes.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+
+namespace {
+
+using namespace fgba;
+
+struct instruction_class {
+    std::string name;
+    std::vector<u32> encodings;
+    // bits which can be anything without changing the class
+    u32 mask;
+};
+
+// everything is unconditional, condition field doesn't take part in decoding anyway
+auto const arm_classes = std::vector<instruction_class>{
+    {"data processing, immediate",
+        {0xe280'0000, 0xe240'0000, 0xe3a0'0000, 0xe350'0000, 0xe200'0000, 0xe380'0000}, 0x000f'ffff},
+    {"data processing, shift by immediate",
+        {0xe080'0000, 0xe040'0000, 0xe1a0'0000, 0xe150'0000, 0xe090'0000}, 0x000f'ffef},
+    {"data processing, shift by register",
+        {0xe080'0010, 0xe040'0010, 0xe1a0'0010, 0xe150'0010, 0xe090'0010}, 0x000f'ff6f},
+    {"branch",
+        {0xea00'0000, 0xeb00'0000}, 0x00ff'ffff},
+    {"single data transfer",
+        {0xe590'0000, 0xe580'0000, 0xe5d0'0000, 0xe790'0000}, 0x000f'ffef},
+    {"halfword transfer",
+        {0xe1d0'00b0, 0xe1c0'00b0, 0xe1d0'00d0, 0xe1d0'00f0}, 0x000f'ff0f},
+    {"block transfer",
+        {0xe890'0000, 0xe880'0000, 0xe920'0000, 0xe8bd'0000}, 0x000f'ffff},
+    {"multiply",
+        {0xe000'0090, 0xe020'0090, 0xe080'0090, 0xe0c0'0090}, 0x000f'ff0f},
+};
+
+} // namespace
+
+TEST_CASE("arm decode throughput", "[!benchmark][decoding]") {
+    for (auto const& [name, encodings, mask] : arm_classes) {
+        auto const stream = bench::synthetic_stream(encodings, mask);
+        BENCHMARK(name + ", 4096 instructions") {
+            auto sum = std::size_t{0};
+            for (auto const opcode : stream) {
+                sum += cpu::decode(cpu::arm::instruction{word{opcode}}).as_index();
+            }
+            return sum;
+        };
+    }
+}
+
+TEST_CASE("thumb decode throughput", "[!benchmark][decoding][thumb]") {
+    // thumb encoding space is dense enough that random halfwords are a fair mix
+    auto const stream = bench::synthetic_stream(std::vector<u32>{0}, 0xffff);
+    BENCHMARK("any thumb instruction, 4096 instructions") {
+        auto sum = std::size_t{0};
+        for (auto const opcode : stream) {
+            sum += cpu::decode(cpu::thumb::instruction{hword{static_cast<u16>(opcode)}}).as_index();
+        }
+        return sum;
+    };
+}
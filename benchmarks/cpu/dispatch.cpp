@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/block-cache.hpp"
+#include "emulator/cpu/instruction-impl/implementation.hpp"
+#include "emulator/cpu/opcodes.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+
+namespace {
+
+using namespace fgba;
+
+constexpr u32 no_pc_destination = ~0x0000'8000_u32;
+
+struct dispatch_class {
+    std::string name;
+    std::vector<u32> encodings;
+    u32 mask;
+};
+
+auto const dispatch_classes = std::vector<dispatch_class>{
+    {"data processing, immediate",
+        {0xe280'0000, 0xe240'0000, 0xe3a0'0000, 0xe200'0000, 0xe380'0000}, 0x000f'ffff},
+    {"data processing, shift by immediate, sets flags",
+        {0xe090'0000, 0xe050'0000, 0xe150'0000, 0xe010'0000, 0xe1b0'0000}, 0x000f'ffef},
+};
+
+// stream cut into blocks as long as the ones block cache makes, the way both are laid out there
+struct blocks {
+    std::vector<std::vector<cpu::block_cache::entry>> entries;
+    std::vector<std::vector<cpu::arm::threaded_entry>> threaded;
+};
+
+[[nodiscard]]auto make_blocks(std::vector<u32> const& stream)
+    -> blocks {
+    auto result = blocks{};
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+        if (i % cpu::block_cache::max_block_length == 0) {
+            result.entries.emplace_back();
+            result.threaded.emplace_back();
+        }
+        auto const instruction = cpu::arm::instruction{word{stream[i]}};
+        auto const spec = cpu::decode(instruction);
+        // a null handler would be called, not skipped
+        REQUIRE(cpu::arm::handler_for(spec) != nullptr);
+        result.entries.back().push_back({cpu::arm::handler_for(spec), instruction});
+        result.threaded.back().push_back({cpu::arm::threaded_handler_for(spec), instruction});
+    }
+    for (auto& block : result.threaded) block.push_back({cpu::arm::threaded_exit(), cpu::arm::instruction{}});
+    return result;
+}
+
+// the whole stream in memory with a branch back to the start in place of its last instruction
+[[nodiscard]]auto looping_program(std::vector<u32> const& stream)
+    -> bench::flat_memory {
+    auto memory = bench::flat_memory{};
+    std::ranges::copy(stream, memory.storage.begin());
+    auto const last   = static_cast<u32>(memory.storage.size() - 1);
+    auto const offset = (0 - (last * 4 + 8)) >> 2;
+    memory.storage[last] = 0xea00'0000 | (offset & 0x00ff'ffff);
+    return memory;
+}
+
+} // namespace
+
+TEST_CASE("block dispatch", "[!benchmark][execution]") {
+    bench::flat_memory memory;
+    cpu::arm7tdmi processor;
+    processor.connect_bus(cpu::connector{memory});
+    processor.reset();
+
+    for (auto const& [name, encodings, mask] : dispatch_classes) {
+        auto const code = make_blocks(bench::synthetic_stream(encodings, mask & no_pc_destination));
+        BENCHMARK("call per instruction, " + name + ", 4096 instructions") {
+            for (auto const& block : code.entries) {
+                static_cast<void>(cpu::arm::run_entries(processor, block, processor.code_generation()));
+            }
+            return processor.get_regitsters_contents()[0].value;
+        };
+        BENCHMARK("threaded, " + name + ", 4096 instructions") {
+            for (auto const& block : code.threaded) {
+                static_cast<void>(cpu::arm::run_threaded(processor, block.data(), processor.code_generation()));
+            }
+            return processor.get_regitsters_contents()[0].value;
+        };
+    }
+}
+
+// same loop whichever way blocks end up being run, compare builds with and without FGBA_ENABLE_JIT
+TEST_CASE("block execution", "[!benchmark][execution]") {
+    for (auto const& [name, encodings, mask] : dispatch_classes) {
+        auto memory = looping_program(bench::synthetic_stream(encodings, mask & no_pc_destination));
+        cpu::arm7tdmi processor;
+        processor.connect_bus(cpu::connector{memory});
+        processor.reset();
+        BENCHMARK("execute_block, " + name + ", 4096 instructions") {
+            do {
+                processor.execute_block();
+            } while (processor.get_regitsters_contents()[cpu::pc].value != 8);
+            return processor.get_regitsters_contents()[0].value;
+        };
+    }
+}
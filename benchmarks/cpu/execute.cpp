@@ -0,0 +1,84 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/instruction-impl/implementation.hpp"
+#include "emulator/cpu/opcodes.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+
+namespace {
+
+using namespace fgba;
+
+using decoded_stream = std::vector<std::pair<cpu::arm::instruction_spec, cpu::arm::instruction>>;
+
+// decoding is measured separately, here it is done upfront
+[[nodiscard]]auto predecode(std::vector<u32> const& stream)
+    -> decoded_stream {
+    auto result = decoded_stream{};
+    result.reserve(stream.size());
+    for (auto const opcode : stream) {
+        auto const instruction = cpu::arm::instruction{word{opcode}};
+        result.emplace_back(cpu::decode(instruction), instruction);
+    }
+    return result;
+}
+
+// scrambled bits never select pc as a destination, that would leave the stream
+constexpr u32 no_pc_destination = ~0x0000'8000_u32;
+
+struct execution_class {
+    std::string name;
+    std::vector<u32> encodings;
+    u32 mask;
+};
+
+auto const execution_classes = std::vector<execution_class>{
+    {"data processing, immediate",
+        {0xe280'0000, 0xe240'0000, 0xe3a0'0000, 0xe200'0000, 0xe380'0000}, 0x000f'ffff},
+    {"data processing, immediate, sets flags",
+        {0xe290'0000, 0xe250'0000, 0xe350'0000, 0xe210'0000, 0xe370'0000}, 0x000f'ffff},
+    {"data processing, shift by immediate",
+        {0xe080'0000, 0xe040'0000, 0xe1a0'0000, 0xe000'0000, 0xe180'0000}, 0x000f'ffef},
+    {"data processing, shift by immediate, sets flags",
+        {0xe090'0000, 0xe050'0000, 0xe150'0000, 0xe010'0000, 0xe1b0'0000}, 0x000f'ffef},
+    {"data processing, shift by register",
+        {0xe080'0010, 0xe040'0010, 0xe1a0'0010, 0xe000'0010, 0xe180'0010}, 0x000f'ff6f},
+    // registers stay below r8 and the memory wraps, so any address they end up with is fine
+    {"multiply",
+        {0xe000'0090, 0xe020'0090, 0xe010'0090, 0xe080'0090, 0xe0c0'0090, 0xe0a0'0090, 0xe0f0'0090}, 0x0007'7707},
+    // up and down, with and without write back
+    {"load/store, immediate offset",
+        {0xe590'0000, 0xe580'0000, 0xe5d0'0000, 0xe5c0'0000, 0xe1d0'00b0, 0xe1c0'00b0, 0xe1d0'00f0}, 0x00a7'7f0f},
+    {"load/store, register offset",
+        {0xe790'0000, 0xe780'0000, 0xe7d0'0000, 0xe7c0'0000}, 0x00a7'7fe7},
+    {"ldm/stm",
+        {0xe890'0000, 0xe880'0000, 0xe910'0000, 0xe900'0000}, 0x00a7'7fff},
+    // every one of them flushes and refills the pipeline through the bus
+    {"branch",
+        {0xea00'0000, 0xeb00'0000}, 0x0000'03ff},
+};
+
+} // namespace
+
+TEST_CASE("arm execute throughput", "[!benchmark][execution]") {
+    bench::flat_memory memory;
+    cpu::arm7tdmi processor;
+    processor.connect_bus(cpu::connector{memory});
+    processor.reset();
+
+    for (auto const& [name, encodings, mask] : execution_classes) {
+        auto const stream = predecode(bench::synthetic_stream(encodings, mask & no_pc_destination));
+        BENCHMARK(name + ", 4096 instructions") {
+            for (auto const& [spec, instruction] : stream) {
+                cpu::arm::execute(processor, spec, instruction);
+            }
+            return processor.get_regitsters_contents()[0].value;
+        };
+    }
+}
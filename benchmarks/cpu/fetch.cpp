@@ -0,0 +1,44 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "emulator/cpu/bus.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+
+namespace {
+
+using namespace fgba;
+using bench::flat_memory;
+
+constexpr u32 fetch_count = 0x1000;
+
+template<typename Connector>
+auto fetch_loop(cpu::basic_bus<Connector>& bus)
+    -> u32 {
+    u32 sum = 0;
+    for (u32 pc = 0; pc < fetch_count * 4; pc += 4) {
+        bus.access_read(cpu::address{word{pc}}, cpu::data_size::word);
+        sum += bus.load_from().value;
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST_CASE("instruction fetch throughput", "[!benchmark][bus]") {
+    flat_memory memory;
+    for (u32 i = 0; i < memory.storage.size(); ++i) {
+        memory.storage[i] = i * 0x9e37'79b9;
+    }
+    cpu::basic_bus<cpu::connector> erased_bus{cpu::connector{memory}};
+    cpu::basic_bus<cpu::static_connector<flat_memory>> static_bus{cpu::static_connector<flat_memory>{memory}};
+
+    REQUIRE(fetch_loop(erased_bus) == fetch_loop(static_bus));
+
+    BENCHMARK("type-erased connector, 4096 fetches") {
+        return fetch_loop(erased_bus);
+    };
+    BENCHMARK("static connector, 4096 fetches") {
+        return fetch_loop(static_bus);
+    };
+}
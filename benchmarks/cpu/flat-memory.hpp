@@ -0,0 +1,55 @@
+#ifndef FGBA_BENCHMARKS_FLAT_MEMORY_HPP_QPWOEIRUTY
+#define FGBA_BENCHMARKS_FLAT_MEMORY_HPP_QPWOEIRUTY
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "emulator/cpu/bus.hpp"
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::bench {
+
+// just enough memory for the cpu to run from, everything is a word and it wraps around
+struct flat_memory {
+    std::array<u32, 0x1000> storage{};
+
+    auto memory_access_read(cpu::address address, cpu::data_size, word& data_bus) const noexcept
+        -> void { data_bus = word{storage[(address.value >> 2) & 0xfff]}; }
+    auto memory_access_write(cpu::address address, cpu::data_size, word data_bus) noexcept
+        -> void { storage[(address.value >> 2) & 0xfff] = data_bus.value; }
+};
+
+// xorshift, so streams are the same on every run and every machine
+class noise {
+public:
+    explicit constexpr noise(u32 seed = 0x2545'f491) noexcept
+        : m_state{seed} {}
+    constexpr auto operator()() noexcept
+        -> u32 {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+private:
+    u32 m_state;
+};
+
+inline constexpr std::size_t stream_length = 0x1000;
+
+// cycles through the given encodings and scrambles the bits selected by the mask
+[[nodiscard]]inline auto synthetic_stream(std::span<u32 const> const encodings, u32 const mask)
+    -> std::vector<u32> {
+    auto random = noise{};
+    auto stream = std::vector<u32>(stream_length);
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+        stream[i] = encodings[i % encodings.size()] | (random() & mask);
+    }
+    return stream;
+}
+
+} // namespace fgba::bench
+
+#endif
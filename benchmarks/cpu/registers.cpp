@@ -0,0 +1,69 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <array>
+#include <vector>
+
+#include "emulator/cpu/prefetch-buffer.hpp"
+#include "emulator/cpu/registermanager.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+
+using namespace fgba;
+
+TEST_CASE("register file access", "[!benchmark][registers]") {
+    cpu::register_manager registers;
+    registers.switch_mode(cpu::mode::sys);
+    for (u32 i = 0; i < 16; ++i) {
+        registers[i] = word{i};
+    }
+    auto const indices = bench::synthetic_stream(std::vector<u32>{0}, 0xf);
+
+    BENCHMARK("operator[] read, 4096 accesses") {
+        auto sum = u32{0};
+        for (auto const index : indices) {
+            sum += registers[index].value;
+        }
+        return sum;
+    };
+    BENCHMARK("operator[] read-modify-write, 4096 accesses") {
+        for (auto const index : indices) {
+            registers[index] += 1_word;
+        }
+        return registers[0].value;
+    };
+    BENCHMARK("mode switch, 4096 switches") {
+        constexpr std::array modes{cpu::mode::sys, cpu::mode::irq, cpu::mode::svc, cpu::mode::fiq};
+        for (auto const index : indices) {
+            registers.switch_mode(modes[index % modes.size()]);
+        }
+        return registers.sp().value;
+    };
+}
+
+TEST_CASE("prefetch buffer round trip", "[!benchmark][prefetch]") {
+    cpu::prefetch_buffer buffer;
+    auto const stream = bench::synthetic_stream(std::vector<u32>{0}, 0xffff'ffff);
+
+    // same pattern as the cpu: one in, one out, two in flight
+    BENCHMARK("arm, 4096 round trips") {
+        buffer.flush();
+        buffer.write(word{0});
+        auto sum = u32{0};
+        for (auto const opcode : stream) {
+            buffer.write(word{opcode});
+            sum += buffer.read<word>().value;
+        }
+        return sum;
+    };
+    BENCHMARK("thumb, 4096 round trips") {
+        buffer.flush();
+        buffer.write(hword{0});
+        auto sum = u32{0};
+        for (auto const opcode : stream) {
+            buffer.write(hword{static_cast<u16>(opcode)});
+            sum += buffer.read<hword>().value;
+        }
+        return sum;
+    };
+}
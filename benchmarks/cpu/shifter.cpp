@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "emulator/cpu/registermanager.hpp"
+#include "emulator/cpu/shifter.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+
+namespace {
+
+using namespace fgba;
+using cpu::s_bit;
+using cpu::shifts;
+
+template<shifts Shift, s_bit S>
+auto benchmark_barrel(std::string_view const name, std::vector<u32> const& stream, cpu::register_manager const& registers)
+    -> void {
+    auto const label = std::string{name} + (S == s_bit::on ? ", with carry out" : "") + ", 4096 shifts";
+    BENCHMARK(label) {
+        auto sum = u32{0};
+        for (auto const opcode : stream) {
+            auto const result = cpu::shifter::barrel<Shift, S>(word{opcode}, word{opcode}, registers);
+            if constexpr (S == s_bit::on) {
+                sum += result.shifted_data.value + static_cast<u32>(result.carryout);
+            } else {
+                sum += result.value;
+            }
+        }
+        return sum;
+    };
+}
+
+template<shifts Shift>
+auto benchmark_barrel(std::string_view const name, std::vector<u32> const& stream, cpu::register_manager const& registers)
+    -> void {
+    benchmark_barrel<Shift, s_bit::off>(name, stream, registers);
+    benchmark_barrel<Shift, s_bit::on>(name, stream, registers);
+}
+
+} // namespace
+
+TEST_CASE("barrel shifter throughput", "[!benchmark][shifter]") {
+    cpu::register_manager registers;
+    registers.switch_mode(cpu::mode::sys);
+    auto random = bench::noise{};
+    for (u32 i = 0; i < 16; ++i) {
+        registers[i] = word{random()};
+    }
+    registers.cpsr().val = 0x2000'001f;
+
+    // opcode doubles as the operand, shift fields are whatever the noise says
+    auto const stream = bench::synthetic_stream(std::vector<u32>{0}, 0xffff'ffff);
+    // shifts by immediate never see zero, decoder turns those into the special ones
+    auto immediate_stream = stream;
+    for (auto& opcode : immediate_stream) {
+        opcode = (opcode & ~0xf80_u32) | (opcode % 31 + 1) << 7;
+    }
+
+    benchmark_barrel<shifts::null>("no shift", stream, registers);
+    benchmark_barrel<shifts::lsl>("lsl by immediate", immediate_stream, registers);
+    benchmark_barrel<shifts::lsr>("lsr by immediate", immediate_stream, registers);
+    benchmark_barrel<shifts::asr>("asr by immediate", immediate_stream, registers);
+    benchmark_barrel<shifts::ror>("ror by immediate", immediate_stream, registers);
+    benchmark_barrel<shifts::lsr32>("lsr by 32", stream, registers);
+    benchmark_barrel<shifts::asr32>("asr by 32", stream, registers);
+    benchmark_barrel<shifts::rrx>("rrx", stream, registers);
+    benchmark_barrel<shifts::rslsl>("lsl by register", stream, registers);
+    benchmark_barrel<shifts::rslsr>("lsr by register", stream, registers);
+    benchmark_barrel<shifts::rsasr>("asr by register", stream, registers);
+    benchmark_barrel<shifts::rsror>("ror by register", stream, registers);
+}
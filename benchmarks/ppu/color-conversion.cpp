@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "emulator/ppu/color-conversion.hpp"
+#include "emulator/ppu/ppu.hpp"
+
+using namespace fgba;
+
+TEST_CASE("bgr555 to framebuffer format conversion", "[!benchmark][ppu][color]") {
+    constexpr auto pixels = std::size_t{ppu::screen_width} * ppu::screen_height;
+    auto source = std::vector<std::byte>(pixels * 2);
+    for (std::size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<std::byte>(i * 0x9e37'79b9 >> 24);
+    }
+    auto destination = std::vector<std::byte>(pixels * 4);
+
+    constexpr std::pair<ppu::conversion_kernel, char const*> kernels[]{
+        {ppu::conversion_kernel::scalar, "scalar"},
+        {ppu::conversion_kernel::sse2,   "sse2"},
+        {ppu::conversion_kernel::avx2,   "avx2"},
+    };
+    constexpr std::pair<pixel_format, char const*> formats[]{
+        {pixel_format::rgb888,   "rgb888"},
+        {pixel_format::rgba8888, "rgba8888"},
+        {pixel_format::bgra8888, "bgra8888"},
+        {pixel_format::rgb565,   "rgb565"},
+        {pixel_format::bgr555,   "bgr555"},
+    };
+    for (auto const [format, format_name] : formats) {
+        for (auto const [kernel, name] : kernels) {
+            if (not ppu::is_supported(kernel)) continue;
+            auto const label = std::string{format_name} + ", " + name;
+            BENCHMARK(label + ", one frame") {
+                ppu::convert_bgr555(kernel, format, source, destination.data());
+                return destination[0];
+            };
+            BENCHMARK(label + ", one line") {
+                ppu::convert_bgr555(kernel, format, std::span{source}.first(ppu::screen_width * 2), destination.data());
+                return destination[0];
+            };
+        }
+    }
+}
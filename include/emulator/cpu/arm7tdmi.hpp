@@ -1,22 +1,63 @@
 #ifndef FGBA_ARMCPU_HPP
 #define FGBA_ARMCPU_HPP
 
+#include "emulator/cpu/block-cache.hpp"
 #include "emulator/cpu/bus.hpp"
 #include "emulator/cpu/prefetch-buffer.hpp"
 #include "emulator/cpu/registermanager.hpp"
+#include "emulator/save-state.hpp"
 
 namespace fgba::cpu {
 namespace arm {
 struct instruction_executor;
 }
+namespace thumb {
+struct instruction_executor;
+}
+// internal cycles of a multiply, multiplier gives up early once the rest of rs
+// is all zeroes, or all ones if it is treated as signed
+[[nodiscard]]constexpr auto multiplier_cycles(word const rs, bool const sign_extends = true) noexcept
+    -> u32 {
+    auto cycles = u32{1};
+    for (auto const shift : {8u, 16u, 24u}) {
+        auto const rest = rs.value >> shift;
+        if (rest == 0 or (sign_extends and rest == 0xffff'ffffu >> shift)) return cycles;
+        ++cycles;
+    }
+    return cycles;
+}
 class arm7tdmi {
     friend struct arm::instruction_executor;
+    friend struct thumb::instruction_executor;
 public:
     arm7tdmi();
-    auto connect_bus(connector)
+    auto connect_bus(bus_connector)
+        -> void;
+    // state after the reset exception, execution starts from entry
+    auto reset(word entry = 0_word, mode mode = mode::svc)
+        -> void;
+    // state bios leaves behind right before it jumps into the cartridge, for running without one
+    auto skip_bios()
         -> void;
     auto advance_execution()
         -> void;
+    // runs the whole cached block at pc, or a single instruction if there is nothing to cache
+    // returns how many cycles that took
+    auto execute_block()
+        -> u32;
+    auto save_state(state_writer& state) const
+        -> void;
+    // cached blocks are kept, whoever restores memory has to invalidate what changed under them
+    auto load_state(state_reader& state)
+        -> void;
+    auto invalidate_code(u32 address)
+        -> void { m_block_cache.invalidate(address); }
+    // moves on every time some cached code is thrown away
+    [[nodiscard]]auto code_generation() const noexcept
+        -> u32 { return m_block_cache.generation(); }
+    // instructions stepped through since reset, failed conditions included, whichever way they ran
+    [[nodiscard]]auto retired() const noexcept
+        -> u64 { return m_retired; }
     [[nodiscard]]auto get_regitsters_contents() const noexcept
         -> register_manager const& {
             return m_registers;
@@ -30,13 +71,28 @@ private:
         -> void;
     auto flush_pipeline()
         -> void;
+    // brings prefetch buffer back in line with pc after block ran without touching it
+    auto resync_pipeline()
+        -> void;
+    // cycles and pipeline after however much of block ran
+    auto finish_block(block_cache::block const& block, address start, u32 executed, bool passed)
+        -> u32;
+#ifdef FGBA_ENABLE_JIT
+    auto run_native(jit::translation native, u32 generation)
+        -> arm::block_run;
+#endif
+    auto store(address address, data_size mas)
+        -> void {
+        m_bus.access_write(address, mas);
+        m_block_cache.invalidate(address.value);
+    }
 public:
     bus m_bus;
     prefetch_buffer m_prefetch_buffer;
     register_manager m_registers;
 private:
-
-
+    block_cache m_block_cache;
+    u64 m_retired{0};
 };
 }
 
@@ -0,0 +1,144 @@
+#ifndef FGBA_BLOCK_CACHE_HPP_PQLZMXNWE
+#define FGBA_BLOCK_CACHE_HPP_PQLZMXNWE
+
+#include <bitset>
+#include <unordered_map>
+#include <vector>
+#ifdef FGBA_ENABLE_JIT
+#include <memory>
+#endif
+
+#include "emulator/cpudefines.hpp"
+#ifdef FGBA_ENABLE_JIT
+#include "emulator/cpu/jit/context.hpp"
+#endif
+#include "emulator/mmu/mirrors.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::cpu {
+class arm7tdmi;
+#ifdef FGBA_ENABLE_JIT
+namespace jit {
+class translator;
+}
+#endif
+namespace arm {
+using impl_ptr = auto (*)(arm7tdmi&, instruction) -> void;
+
+// Threaded code: every handler runs its own instruction and then jumps straight into the handler
+// of the next one, so each of them gets its own indirect branch to be predicted from.
+struct threaded_entry;
+struct threaded_context {
+    arm7tdmi* cpu;
+    // block cache generation the block was started in
+    u32 generation;
+    u32 executed;
+    // whether the last instruction which ran passed its condition
+    bool passed;
+};
+using threaded_ptr = auto (*)(threaded_context&, threaded_entry const*) -> void;
+struct threaded_entry {
+    threaded_ptr handler;
+    instruction instruction;
+};
+// how far a block got
+struct block_run {
+    u32 executed;
+    bool passed;
+};
+}
+
+// Straight runs of arm code are decoded once into {handler, instruction} pairs and then
+// executed in a loop without going through decode() and prefetch buffer every time.
+//
+// A block ends on the first branch (b, bl, bx), which is still part of it, or right before
+// anything else that could touch pc or is not implemented yet, so those are left
+// to the interpreter. Blocks never cross a code page, so a write only has to look at
+// the page it lands on to know which blocks became stale. Conditions are checked as
+// the block runs, so a conditional instruction is just one more entry.
+//
+// With FGBA_ENABLE_JIT blocks which keep being run also get translated to native code,
+// stale blocks take their translation with them.
+class block_cache {
+public:
+    static constexpr u32 max_block_length = 64;
+    static constexpr u32 code_page_shift  = 10;
+    static constexpr u32 code_page_size   = 1_u32 << code_page_shift;
+    // pages are counted in canonical addresses, so all mirrors of one share it.
+    // upper nibble is not decoded by the gba bus
+    static constexpr u32 code_page_count  = 0x1000'0000 >> code_page_shift;
+#ifdef FGBA_ENABLE_JIT
+    // runs a block has to make before it is worth translating
+    static constexpr u32 jit_threshold    = 32;
+#endif
+
+    struct entry {
+        arm::impl_ptr handler;
+        arm::instruction instruction;
+    };
+    struct block {
+        std::vector<entry> entries;
+#ifdef FGBA_THREADED_DISPATCH
+        // same instructions, followed by one which leaves
+        std::vector<arm::threaded_entry> threaded;
+#endif
+#ifdef FGBA_ENABLE_JIT
+        jit::translation native;
+        u32 runs{};
+#endif
+        bool ends_in_branch{};
+    };
+
+#ifdef FGBA_ENABLE_JIT
+    block_cache();
+    block_cache(block_cache const&) = delete;
+    auto operator=(block_cache const&)
+        -> block_cache& = delete;
+    ~block_cache();
+#endif
+
+    // finds the block starting at pc, decoding it through cpu bus if there is none
+    [[nodiscard]]auto lookup(arm7tdmi& cpu, u32 pc)
+        -> block&;
+#ifdef FGBA_ENABLE_JIT
+    // counts a run of the block and hands out its native code, translating it once it got hot.
+    // code is null while it isn't or when there was nothing in the block worth translating
+    [[nodiscard]]auto native_code(block& block, u32 pc)
+        -> jit::translation;
+#endif
+    FGBA_FORCE_INLINE auto invalidate(u32 address)
+        -> void {
+        auto const page = code_page(address);
+        if (m_code_pages[page]) [[unlikely]] invalidate_page(page);
+    }
+    // bumped every time some blocks are thrown away, so whoever runs a block
+    // can notice that it was pulled from under their feet
+    [[nodiscard]]auto generation() const noexcept
+        -> u32 { return m_generation; }
+    auto clear() noexcept
+        -> void;
+private:
+    // blocks are kept by the pc they were entered from, since pc relative code depends on it,
+    // but a write through any mirror has to find them
+    [[nodiscard]]static constexpr auto code_page(u32 const address) noexcept
+        -> u32 { return mmu::canonical_address(address) >> code_page_shift; }
+    [[nodiscard]]static auto compile(arm7tdmi& cpu, u32 pc)
+        -> block;
+    auto invalidate_page(u32 page)
+        -> void;
+
+    using block_map = std::unordered_map<u32, block>;
+    block_map m_blocks;
+    std::unordered_map<u32, std::vector<u32>> m_page_blocks;
+    // stale blocks are kept alive until the next lookup since one of them might still be running
+    std::vector<block_map::node_type> m_retired;
+    std::bitset<code_page_count> m_code_pages;
+    u32 m_generation{};
+#ifdef FGBA_ENABLE_JIT
+    std::unique_ptr<jit::translator> m_translator;
+#endif
+};
+
+} // namespace fgba::cpu
+
+#endif
@@ -3,68 +3,188 @@
 
 #include <memory>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 #include "emulator/cpudefines.hpp"
 #include "fgba-defines.hpp"
+#if defined(FGBA_STATIC_BUS)
+#include "emulator/mmu/mmu.hpp"
+#endif
 namespace fgba::cpu {
 
+// Memories report how many cycles every access took. Ones that don't care about timing
+// (mocks in tests and benchmarks) can return nothing, then every access is a single cycle.
+namespace detail {
+template<typename Mmu>
+FGBA_FORCE_INLINE auto timed_read(Mmu& mmu, address address, data_size mas, word& data_bus)
+    -> u32 {
+    if constexpr (std::is_void_v<decltype(mmu.memory_access_read(address, mas, data_bus))>) {
+        mmu.memory_access_read(address, mas, data_bus);
+        return 1;
+    } else {
+        return mmu.memory_access_read(address, mas, data_bus);
+    }
+}
+template<typename Mmu>
+FGBA_FORCE_INLINE auto timed_write(Mmu& mmu, address address, data_size mas, word data_bus)
+    -> u32 {
+    if constexpr (std::is_void_v<decltype(mmu.memory_access_write(address, mas, data_bus))>) {
+        mmu.memory_access_write(address, mas, data_bus);
+        return 1;
+    } else {
+        return mmu.memory_access_write(address, mas, data_bus);
+    }
+}
+template<typename Mmu>
+FGBA_FORCE_INLINE auto sequential_cycles(Mmu const& mmu, address address, data_size mas)
+    -> u32 {
+    if constexpr (requires { mmu.sequential_cycles(address, mas); }) {
+        return mmu.sequential_cycles(address, mas);
+    } else {
+        return 1;
+    }
+}
+// a look at memory that leaves nothing behind, no open bus, no sequential tracking, no cycles.
+// memories which keep no such state can just be read
+template<typename Mmu>
+FGBA_FORCE_INLINE auto peek(Mmu& mmu, address address)
+    -> word {
+    if constexpr (requires { mmu.peek(address); }) {
+        return mmu.peek(address);
+    } else {
+        word data_bus{};
+        timed_read(mmu, address, data_size::word, data_bus);
+        return data_bus;
+    }
+}
+} // namespace detail
+
+// Type-erased connection to whatever memory there is. It costs an indirect call per access
+// which nothing can see through, but it lets tests and benchmarks plug in mock memories.
 class connector {
-    using access_read_sig  = auto(void*, address, data_size, word&) -> void;
-    using access_write_sig = auto(void*, address, data_size, word)  -> void;
+    using access_read_sig  = auto(void*, address, data_size, word&) -> u32;
+    using access_write_sig = auto(void*, address, data_size, word)  -> u32;
+    using cycles_sig       = auto(void const*, address, data_size)  -> u32;
+    using peek_sig         = auto(void*, address)                   -> word;
 public:
-    
+
     connector() noexcept = default;
     template<typename Mmu>
         requires (not std::same_as<connector, Mmu>)
     connector(Mmu& mmu_impl) noexcept;
 
     connector(connector const&) noexcept = default;
-    auto operator=(connector const&) noexcept 
+    auto operator=(connector const&) noexcept
         -> connector& = default;
-        
+
     auto access_read(address, data_size, word& data_bus)
-        -> void;
+        -> u32;
     auto access_write(address, data_size, word data_bus)
-        -> void;
+        -> u32;
+    [[nodiscard]]auto sequential_cycles(address, data_size) const
+        -> u32;
+    [[nodiscard]]auto peek(address)
+        -> word;
 private:
     void* m_mmu{};
     access_read_sig*  m_read_impl{};
     access_write_sig* m_write_impl{};
+    cycles_sig*       m_cycles_impl{};
+    peek_sig*         m_peek_impl{};
 };
 
-class bus {
+// Same thing, but bound to the concrete memory type at compile time,
+// so every fetch and load/store is a direct call which can be inlined.
+template<typename Mmu>
+class static_connector {
 public:
-    bus() noexcept = default;
-    bus(connector) noexcept;
-    auto connect(connector) noexcept
-        -> void;
+    static_connector() noexcept = default;
+    static_connector(Mmu& mmu_impl) noexcept
+        : m_mmu{std::addressof(mmu_impl)} {}
+
+    FGBA_FORCE_INLINE auto access_read(address address, data_size mas, word& data_bus)
+        -> u32 { return detail::timed_read(*m_mmu, address, mas, data_bus); }
+    FGBA_FORCE_INLINE auto access_write(address address, data_size mas, word data_bus)
+        -> u32 { return detail::timed_write(*m_mmu, address, mas, data_bus); }
+    [[nodiscard]]FGBA_FORCE_INLINE auto sequential_cycles(address address, data_size mas) const
+        -> u32 { return detail::sequential_cycles(*m_mmu, address, mas); }
+    [[nodiscard]]FGBA_FORCE_INLINE auto peek(address address)
+        -> word { return detail::peek(*m_mmu, address); }
+private:
+    Mmu* m_mmu{};
+};
+
+template<typename Connector>
+class basic_bus {
+public:
+    basic_bus() noexcept = default;
+    basic_bus(Connector connector) noexcept
+        : m_connection{connector} {}
+    auto connect(Connector connector) noexcept
+        -> void { m_connection = connector; }
     auto load_on(word data) noexcept
-        -> void;
+        -> void { m_data = data; }
     [[nodiscard]]
     auto load_from() const noexcept
-        -> word;
-    auto access_read(address, data_size)
-        -> void;
-    auto access_write(address, data_size)
-        -> void;
+        -> word { return m_data; }
+    FGBA_FORCE_INLINE auto access_read(address address, data_size mas)
+        -> void { m_cycles += m_connection.access_read(address, mas, m_data); }
+    FGBA_FORCE_INLINE auto access_write(address address, data_size mas)
+        -> void { m_cycles += m_connection.access_write(address, mas, m_data); }
+    [[nodiscard]]FGBA_FORCE_INLINE auto sequential_cycles(address address, data_size mas) const
+        -> u32 { return m_connection.sequential_cycles(address, mas); }
+    // for decoding ahead, the word at address without touching the data bus or anything behind it
+    [[nodiscard]]auto peek(address address)
+        -> word { return m_connection.peek(address); }
+
+    // cycles spent since they were last taken, internal ones included
+    [[nodiscard]]auto cycles() const noexcept
+        -> u32 { return m_cycles; }
+    auto take_cycles() noexcept
+        -> u32 { return std::exchange(m_cycles, 0); }
+    // for cycles the core spends without touching memory, and for fetches which were skipped
+    FGBA_FORCE_INLINE auto add_cycles(u32 cycles) noexcept
+        -> void { m_cycles += cycles; }
+    // accesses made since the mark didn't really happen on hardware, like decoding ahead
+    auto rewind_cycles(u32 mark) noexcept
+        -> void { m_cycles = mark; }
 private:
-    connector m_connection{};
+    Connector m_connection{};
     word m_data{unitialized_word};
+    u32 m_cycles{0};
 };
 
+#if defined(FGBA_STATIC_BUS)
+using bus_connector = static_connector<mmu::memory_managment_unit>;
+#else
+using bus_connector = connector;
+#endif
+using bus = basic_bus<bus_connector>;
+
 template<typename Mmu>
     requires (not std::same_as<connector, Mmu>)
-connector::connector(Mmu& mmu_impl) noexcept 
+connector::connector(Mmu& mmu_impl) noexcept
     :
         m_mmu{std::addressof(mmu_impl)},
         m_read_impl{
             [](void* mem, address address, data_size mas, word& data_bus) {
-                return static_cast<Mmu*>(mem)->memory_access_read(address, mas, data_bus);
+                return detail::timed_read(*static_cast<Mmu*>(mem), address, mas, data_bus);
             }
         },
         m_write_impl{
             [](void* mem, address address, data_size mas, word data_bus) {
-                return static_cast<Mmu*>(mem)->memory_access_write(address, mas, data_bus);
+                return detail::timed_write(*static_cast<Mmu*>(mem), address, mas, data_bus);
+            }
+        },
+        m_cycles_impl{
+            [](void const* mem, address address, data_size mas) {
+                return detail::sequential_cycles(*static_cast<Mmu const*>(mem), address, mas);
+            }
+        },
+        m_peek_impl{
+            [](void* mem, address address) {
+                return detail::peek(*static_cast<Mmu*>(mem), address);
             }
         } {}
 } // namespace fgab::cpu
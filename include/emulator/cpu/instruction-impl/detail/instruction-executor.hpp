@@ -7,7 +7,11 @@
 #include "emulator/cpu/arm7tdmi.hpp"
 #include "fgba-defines.hpp"
 #include "emulator/cpu/shifter.hpp"
+#ifdef FGBA_ENABLE_JIT
+#include "emulator/cpu/jit/context.hpp"
+#endif
 #include <bit>
+#include <span>
 #include <utility>
 
 namespace fgba::cpu { 
@@ -60,6 +64,37 @@ struct instruction_executor {
     template<s_bit, direction, indexing, write_back>
     static auto block_data_store(arm7tdmi&, instruction)
         -> void;
+    template<s_bit, direction, indexing, write_back>
+    static auto block_data_load(arm7tdmi&, instruction)
+        -> void;
+
+    // cached blocks, both stop right after an instruction which made block cache move on from generation
+    static auto run_entries(arm7tdmi&, std::span<block_cache::entry const>, u32 generation)
+        -> block_run;
+    template<impl_ptr>
+    static auto threaded(threaded_context&, threaded_entry const*)
+        -> void;
+    static auto threaded_exit(threaded_context&, threaded_entry const*)
+        -> void {}
+#ifdef FGBA_ENABLE_JIT
+    // native code calls this for every instruction it doesn't do itself
+    static auto jit_fallback(jit::context*, jit::handler_ptr, u32 instruction, u32 pc, u32 index)
+        -> u32;
+    // and these for the loads and stores it does make itself
+    static auto jit_read(jit::context*, u32 address, data_size)
+        -> u32;
+    static auto jit_write(jit::context*, u32 address, u32 value, data_size)
+        -> u32;
+#endif
+private:
+    static auto jump(arm7tdmi&, word target)
+        -> void;
+    template<data_size, mll_signedndesd = mll_signedndesd::unsigned_>
+    static auto load(arm7tdmi&, u32 address)
+        -> word;
+    template<data_size>
+    static auto store(arm7tdmi&, u32 address, word data)
+        -> void;
 };
 } // namespace arm
 } // namespace fgba::cpu
@@ -96,17 +131,61 @@ inline auto instruction_executor::bx(arm7tdmi& cpu, instruction const instructio
     auto should_switch_to_thumb = regs[rn.value][0] == 1_bit;
     regs.cpsr().use_thumb(should_switch_to_thumb); 
     cpu.flush_pipeline();
-    regs.pc() = regs[rn.value];
+    regs.pc() = regs[rn.value] & (should_switch_to_thumb ? ~1_word : ~3_word);
     cpu.prefetch();
     cpu.increment_program_counter();
     cpu.prefetch();
 }
 
+inline auto instruction_executor::run_entries(arm7tdmi& cpu, std::span<block_cache::entry const> const entries, u32 const generation)
+    -> block_run {
+    auto run = block_run{.executed = 0, .passed = true};
+    for (auto const& [handler, instruction] : entries) {
+        run.passed = is_unconditional(instruction) or condition_passed(cpu.m_registers.cpsr().val, instruction.value >> 28);
+        if (run.passed) handler(cpu, instruction);
+        cpu.increment_program_counter();
+        ++run.executed;
+        // block has just overwritten itself, whatever is left of it is stale
+        if (cpu.m_block_cache.generation() != generation) [[unlikely]] break;
+    }
+    return run;
+}
 
+// same as one round of run_entries, except the handler is known here and the next one is jumped to instead of returned to
+template<impl_ptr Handler>
+auto instruction_executor::threaded(threaded_context& context, threaded_entry const* entry)
+    -> void {
+    auto& cpu = *context.cpu;
+    auto const instruction = entry->instruction;
+    context.passed = is_unconditional(instruction) or condition_passed(cpu.m_registers.cpsr().val, instruction.value >> 28);
+    if constexpr (Handler != nullptr) {
+        if (context.passed) Handler(cpu, instruction);
+    }
+    cpu.increment_program_counter();
+    ++context.executed;
+    if (cpu.m_block_cache.generation() != context.generation) [[unlikely]] return;
+    ++entry;
+    FGBA_MUSTTAIL return entry->handler(context, entry);
+}
 
-[[nodiscard]]constexpr auto check_overflow(word const operand1, word const operand2, word const result) {
-    return (operand1[31] == operand2[31]) and (operand1[31] != result[31]);
+#ifdef FGBA_ENABLE_JIT
+// one round of run_entries again, native code before it left pc wherever the block started
+inline auto instruction_executor::jit_fallback(jit::context* const context, jit::handler_ptr const handler,
+                                               u32 const instruction, u32 const pc, u32 const index)
+    -> u32 {
+    auto& cpu = *context->cpu;
+    auto const encoded = arm::instruction{word{instruction}};
+    cpu.m_registers.pc() = word{pc};
+    auto const passed = is_unconditional(encoded) or condition_passed(cpu.m_registers.cpsr().val, instruction >> 28);
+    if (passed) handler(cpu, encoded);
+    cpu.increment_program_counter();
+    context->passed   = passed;
+    context->executed = index + 1;
+    return cpu.m_block_cache.generation() == context->generation;
 }
+#endif
+
+
 
 template<s_bit S>
 constexpr auto get_operand2(auto const shifted) -> word {
@@ -124,7 +203,7 @@ constexpr auto i_have_no_clue_how_to_name_this(arm7tdmi const& cpu, instruction
         auto const result        = shift_operand.ror(shift_amount);
         if constexpr (S == s_bit::on) {
             auto const carryout = shift_amount == 0 ? 
-                regs.cpsr().check_ccf(ccf::c) :
+                regs.carry() :
                 result[31];
             return shifter::shift_res{result, carryout};
         } else {
@@ -136,18 +215,24 @@ constexpr auto i_have_no_clue_how_to_name_this(arm7tdmi const& cpu, instruction
     }
 }
 
+// reading the shift amount out of a register takes an extra internal cycle
+template<immediate_operand I, shifts Shift>
+FGBA_FORCE_INLINE auto charge_register_shift(arm7tdmi& cpu) noexcept
+    -> void {
+    if constexpr (I == immediate_operand::off and Shift >= shifts::rslsl) cpu.m_bus.add_cycles(1);
+}
+
 template<immediate_operand I, s_bit S, shifts Shift, logical_operation Operation>
 auto instruction_executor::logical(arm7tdmi& cpu, instruction const instruction) -> void {
     auto const rd = instruction[15, 12].value;
     auto const rn = instruction[19, 16].value;
     auto& regs = cpu.m_registers;
     auto const shifted_result = i_have_no_clue_how_to_name_this<I, S, Shift>(cpu, instruction);
+    charge_register_shift<I, Shift>(cpu);
     auto const operand2 = get_operand2<S>(shifted_result);
     [[maybe_unused]]auto const res = regs[rd] = Operation(regs[rn], operand2); 
     if constexpr (S == s_bit::on) {
-        regs.cpsr().set_ccf(ccf::c, shifted_result.carryout);
-        regs.cpsr().set_ccf(ccf::z, res == 0_word);
-        regs.cpsr().set_ccf(ccf::n, res[31]);
+        regs.set_logical_flags(res, shifted_result.carryout);
     }
     
 }
@@ -157,11 +242,10 @@ auto instruction_executor::logical(arm7tdmi& cpu, instruction const instruction)
     auto const rn = instruction[19, 16].value;
     auto& regs = cpu.m_registers;
     auto const shifted_result = i_have_no_clue_how_to_name_this<I, s_bit::on, Shift>(cpu, instruction);
+    charge_register_shift<I, Shift>(cpu);
     auto const operand2 = get_operand2<s_bit::on>(shifted_result);
     auto const res = Operation(regs[rn], operand2); 
-    regs.cpsr().set_ccf(ccf::c, shifted_result.carryout);
-    regs.cpsr().set_ccf(ccf::z, res == 0_word);
-    regs.cpsr().set_ccf(ccf::n, res[31]);
+    regs.set_logical_flags(res, shifted_result.carryout);
 }
 
 template<immediate_operand I, s_bit S, shifts Shift, arithmetic_operation Operation>
@@ -171,12 +255,11 @@ auto instruction_executor::arithmetic(arm7tdmi& cpu, instruction const instructi
     auto& regs = cpu.m_registers;
     auto& destination = regs[rd];
     auto const operand2 = i_have_no_clue_how_to_name_this<I, s_bit::off, Shift>(cpu, instruction);
-    [[maybe_unused]]auto const carryout = Operation(regs[rn], operand2, &destination, regs.cpsr().check_ccf(ccf::c)); 
+    charge_register_shift<I, Shift>(cpu);
+    auto const operand1 = regs[rn];
+    [[maybe_unused]]auto const carryout = Operation(operand1, operand2, &destination, regs.carry()); 
     if constexpr (S == s_bit::on) {
-        regs.cpsr().set_ccf(ccf::c, carryout);
-        regs.cpsr().set_ccf(ccf::z, destination == 0_word);
-        regs.cpsr().set_ccf(ccf::n, destination[31] == 1_bit);
-        regs.cpsr().set_ccf(ccf::v, check_overflow(regs[rn], operand2, destination));
+        regs.set_arithmetic_flags(destination, carryout, operand1, operand2);
     }
 }
 template<immediate_operand I, shifts Shift, arithmetic_operation Operation>
@@ -185,11 +268,9 @@ auto instruction_executor::arithmetic(arm7tdmi& cpu, instruction const instructi
     auto& regs = cpu.m_registers;
     word destination;
     auto const operand2 = i_have_no_clue_how_to_name_this<I, s_bit::off, Shift>(cpu, instruction);
-    auto const carryout = Operation(regs[rn], operand2, &destination, regs.cpsr().check_ccf(ccf::c)); 
-    regs.cpsr().set_ccf(ccf::c, carryout);
-    regs.cpsr().set_ccf(ccf::z, destination == 0_word);
-    regs.cpsr().set_ccf(ccf::n, destination[31]);
-    regs.cpsr().set_ccf(ccf::v, check_overflow(regs[rn], operand2, destination));
+    charge_register_shift<I, Shift>(cpu);
+    auto const carryout = Operation(regs[rn], operand2, &destination, regs.carry()); 
+    regs.set_arithmetic_flags(destination, carryout, regs[rn], operand2);
 }
 
 template<immediate_operand I, s_bit S, shifts Shift, single_operand_operation Operation>
@@ -197,12 +278,11 @@ auto instruction_executor::single_operand(arm7tdmi& cpu, instruction const instr
     auto const rd = instruction[15, 12].value;
     auto& regs = cpu.m_registers;
     auto const shifted_result = i_have_no_clue_how_to_name_this<I, S, Shift>(cpu, instruction);
+    charge_register_shift<I, Shift>(cpu);
     auto const operand = get_operand2<S>(shifted_result);
     [[maybe_unused]]auto const res = regs[rd] = Operation(operand); 
     if constexpr (S == s_bit::on) {
-        regs.cpsr().set_ccf(ccf::c, shifted_result.carryout);
-        regs.cpsr().set_ccf(ccf::z, res == 0_word);
-        regs.cpsr().set_ccf(ccf::n, res[31]);
+        regs.set_logical_flags(res, shifted_result.carryout);
     }
 }
 
@@ -219,6 +299,7 @@ auto instruction_executor::multiply(arm7tdmi& cpu, instruction const instruction
 
     auto const accumulated = A == accumulate::on ? regs[rn] : 0_word;
 
+    cpu.m_bus.add_cycles(multiplier_cycles(regs[rs]) + (A == accumulate::on ? 1 : 0));
     auto const mul_res = regs[rd] = regs[rm] * regs[rs] + accumulated;
 
     if constexpr (S == s_bit::on) {
@@ -237,9 +318,7 @@ auto instruction_executor::multiply_long(arm7tdmi& cpu, instruction const instru
     auto const rm   = instruction[ 3,  0].value;
 
     auto& regs = cpu.m_registers;
-    // I am feeling a bit quirky today 
-    // Also I am just using unsigned instead of seperating by signdendess
-    // I really can't wrap my head around why they are different for now
+    // sign extended operands multiply the same as unsigned ones as far as the low 64 bits go
     auto const accumulated = A == accumulate::on ? 
         regs[rdhi].as<dword>().lsl(32) | regs[rdlo].as<dword>() :
         0_dword;
@@ -251,12 +330,15 @@ auto instruction_executor::multiply_long(arm7tdmi& cpu, instruction const instru
         regs[rm].as<dword>();
 
     auto const mll_res  = operand1 * operand2 + accumulated;
+    cpu.m_bus.add_cycles(
+        multiplier_cycles(regs[rs], MS == mll_signedndesd::signed_) + 1 + (A == accumulate::on ? 1 : 0)
+    );
     regs[rdlo] = mll_res.as<word>();
-    regs[rdhi] = mll_res.lsl(32).as<word>();
+    regs[rdhi] = mll_res.lsr(32).as<word>();
 
     if constexpr (S == s_bit::on) {
         regs.cpsr().set_ccf(ccf::n, mll_res[63] == 1_bit);
-        regs.cpsr().set_ccf(ccf::z, mll_res != 0_dword);
+        regs.cpsr().set_ccf(ccf::z, mll_res == 0_dword);
         // for now I will just set c and v to zero
         regs.cpsr().set_ccf(ccf::c, 0);
         regs.cpsr().set_ccf(ccf::v, 0);
@@ -294,133 +376,202 @@ auto instruction_executor::move_to_psr(arm7tdmi& cpu, instruction const instruct
 }
 
 
-template<immediate_operand Im, shifts Shift, direction Dir, data_size Data>
-auto extract_offset(arm7tdmi& cpu, instruction const instruction) 
-    -> u32 {
-    auto const absolute_offset = (
-        Im == immediate_operand::on ? (
-            Data == data_size::hword or Data == data_size::byte ? (
-                instruction[11, 8].lsl(4) | instruction[3, 0] 
-            ) : (
-                instruction[11, 0]
-            )
-        ) : (
-            (i_have_no_clue_how_to_name_this<immediate_operand::off, s_bit::off, Shift>(cpu, instruction))
-        )
-    );
-    auto const adjusted_sign_offset = (
-        Dir == direction::up ? (
-            absolute_offset
-        ) : (
-           -absolute_offset
-        )
-    );
-    return adjusted_sign_offset;
-}
-
-template<immediate_operand Im, shifts Shift, direction Dir, indexing Ind, write_back Wb, data_size Data>
-auto instruction_executor::data_store(arm7tdmi& cpu, instruction const instruction) 
+// jumps are where pc gets loaded, on armv4 that never changes state
+inline auto instruction_executor::jump(arm7tdmi& cpu, word const target)
     -> void {
     auto& regs = cpu.m_registers;
-    auto const offset = extract_offset<Im, Shift, Dir, Data>(cpu, instruction);
-    auto const data_to_load_on_bus = [&] -> word {
-        word result;
-        auto const data_to_transfer = regs[instruction[15, 12].value];
-        if constexpr (Data == data_size::byte) {
-            return result[31, 24] = result[23, 16] = result[15, 8] = result[7, 0] = data_to_transfer[7, 0];
-        } else if constexpr (Data == data_size::hword) {
-            return result[31, 16] = result[15, 0] = data_to_transfer[15, 0];
-        }
-        return data_to_transfer;
-    }();
-    cpu.m_bus.load_on(data_to_load_on_bus);
+    regs.pc() = target & (regs.is_thumb() ? ~1_word : ~3_word);
+    cpu.flush_pipeline();
+    cpu.refill_pipeline();
+}
 
-    auto const r_b = instruction[19, 16];
-    if constexpr (Ind == indexing::post) {
-        cpu.m_bus.access_write(address{regs[r_b.value].value}, Data);
+// same rotation and sign rules as the thumb loads, the bus hands back whole words
+template<data_size Data, mll_signedndesd Sign>
+auto instruction_executor::load(arm7tdmi& cpu, u32 const address)
+    -> word {
+    // signed halfword from the odd address is just a signed byte
+    if constexpr (Data == data_size::hword and Sign == mll_signedndesd::signed_) {
+        if (address & 1) return load<data_size::byte, Sign>(cpu, address);
+    }
+    cpu.m_bus.access_read(cpu::address{word{address}}, Data);
+    auto const data = cpu.m_bus.load_from();
+    if constexpr (Data == data_size::word) {
+        return data.ror((address & 0b11) * 8);
+    } else if constexpr (Data == data_size::hword) {
+        if constexpr (Sign == mll_signedndesd::signed_) return data.sign_extend<15>();
+        else return data.mask_in(15, 0).ror((address & 1) * 8);
     } else {
-        cpu.m_bus.access_write(address{(regs[r_b.value] + offset).value}, Data);
+        if constexpr (Sign == mll_signedndesd::signed_) return data.sign_extend<7>();
+        else return data.mask_in(7, 0);
     }
+}
 
-    if constexpr (Wb == write_back::on or Ind == indexing::post) {
-        regs[r_b.value] += offset;
+template<data_size Data>
+auto instruction_executor::store(arm7tdmi& cpu, u32 const address, word const data)
+    -> void {
+    if constexpr (Data == data_size::byte) {
+        cpu.m_bus.load_on(word{(data.value & 0xff) * 0x0101'0101});
+    } else if constexpr (Data == data_size::hword) {
+        cpu.m_bus.load_on(word{(data.value & 0xffff) * 0x0001'0001});
+    } else {
+        cpu.m_bus.load_on(data);
     }
+    cpu.store(cpu::address{word{address}}, Data);
+}
+
+#ifdef FGBA_ENABLE_JIT
+// native code only loads and stores words and unsigned bytes
+inline auto instruction_executor::jit_read(jit::context* const context, u32 const address, data_size const size)
+    -> u32 {
+    auto& cpu = *context->cpu;
+    auto const loaded = size == data_size::byte ?
+        load<data_size::byte>(cpu, address) :
+        load<data_size::word>(cpu, address);
+    // same cycle data_load takes for writing the loaded value back
+    cpu.m_bus.add_cycles(1);
+    return loaded.value;
 }
 
-consteval auto upper_bound(data_size data_size) 
+inline auto instruction_executor::jit_write(jit::context* const context, u32 const address, u32 const value, data_size const size)
     -> u32 {
-    switch (data_size) {
-        case data_size::byte:  return 7;
-        case data_size::hword: return 15;
-        case data_size::word:  return 31;
-        default: std::unreachable();
+    auto& cpu = *context->cpu;
+    if (size == data_size::byte) {
+        store<data_size::byte>(cpu, address, word{value});
+    } else {
+        store<data_size::word>(cpu, address, word{value});
     }
+    return cpu.m_block_cache.generation() == context->generation;
 }
-template<data_size Data, mll_signedndesd Sign>
-auto process_data_from_bus(word const data, address const address)
+#endif
+
+// halfwords and signed bytes split their immediate around the opcode bits, the rest take 12 bits of it
+template<immediate_operand Im, shifts Shift, data_size Data, mll_signedndesd Sign>
+auto extract_offset(arm7tdmi& cpu, instruction const instruction) 
     -> word {
-    word result;
+    constexpr auto split_immediate = Data == data_size::hword or Sign == mll_signedndesd::signed_;
+    if constexpr (Im == immediate_operand::off) {
+        return i_have_no_clue_how_to_name_this<immediate_operand::off, s_bit::off, Shift>(cpu, instruction);
+    } else if constexpr (split_immediate) {
+        return instruction[11, 8].lsl(4) | instruction[3, 0];
+    } else {
+        return instruction[11, 0];
+    }
+}
 
-    auto const alignment = address[1, 0].value;
-    result = data.ror(alignment * 8).mask_in(upper_bound(Data), 0);
-    if (Sign == mll_signedndesd::signed_) {
-        static constexpr std::array significant_bits{31u, 7u, 15u, 7u};
-        result = result.sign_extend(significant_bits[alignment]);
+// where the transfer happens and what the base is left with
+template<immediate_operand Im, shifts Shift, direction Dir, indexing Ind, data_size Data, mll_signedndesd Sign>
+auto transfer_addresses(arm7tdmi& cpu, instruction const instruction)
+    -> std::pair<word, word> {
+    auto const base   = cpu.m_registers[instruction[19, 16].value];
+    auto const offset = extract_offset<Im, Shift, Data, Sign>(cpu, instruction);
+    auto const offset_base = Dir == direction::up ? base + offset : base - offset;
+    return {Ind == indexing::pre ? offset_base : base, offset_base};
+}
+
+template<immediate_operand Im, shifts Shift, direction Dir, indexing Ind, write_back Wb, data_size Data>
+auto instruction_executor::data_store(arm7tdmi& cpu, instruction const instruction) 
+    -> void {
+    auto& regs = cpu.m_registers;
+    auto const rn = instruction[19, 16].value;
+    auto const rd = instruction[15, 12].value;
+    auto const [address, written_back] = transfer_addresses<Im, Shift, Dir, Ind, Data, mll_signedndesd::unsigned_>(cpu, instruction);
+    // pc is stored one instruction further along than it reads
+    store<Data>(cpu, address.value, rd == registers::pc ? regs.pc() + 4_word : regs[rd]);
+    if constexpr (Wb == write_back::on or Ind == indexing::post) {
+        regs[rn] = written_back;
     }
-    return result;
 }
+
 template<immediate_operand Im, shifts Shift, direction Dir, indexing Ind, write_back Wb, data_size Data, mll_signedndesd Sign>
 auto instruction_executor::data_load(arm7tdmi& cpu, instruction const instruction)
     -> void {
     auto& regs = cpu.m_registers;
-    auto const offset = extract_offset<Im, Shift, Dir, Data>(cpu, instruction);
-    auto const r_base = instruction[19, 16].value;
-    auto const rd     = instruction[15, 12].value;
-
-    auto const source_address = [&] -> address {
-        return Ind == indexing::post ? regs[r_base] : regs[r_base] + offset;
-    }();
-
-    cpu.m_bus.access_read(source_address, Data);
-    auto data = cpu.m_bus.load_from();
-    regs[rd] = process_data_from_bus<Data, Sign>(data, source_address);
-
+    auto const rn = instruction[19, 16].value;
+    auto const rd = instruction[15, 12].value;
+    auto const [address, written_back] = transfer_addresses<Im, Shift, Dir, Ind, Data, Sign>(cpu, instruction);
+    auto const loaded = load<Data, Sign>(cpu, address.value);
+    // loaded value wins when it goes into the base
+    if constexpr (Wb == write_back::on or Ind == indexing::post) {
+        regs[rn] = written_back;
+    }
+    // loaded value is written back to the register file on a cycle of its own
+    cpu.m_bus.add_cycles(1);
+    if (rd == registers::pc) {
+        jump(cpu, loaded);
+    } else {
+        regs[rd] = loaded;
+    }
 }
 
+// lowest address of the block and what the base is left with, registers always go up from the lowest one
+template<direction Dir, indexing Ind>
+auto block_addresses(word const base, word const register_list)
+    -> std::pair<word, word> {
+    auto const size = word{register_list.popcnt() * 4};
+    if constexpr (Dir == direction::up) {
+        return {Ind == indexing::pre ? base + 4_word : base, base + size};
+    } else {
+        return {Ind == indexing::pre ? base - size : base - size + 4_word, base - size};
+    }
+}
 
 template<s_bit S, direction Dir, indexing Ind, write_back Wb>
 auto instruction_executor::block_data_store(arm7tdmi& cpu, instruction const instruction)
     -> void {
-    auto const r_base  = instruction[19, 16].value;
-    auto register_list = instruction[15, 0];
+    auto const rn      = instruction[19, 16].value;
+    auto register_list = word{instruction[15, 0].value};
     auto& regs         = cpu.m_registers;
+    auto [address, written_back] = block_addresses<Dir, Ind>(regs[rn], register_list);
 
-    auto [effective_pointer, write_back_pointer] = [&] -> std::pair<address, address> {
-        auto effective_pointer_res  = regs[r_base];
-        auto write_back_pointer_res = regs[r_base];
-        auto const address_offset   = word{register_list.popcnt() * 4};
+    auto first = true;
+    while (register_list != 0_word) {
+        auto const r = register_list.pop_lso();
+        // s bit stores the user registers whatever mode this is
+        auto const data = r == registers::pc ? regs.pc() + 4_word
+                        : S == s_bit::on     ? regs.user(r)
+                        : regs[r];
+        store<data_size::word>(cpu, address.value, data);
+        address += 4_word;
+        // base is written back after the first store, only a base first in the list goes out unchanged
+        if (Wb == write_back::on and std::exchange(first, false)) regs[rn] = written_back;
+    }
+}
 
-        if (Dir == direction::up) {
-            effective_pointer_res  += Ind == indexing::pre ? 4_word : 0_word;
-            write_back_pointer_res += address_offset;
+template<s_bit S, direction Dir, indexing Ind, write_back Wb>
+auto instruction_executor::block_data_load(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rn      = instruction[19, 16].value;
+    auto register_list = word{instruction[15, 0].value};
+    auto& regs         = cpu.m_registers;
+    auto const loads_pc = register_list[registers::pc] == 1_bit;
+    auto [address, written_back] = block_addresses<Dir, Ind>(regs[rn], register_list);
+    // loaded base wins over write back
+    if constexpr (Wb == write_back::on) regs[rn] = written_back;
+
+    register_list[registers::pc] = 0_bit;
+    while (register_list != 0_word) {
+        auto const r = register_list.pop_lso();
+        auto const loaded = load<data_size::word>(cpu, address.value);
+        // without pc the s bit loads the user registers, with it the registers of the mode being returned to
+        if (S == s_bit::on and not loads_pc) {
+            regs.user(r) = loaded;
         } else {
-            effective_pointer_res   = effective_pointer_res - address_offset + 
-                (Ind == indexing::pre ? 0_word : 4_word);
-            write_back_pointer_res -= address_offset;
-        }
-        return {{effective_pointer_res}, {write_back_pointer_res}};
-    }();
-    if (Wb == write_back::on and register_list[r_base] == 1_bit) {
-        if (register_list.crz() != r_base) {
-            regs[r_base] = write_back_pointer;
+            regs[r] = loaded;
         }
+        address += 4_word;
     }
-    while (register_list != 0_word) {
-        auto const register_to_transfer = register_list.pop_lso();
-        cpu.m_bus.load_on(regs[register_to_transfer]);
-        cpu.m_bus.access_write(effective_pointer, data_size::word);
-        effective_pointer += 4_word;
-    } 
+    // one internal cycle for the whole transfer, not for each register
+    cpu.m_bus.add_cycles(1);
+    if (not loads_pc) return;
+
+    auto const target = load<data_size::word>(cpu, address.value);
+    if constexpr (S == s_bit::on) {
+        // returning from an exception, mode and state come back with the rest of cpsr
+        auto const saved = regs.spsr();
+        regs.cpsr() = saved;
+        regs.switch_mode(saved.get_mode());
+    }
+    jump(cpu, target);
 }
 
 }
@@ -0,0 +1,484 @@
+#ifndef THUMB_INSTRUCTION_EXECUTION_HPP_QPWMZNXBV
+#define THUMB_INSTRUCTION_EXECUTION_HPP_QPWMZNXBV
+
+#include "emulator/cpu/instruction-impl/instruction-flags.hpp"
+#include "emulator/cpu/opcodes.hpp"
+#include "emulator/cpudefines.hpp"
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/lla.hpp"
+#include "emulator/cpu/registermanager.hpp"
+#include "emulator/cpu/shifter.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::cpu {
+
+using arithmetic_operation = auto(*)(word, word, word*, u32) -> bool;
+namespace thumb {
+struct instruction_executor {
+    using set = thumb_instruction::set;
+
+    template<shifts>
+    static auto move_shifted(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto add_subtract(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto immediate(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto alu(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto hi_register(arm7tdmi&, instruction)
+        -> void;
+    static auto bx(arm7tdmi&, instruction)
+        -> void;
+    static auto pc_relative_load(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto register_offset(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto immediate_offset(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto sp_relative(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto load_address(arm7tdmi&, instruction)
+        -> void;
+    static auto adjust_sp(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto push_pop(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto block_transfer(arm7tdmi&, instruction)
+        -> void;
+    static auto conditional_branch(arm7tdmi&, instruction)
+        -> void;
+    static auto branch(arm7tdmi&, instruction)
+        -> void;
+    template<set>
+    static auto long_branch(arm7tdmi&, instruction)
+        -> void;
+private:
+    template<data_size, mll_signedndesd = mll_signedndesd::unsigned_>
+    static auto load(arm7tdmi&, u32 address)
+        -> word;
+    template<data_size>
+    static auto store(arm7tdmi&, u32 address, word data)
+        -> void;
+    template<set>
+    static auto transfer(arm7tdmi&, u32 rd, u32 address)
+        -> void;
+    static auto jump(arm7tdmi&, word target)
+        -> void;
+};
+
+FGBA_FORCE_INLINE
+constexpr auto set_nz(psr& cpsr, word const result) noexcept
+    -> void {
+    cpsr.set_ccf(ccf::n, result[31]);
+    cpsr.set_ccf(ccf::z, result == 0_word);
+}
+
+template<arithmetic_operation Operation>
+FGBA_FORCE_INLINE
+auto arithmetic(psr& cpsr, word const operand1, word const operand2) noexcept
+    -> word {
+    constexpr bool subtracts = Operation == &sub_impl or Operation == &sbc_impl;
+    word result;
+    auto const carryout = Operation(operand1, operand2, &result, cpsr.check_ccf(ccf::c));
+    // subtraction is addition of the inverted operand as far as overflow is concerned
+    auto const added = subtracts ? ~operand2 : operand2;
+    set_nz(cpsr, result);
+    cpsr.set_ccf(ccf::c, carryout);
+    cpsr.set_ccf(ccf::v, (~(operand1 ^ added) & (operand1 ^ result))[31]);
+    return result;
+}
+
+inline auto instruction_executor::jump(arm7tdmi& cpu, word const target)
+    -> void {
+    cpu.m_registers.pc() = target & ~1_word;
+    cpu.flush_pipeline();
+    cpu.refill_pipeline();
+}
+
+template<shifts Shift>
+auto instruction_executor::move_shifted(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd     = instruction[2, 0].value;
+    auto const rs     = instruction[5, 3].value;
+    auto const amount = static_cast<u32>(instruction[10, 6].value);
+    auto& regs = cpu.m_registers;
+    auto const operand = regs[rs];
+
+    auto const shifted = [&] -> shifter::shift_res {
+        // zero amount encodes lsl #0, lsr #32 and asr #32
+        if (amount == 0) {
+            if constexpr (Shift == shifts::lsl) return shifter::shift<s_bit::on>(operand, regs.cpsr().check_ccf(ccf::c));
+            if constexpr (Shift == shifts::lsr) return shifter::shiftlsr32<s_bit::on>(operand);
+            if constexpr (Shift == shifts::asr) return shifter::shiftasr32<s_bit::on>(operand);
+        }
+        if constexpr (Shift == shifts::lsl) return shifter::shiftlsl<s_bit::on>(amount, operand);
+        if constexpr (Shift == shifts::lsr) return shifter::shiftlsr<s_bit::on>(amount, operand);
+        if constexpr (Shift == shifts::asr) return shifter::shiftasr<s_bit::on>(amount, operand);
+    }();
+    regs[rd] = shifted.shifted_data;
+    set_nz(regs.cpsr(), shifted.shifted_data);
+    regs.cpsr().set_ccf(ccf::c, shifted.carryout);
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::add_subtract(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd = instruction[2, 0].value;
+    auto const rs = instruction[5, 3].value;
+    auto const rn = instruction[8, 6].value;
+    auto& regs = cpu.m_registers;
+
+    auto const operand2 = Instr == set::add_imm3 or Instr == set::sub_imm3 ?
+        word{rn} :
+        regs[rn];
+    if constexpr (Instr == set::add_reg or Instr == set::add_imm3) {
+        regs[rd] = arithmetic<add_impl>(regs.cpsr(), regs[rs], operand2);
+    } else {
+        regs[rd] = arithmetic<sub_impl>(regs.cpsr(), regs[rs], operand2);
+    }
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::immediate(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd = instruction[10, 8].value;
+    auto const immediate = word{instruction[7, 0].value};
+    auto& regs = cpu.m_registers;
+
+    if constexpr (Instr == set::mov_imm) {
+        regs[rd] = immediate;
+        set_nz(regs.cpsr(), immediate);
+    } else if constexpr (Instr == set::cmp_imm) {
+        arithmetic<sub_impl>(regs.cpsr(), regs[rd], immediate);
+    } else if constexpr (Instr == set::add_imm) {
+        regs[rd] = arithmetic<add_impl>(regs.cpsr(), regs[rd], immediate);
+    } else {
+        regs[rd] = arithmetic<sub_impl>(regs.cpsr(), regs[rd], immediate);
+    }
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::alu(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd = instruction[2, 0].value;
+    auto const rs = instruction[5, 3].value;
+    auto& regs = cpu.m_registers;
+    auto& cpsr = regs.cpsr();
+    auto const lhs = regs[rd];
+    auto const rhs = regs[rs];
+
+    auto const register_shift = [&](auto const shift) {
+        // amount comes from a register, that is an extra internal cycle
+        cpu.m_bus.add_cycles(1);
+        auto const [result, carryout] = shift(rhs.value & 0xff, lhs, cpsr.check_ccf(ccf::c));
+        regs[rd] = result;
+        set_nz(cpsr, result);
+        cpsr.set_ccf(ccf::c, carryout);
+    };
+
+    if constexpr (Instr == set::and_) {
+        set_nz(cpsr, regs[rd] = lhs & rhs);
+    } else if constexpr (Instr == set::eor) {
+        set_nz(cpsr, regs[rd] = lhs ^ rhs);
+    } else if constexpr (Instr == set::orr) {
+        set_nz(cpsr, regs[rd] = lhs | rhs);
+    } else if constexpr (Instr == set::bic) {
+        set_nz(cpsr, regs[rd] = lhs & ~rhs);
+    } else if constexpr (Instr == set::mvn) {
+        set_nz(cpsr, regs[rd] = ~rhs);
+    } else if constexpr (Instr == set::tst) {
+        set_nz(cpsr, lhs & rhs);
+    } else if constexpr (Instr == set::lsl) {
+        register_shift(shifter::shiftrslsl<s_bit::on>);
+    } else if constexpr (Instr == set::lsr) {
+        register_shift(shifter::shiftrslsr<s_bit::on>);
+    } else if constexpr (Instr == set::asr) {
+        register_shift(shifter::shiftrsasr<s_bit::on>);
+    } else if constexpr (Instr == set::ror) {
+        register_shift(shifter::shiftrsror<s_bit::on>);
+    } else if constexpr (Instr == set::adc) {
+        regs[rd] = arithmetic<adc_impl>(cpsr, lhs, rhs);
+    } else if constexpr (Instr == set::sbc) {
+        regs[rd] = arithmetic<sbc_impl>(cpsr, lhs, rhs);
+    } else if constexpr (Instr == set::neg) {
+        regs[rd] = arithmetic<sub_impl>(cpsr, 0_word, rhs);
+    } else if constexpr (Instr == set::cmp) {
+        arithmetic<sub_impl>(cpsr, lhs, rhs);
+    } else if constexpr (Instr == set::cmn) {
+        arithmetic<add_impl>(cpsr, lhs, rhs);
+    } else if constexpr (Instr == set::mul) {
+        cpu.m_bus.add_cycles(multiplier_cycles(lhs));
+        set_nz(cpsr, regs[rd] = lhs * rhs);
+        // same as arm mul, carry is meaningless here
+        cpsr.set_ccf(ccf::c, 0);
+    }
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::hi_register(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd = (instruction[7] ? 8u : 0u) | instruction[2, 0].value;
+    auto const rs = (instruction[6] ? 8u : 0u) | instruction[5, 3].value;
+    auto& regs = cpu.m_registers;
+
+    if constexpr (Instr == set::cmp_hi) {
+        arithmetic<sub_impl>(regs.cpsr(), regs[rd], regs[rs]);
+    } else {
+        auto const result = Instr == set::add_hi ? regs[rd] + regs[rs] : regs[rs];
+        if (rd == registers::pc) {
+            jump(cpu, result);
+        } else {
+            regs[rd] = result;
+        }
+    }
+}
+
+inline auto instruction_executor::bx(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rs = (instruction[6] ? 8u : 0u) | instruction[5, 3].value;
+    auto& regs = cpu.m_registers;
+    auto const target = regs[rs];
+    auto const stay_in_thumb = target[0] == 1_bit;
+    regs.cpsr().use_thumb(stay_in_thumb);
+    cpu.flush_pipeline();
+    regs.pc() = target & (stay_in_thumb ? ~1_word : ~3_word);
+    cpu.refill_pipeline();
+}
+
+template<data_size Data, mll_signedndesd Sign>
+auto instruction_executor::load(arm7tdmi& cpu, u32 const address)
+    -> word {
+    // signed halfword from the odd address is just a signed byte
+    if constexpr (Data == data_size::hword and Sign == mll_signedndesd::signed_) {
+        if (address & 1) return load<data_size::byte, Sign>(cpu, address);
+    }
+    cpu.m_bus.access_read(cpu::address{word{address}}, Data);
+    auto const data = cpu.m_bus.load_from();
+    if constexpr (Data == data_size::word) {
+        return data.ror((address & 0b11) * 8);
+    } else if constexpr (Data == data_size::hword) {
+        if constexpr (Sign == mll_signedndesd::signed_) return data.sign_extend<15>();
+        else return data.mask_in(15, 0).ror((address & 1) * 8);
+    } else {
+        if constexpr (Sign == mll_signedndesd::signed_) return data.sign_extend<7>();
+        else return data.mask_in(7, 0);
+    }
+}
+
+template<data_size Data>
+auto instruction_executor::store(arm7tdmi& cpu, u32 const address, word const data)
+    -> void {
+    if constexpr (Data == data_size::byte) {
+        cpu.m_bus.load_on(word{(data.value & 0xff) * 0x0101'0101});
+    } else if constexpr (Data == data_size::hword) {
+        cpu.m_bus.load_on(word{(data.value & 0xffff) * 0x0001'0001});
+    } else {
+        cpu.m_bus.load_on(data);
+    }
+    cpu.store(cpu::address{word{address}}, Data);
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::transfer(arm7tdmi& cpu, u32 const rd, u32 const address)
+    -> void {
+    using enum mll_signedndesd;
+    auto& regs = cpu.m_registers;
+    switch (Instr) {
+        case set::str_reg: case set::str_imm: case set::str_sp:
+            return store<data_size::word>(cpu, address, regs[rd]);
+        case set::strb_reg: case set::strb_imm:
+            return store<data_size::byte>(cpu, address, regs[rd]);
+        case set::strh_reg: case set::strh_imm:
+            return store<data_size::hword>(cpu, address, regs[rd]);
+        case set::ldr_reg: case set::ldr_imm: case set::ldr_sp:
+            regs[rd] = load<data_size::word>(cpu, address);
+            break;
+        case set::ldrb_reg: case set::ldrb_imm:
+            regs[rd] = load<data_size::byte>(cpu, address);
+            break;
+        case set::ldrh_reg: case set::ldrh_imm:
+            regs[rd] = load<data_size::hword>(cpu, address);
+            break;
+        case set::ldsb_reg:
+            regs[rd] = load<data_size::byte, signed_>(cpu, address);
+            break;
+        case set::ldsh_reg:
+            regs[rd] = load<data_size::hword, signed_>(cpu, address);
+            break;
+        default: std::unreachable();
+    }
+    // only loads get here, writing the loaded value back takes an internal cycle
+    cpu.m_bus.add_cycles(1);
+}
+
+inline auto instruction_executor::pc_relative_load(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd     = instruction[10, 8].value;
+    auto const offset = instruction[7, 0].value * 4u;
+    auto& regs = cpu.m_registers;
+    regs[rd] = load<data_size::word>(cpu, (regs.pc().value & ~0b10u) + offset);
+    cpu.m_bus.add_cycles(1);
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::register_offset(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd = instruction[2, 0].value;
+    auto const rb = instruction[5, 3].value;
+    auto const ro = instruction[8, 6].value;
+    auto const& regs = cpu.m_registers;
+    transfer<Instr>(cpu, rd, (regs[rb] + regs[ro]).value);
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::immediate_offset(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd = instruction[2, 0].value;
+    auto const rb = instruction[5, 3].value;
+    constexpr auto scale = [] -> u32 {
+        switch (Instr) {
+            case set::strb_imm: case set::ldrb_imm: return 1;
+            case set::strh_imm: case set::ldrh_imm: return 2;
+            default: return 4;
+        }
+    }();
+    auto const offset = instruction[10, 6].value * scale;
+    transfer<Instr>(cpu, rd, cpu.m_registers[rb].value + offset);
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::sp_relative(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd     = instruction[10, 8].value;
+    auto const offset = instruction[7, 0].value * 4u;
+    transfer<Instr>(cpu, rd, cpu.m_registers.sp().value + offset);
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::load_address(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rd     = instruction[10, 8].value;
+    auto const offset = word{instruction[7, 0].value * 4u};
+    auto& regs = cpu.m_registers;
+    if constexpr (Instr == set::add_pc) {
+        regs[rd] = (regs.pc() & ~0b10_word) + offset;
+    } else {
+        regs[rd] = regs.sp() + offset;
+    }
+}
+
+inline auto instruction_executor::adjust_sp(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const offset = word{instruction[6, 0].value * 4u};
+    auto& sp = cpu.m_registers.sp();
+    if (instruction[7] == 1_bit) {
+        sp -= offset;
+    } else {
+        sp += offset;
+    }
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::push_pop(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto register_list = word{instruction[7, 0].value};
+    auto const with_link = instruction[8] == 1_bit;
+    auto& regs = cpu.m_registers;
+
+    if constexpr (Instr == set::push) {
+        auto const count = register_list.popcnt() + (with_link ? 1 : 0);
+        auto address = regs.sp() - word{count * 4};
+        regs.sp() = address;
+        while (register_list != 0_word) {
+            store<data_size::word>(cpu, address.value, regs[register_list.pop_lso()]);
+            address += 4_word;
+        }
+        if (with_link) store<data_size::word>(cpu, address.value, regs.lr());
+    } else {
+        // one internal cycle for the whole transfer, not for each register
+        cpu.m_bus.add_cycles(1);
+        auto address = regs.sp();
+        while (register_list != 0_word) {
+            regs[register_list.pop_lso()] = load<data_size::word>(cpu, address.value);
+            address += 4_word;
+        }
+        if (with_link) {
+            auto const target = load<data_size::word>(cpu, address.value);
+            regs.sp() = address + 4_word;
+            jump(cpu, target);
+        } else {
+            regs.sp() = address;
+        }
+    }
+}
+
+template<thumb_instruction::set Instr>
+auto instruction_executor::block_transfer(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const rb = instruction[10, 8].value;
+    auto register_list = word{instruction[7, 0].value};
+    auto& regs = cpu.m_registers;
+    auto const base_in_list = register_list[rb] == 1_bit;
+    auto address = regs[rb];
+
+    while (register_list != 0_word) {
+        auto const r = register_list.pop_lso();
+        if constexpr (Instr == set::stmia) {
+            store<data_size::word>(cpu, address.value, regs[r]);
+        } else {
+            regs[r] = load<data_size::word>(cpu, address.value);
+        }
+        address += 4_word;
+    }
+    if constexpr (Instr == set::ldmia) cpu.m_bus.add_cycles(1);
+    // loaded base wins over write back
+    if (Instr == set::stmia or not base_in_list) {
+        regs[rb] = address;
+    }
+}
+
+inline auto instruction_executor::conditional_branch(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto& regs = cpu.m_registers;
+    if (not condition_passed(regs.cpsr().val, instruction[11, 8].value)) return;
+    auto const offset = word{instruction[7, 0].value}.sign_extend<7>().lsl(1);
+    jump(cpu, regs.pc() + offset);
+}
+
+inline auto instruction_executor::branch(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const offset = word{instruction[10, 0].value}.sign_extend<10>().lsl(1);
+    jump(cpu, cpu.m_registers.pc() + offset);
+}
+
+// bl is split in two halves, first one stashes upper part of the offset in lr
+template<thumb_instruction::set Instr>
+auto instruction_executor::long_branch(arm7tdmi& cpu, instruction const instruction)
+    -> void {
+    auto const offset = word{instruction[10, 0].value};
+    auto& regs = cpu.m_registers;
+    if constexpr (Instr == set::bl_hi) {
+        regs.lr() = regs.pc() + offset.sign_extend<10>().lsl(12);
+    } else {
+        auto const return_address = (regs.pc() - 2_word) | 1_word;
+        auto const target = regs.lr() + offset.lsl(1);
+        regs.lr() = return_address;
+        jump(cpu, target);
+    }
+}
+
+} // namespace thumb
+} // namespace fgba::cpu
+
+#endif
@@ -1,11 +1,37 @@
 #ifndef INSTRUCTION_EXECUTION_HPP_FOCNOCFNR
 #define INSTRUCTION_EXECUTION_HPP_FOCNOCFNR
 #include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/block-cache.hpp"
 #include "emulator/cpu/opcodes.hpp"
 
+#include <span>
+
 namespace fgba::cpu {
 namespace arm {
 auto execute(arm7tdmi&, instruction_spec, instruction) -> void;
+// null for everything which is not implemented yet
+[[nodiscard]]auto handler_for(instruction_spec) noexcept -> impl_ptr;
+// null for the same ones as handler_for
+[[nodiscard]]auto threaded_handler_for(instruction_spec) noexcept -> threaded_ptr;
+// has to come after the last instruction of threaded code
+[[nodiscard]]auto threaded_exit() noexcept -> threaded_ptr;
+// two ways of running a cached block, FGBA_THREADED_DISPATCH says which one execute_block goes with.
+// a call through the pointer of every entry, or threaded handlers which jump from one into the next
+auto run_entries(arm7tdmi&, std::span<block_cache::entry const>, u32 generation) -> block_run;
+auto run_threaded(arm7tdmi&, threaded_entry const*, u32 generation) -> block_run;
+#ifdef FGBA_ENABLE_JIT
+// what native blocks call to get through everything they don't translate
+[[nodiscard]]auto jit_fallback() noexcept -> jit::fallback_ptr;
+// and what they call for the loads and stores they make themselves
+[[nodiscard]]auto jit_read() noexcept -> jit::read_ptr;
+[[nodiscard]]auto jit_write() noexcept -> jit::write_ptr;
+#endif
+}
+namespace thumb {
+using impl_ptr = auto (*)(arm7tdmi&, instruction) -> void;
+// straight from the opcode to the handler, one load and one call
+auto execute(arm7tdmi&, instruction) -> void;
+[[nodiscard]]auto handler_for(thumb_instruction) noexcept -> impl_ptr;
 }
 } // namespace fgba::cpu
 
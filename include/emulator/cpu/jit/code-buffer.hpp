@@ -0,0 +1,41 @@
+#ifndef FGBA_JIT_CODE_BUFFER_HPP_QWKDNVURTE
+#define FGBA_JIT_CODE_BUFFER_HPP_QWKDNVURTE
+
+#include <cstddef>
+#include <span>
+
+#include "fgba-defines.hpp"
+
+namespace fgba::cpu::jit {
+
+// Executable memory native blocks are put into one after another. It is never writable and
+// executable at the same time, every install flips the pages it writes to writable and back.
+// Nothing is freed on its own, once it is full everything goes at once with reset.
+class code_buffer {
+public:
+    static constexpr std::size_t default_size = 4 << 20;
+
+    // throws if the os doesn't give out the memory
+    explicit code_buffer(std::size_t size = default_size);
+    code_buffer(code_buffer const&) = delete;
+    auto operator=(code_buffer const&)
+        -> code_buffer& = delete;
+    ~code_buffer();
+
+    // copies code in and returns where it landed, null if it doesn't fit anymore
+    [[nodiscard]]auto install(std::span<u8 const> code)
+        -> void const*;
+    // everything installed so far is gone, none of it may be running
+    auto reset() noexcept
+        -> void { m_used = 0; }
+    [[nodiscard]]auto used() const noexcept
+        -> std::size_t { return m_used; }
+private:
+    std::byte* m_memory;
+    std::size_t m_size;
+    std::size_t m_used{0};
+};
+
+}
+
+#endif
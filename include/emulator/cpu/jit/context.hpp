@@ -0,0 +1,49 @@
+#ifndef FGBA_JIT_CONTEXT_HPP_MZNXBCVLAK
+#define FGBA_JIT_CONTEXT_HPP_MZNXBCVLAK
+
+#include <array>
+
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::cpu {
+class arm7tdmi;
+}
+
+namespace fgba::cpu::jit {
+// What native code of a block gets to work with. Laid out for the code generator, it reaches
+// every field at a fixed offset from a single pointer.
+struct context;
+// one load or store the way data_load and data_store make it, through the bus with the same timing.
+// a write returns 0 if block cache threw code away because of it, the rest of the block is stale then
+using read_ptr  = auto (*)(context*, u32 address, data_size) -> u32;
+using write_ptr = auto (*)(context*, u32 address, u32 value, data_size) -> u32;
+
+struct context {
+    // guest registers of the current mode, only the ones the block uses and pc are filled in
+    std::array<word*, 16> registers;
+    arm7tdmi* cpu;
+    read_ptr read;
+    write_ptr write;
+    // block cache generation the block was started in
+    u32 generation;
+    u32 executed;
+    // whether the last instruction passed its condition, a whole word so native code can store it as one
+    u32 passed;
+};
+
+using handler_ptr  = auto (*)(arm7tdmi&, arm::instruction) -> void;
+// runs one instruction of the block the interpreter way: pc is set to the given one, condition is
+// checked, handler runs and pc moves on. executed becomes index + 1 and it returns 0 if block cache
+// threw code away in the meantime, the rest of the block is stale then.
+using fallback_ptr = auto (*)(context*, handler_ptr, u32 instruction, u32 pc, u32 index) -> u32;
+using native_block = auto (*)(context*) -> void;
+
+struct translation {
+    native_block code{nullptr};
+    // mask of guest registers the native part touches, pc is always filled in on top of them
+    u16 registers{};
+};
+}
+
+#endif
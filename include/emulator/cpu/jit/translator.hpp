@@ -0,0 +1,42 @@
+#ifndef FGBA_JIT_TRANSLATOR_HPP_ZXOPLMEWQA
+#define FGBA_JIT_TRANSLATOR_HPP_ZXOPLMEWQA
+
+#include <optional>
+#include <span>
+
+#include "emulator/cpu/block-cache.hpp"
+#include "emulator/cpu/jit/code-buffer.hpp"
+#include "emulator/cpu/jit/context.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::cpu::jit {
+
+// Turns cached arm blocks into x86-64 code.
+//
+// Only the bread and butter is done natively: unconditional data processing which leaves flags
+// alone, with an immediate or a register shifted by an immediate and no pc anywhere, and word or
+// byte ldr and str addressed the same way, pc relative loads included. Guest registers those use
+// stay in host registers for the whole block and go back to memory only around calls. Loads and
+// stores call the bus through the context, so the mmu still sees every access and writes to code
+// still invalidate. Everything else is handed to the interpreter handler it was cached with.
+//
+// Block cache only keeps arm blocks, thumb code is interpreted an instruction at a time.
+class translator {
+public:
+    explicit translator(fallback_ptr fallback, std::size_t buffer_size = code_buffer::default_size);
+
+    // no code in the result when nothing in the block can be done natively,
+    // nothing at all when buffer is full and has to be reset first
+    [[nodiscard]]auto translate(std::span<block_cache::entry const> entries, u32 start)
+        -> std::optional<translation>;
+    // throws every translation away, none of them may be running
+    auto reset() noexcept
+        -> void { m_buffer.reset(); }
+private:
+    fallback_ptr m_fallback;
+    code_buffer m_buffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef FGBA_JIT_X64_EMITTER_HPP_POLKIJUHYG
+#define FGBA_JIT_X64_EMITTER_HPP_POLKIJUHYG
+
+#include <cstring>
+#include <vector>
+
+#include "fgba-defines.hpp"
+
+namespace fgba::cpu::jit {
+// host registers by their encoding
+enum class x64 : u8 {
+    rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi,
+    r8, r9, r10, r11, r12, r13, r14, r15,
+
+    count,
+};
+// by their /digit, the register form opcode is digit << 3 | 1
+enum class x64_alu : u8 {
+    add = 0,
+    or_ = 1,
+    and_ = 4,
+    sub = 5,
+    xor_ = 6,
+};
+enum class x64_shift : u8 {
+    ror = 1,
+    shl = 4,
+    shr = 5,
+    sar = 7,
+};
+
+// Just the handful of x86-64 instructions the translator needs, appended to a byte vector.
+// Memory operands are always [base + disp32], rsp and r12 can't be a base here.
+class x64_emitter {
+public:
+    // forward jump whose target is patched in later
+    struct label {
+        std::size_t at;
+    };
+
+    [[nodiscard]]auto bytes() const noexcept
+        -> std::vector<u8> const& { return m_code; }
+    [[nodiscard]]auto size() const noexcept
+        -> std::size_t { return m_code.size(); }
+
+    auto push(x64 const reg)
+        -> void { rex(false, x64::rax, reg); put(0x50 + low(reg)); }
+    auto pop(x64 const reg)
+        -> void { rex(false, x64::rax, reg); put(0x58 + low(reg)); }
+    auto ret()
+        -> void { put(0xc3); }
+    auto call(x64 const reg)
+        -> void { rex(false, x64::rax, reg); put(0xff); put(0xd0 | low(reg)); }
+    // dst = [base + disp]
+    auto load32(x64 const dst, x64 const base, i32 const disp)
+        -> void { rex(false, dst, base); put(0x8b); memory(dst, base, disp); }
+    auto load64(x64 const dst, x64 const base, i32 const disp)
+        -> void { rex(true, dst, base); put(0x8b); memory(dst, base, disp); }
+    // [base + disp] = src
+    auto store32(x64 const base, i32 const disp, x64 const src)
+        -> void { rex(false, src, base); put(0x89); memory(src, base, disp); }
+    auto store_imm32(x64 const base, i32 const disp, u32 const imm)
+        -> void { rex(false, x64::rax, base); put(0xc7); memory(x64::rax, base, disp); put32(imm); }
+    auto mov_imm32(x64 const dst, u32 const imm)
+        -> void { rex(false, x64::rax, dst); put(0xb8 + low(dst)); put32(imm); }
+    auto mov_imm64(x64 const dst, u64 const imm)
+        -> void {
+        rex(true, x64::rax, dst);
+        put(0xb8 + low(dst));
+        put32(static_cast<u32>(imm));
+        put32(static_cast<u32>(imm >> 32));
+    }
+    auto mov32(x64 const dst, x64 const src)
+        -> void { alu_rr(0x89, dst, src, false); }
+    auto mov64(x64 const dst, x64 const src)
+        -> void { alu_rr(0x89, dst, src, true); }
+    // dst op= src
+    auto alu32(x64_alu const op, x64 const dst, x64 const src)
+        -> void { alu_rr(static_cast<u8>((static_cast<u8>(op) << 3) | 0x01), dst, src, false); }
+    auto not32(x64 const dst)
+        -> void { rex(false, x64::rax, dst); put(0xf7); direct(2, dst); }
+    auto neg32(x64 const dst)
+        -> void { rex(false, x64::rax, dst); put(0xf7); direct(3, dst); }
+    auto shift32(x64_shift const kind, x64 const dst, u8 const amount)
+        -> void { rex(false, x64::rax, dst); put(0xc1); direct(static_cast<u8>(kind), dst); put(amount); }
+    auto test32(x64 const lhs, x64 const rhs)
+        -> void { alu_rr(0x85, lhs, rhs, false); }
+    [[nodiscard]]auto jz()
+        -> label { put(0x0f); put(0x84); return forward(); }
+    // jump lands wherever the next instruction is emitted
+    auto bind(label const label)
+        -> void {
+        auto const distance = static_cast<u32>(m_code.size() - (label.at + 4));
+        std::memcpy(m_code.data() + label.at, &distance, sizeof(distance));
+    }
+private:
+    [[nodiscard]]static constexpr auto low(x64 const reg) noexcept
+        -> u8 { return static_cast<u8>(reg) & 7; }
+    [[nodiscard]]static constexpr auto high(x64 const reg) noexcept
+        -> u8 { return static_cast<u8>(reg) >> 3; }
+    auto put(u32 const byte)
+        -> void { m_code.push_back(static_cast<u8>(byte)); }
+    auto put32(u32 const value)
+        -> void { for (u32 shift = 0; shift < 32; shift += 8) put(value >> shift); }
+    // reg goes in modrm.reg, rm in modrm.rm, prefix is left out when nothing needs it
+    auto rex(bool const wide, x64 const reg, x64 const rm)
+        -> void {
+        auto const prefix = (wide ? 0x08 : 0) | (high(reg) << 2) | high(rm);
+        if (prefix != 0) put(0x40 | prefix);
+    }
+    auto direct(u8 const reg, x64 const rm)
+        -> void { put(0xc0 | (reg << 3) | low(rm)); }
+    auto memory(x64 const reg, x64 const base, i32 const disp)
+        -> void {
+        put(0x80 | (low(reg) << 3) | low(base));
+        put32(static_cast<u32>(disp));
+    }
+    // op r/m, reg, which is the direction every one of them is used in
+    auto alu_rr(u8 const opcode, x64 const dst, x64 const src, bool const wide)
+        -> void { rex(wide, src, dst); put(opcode); direct(low(src), dst); }
+    [[nodiscard]]auto forward()
+        -> label {
+        auto const at = m_code.size();
+        put32(0);
+        return {at};
+    }
+
+    std::vector<u8> m_code;
+};
+}
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef FGBA_LOCKSTEP_HPP_WUEHFKCNAQ
+#define FGBA_LOCKSTEP_HPP_WUEHFKCNAQ
+
+#include <concepts>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fmt/format.h"
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/bus.hpp"
+#include "emulator/cpu/disassembler.hpp"
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::cpu {
+
+struct memory_write {
+    u32 address;
+    u32 value;
+    data_size size;
+
+    friend auto operator==(memory_write const&, memory_write const&)
+        -> bool = default;
+};
+
+// Sits between a cpu and its memory and remembers every write which went through.
+template<typename Memory>
+class write_log {
+public:
+    explicit write_log(Memory& memory) noexcept
+        : m_memory{&memory} {}
+
+    auto memory_access_read(address const address, data_size const mas, word& data_bus)
+        -> u32 { return detail::timed_read(*m_memory, address, mas, data_bus); }
+    auto memory_access_write(address const address, data_size const mas, word const data_bus)
+        -> u32 {
+        m_writes.push_back({.address = address.value, .value = data_bus.value, .size = mas});
+        return detail::timed_write(*m_memory, address, mas, data_bus);
+    }
+    [[nodiscard]]auto sequential_cycles(address const address, data_size const mas) const
+        -> u32 { return detail::sequential_cycles(*m_memory, address, mas); }
+    [[nodiscard]]auto peek(address const address)
+        -> word { return detail::peek(*m_memory, address); }
+
+    [[nodiscard]]auto writes() const noexcept
+        -> std::vector<memory_write> const& { return m_writes; }
+    auto clear() noexcept
+        -> void { m_writes.clear(); }
+private:
+    Memory* m_memory;
+    std::vector<memory_write> m_writes;
+};
+
+enum class engine : u8 {
+    // advance_execution, one instruction at a time
+    interpreter,
+    // execute_block, with whatever block cache runs blocks with in this build
+    blocks,
+
+    count,
+};
+
+struct divergence {
+    // how many instructions both got through before the one that went different
+    u64 instructions;
+    std::string report;
+};
+
+// Differential testing of execution engines. Two cpus run the same program from their own memories,
+// the reference one through the interpreter and the candidate through engine. After every step
+// of the candidate the reference catches up to the same instruction and both are compared:
+// registers of the current mode, cpsr, spsr and writes made since the last step, in order.
+//
+// Only the cpus are stepped, whatever else is behind the memory (video, timers) stays still,
+// otherwise it would see the two at different points and they would go apart for no good reason.
+template<typename Memory>
+class lockstep {
+    static_assert(std::same_as<bus_connector, connector>,
+                  "lockstep puts write logs in front of memories, link the cpu built without FGBA_STATIC_BUS");
+public:
+    lockstep(Memory& reference, Memory& candidate, engine const candidate_engine)
+        : m_reference_memory{reference}, m_candidate_memory{candidate}, m_engine{candidate_engine} {
+        m_reference.connect_bus(connector{m_reference_memory});
+        m_candidate.connect_bus(connector{m_candidate_memory});
+    }
+    // both point at the logs in here
+    lockstep(lockstep const&) = delete;
+    auto operator=(lockstep const&)
+        -> lockstep& = delete;
+
+    // both have to be reset the same way before running
+    [[nodiscard]]auto reference() noexcept
+        -> arm7tdmi& { return m_reference; }
+    [[nodiscard]]auto candidate() noexcept
+        -> arm7tdmi& { return m_candidate; }
+
+    // a block or one instruction of the candidate, depending on the engine
+    [[nodiscard]]auto step()
+        -> std::optional<divergence> {
+        auto const from = m_reference.retired();
+        m_trace.clear();
+        m_reference_memory.clear();
+        m_candidate_memory.clear();
+        if (m_engine == engine::blocks) m_candidate.execute_block();
+        else m_candidate.advance_execution();
+        while (m_reference.retired() < m_candidate.retired()) {
+            m_trace.push_back(upcoming(m_reference));
+            m_reference.advance_execution();
+        }
+        if (auto report = compare(from); not report.empty()) {
+            return divergence{.instructions = from, .report = std::move(report)};
+        }
+        return std::nullopt;
+    }
+    // stops at the first difference or once the candidate is past instructions
+    [[nodiscard]]auto run(u64 const instructions)
+        -> std::optional<divergence> {
+        while (m_candidate.retired() < instructions) {
+            if (auto found = step()) return found;
+        }
+        return std::nullopt;
+    }
+private:
+    struct traced {
+        u32 address;
+        u32 opcode;
+        bool thumb;
+    };
+
+    // what the interpreter is about to run, it is already sitting in the prefetch buffer
+    [[nodiscard]]static auto upcoming(arm7tdmi const& cpu)
+        -> traced {
+        auto const& registers = cpu.get_regitsters_contents();
+        auto buffer = cpu.m_prefetch_buffer;
+        auto const pc = registers[registers::pc].value;
+        if (registers.is_thumb()) {
+            return {.address = pc - 4, .opcode = buffer.read<thumb::instruction>().value, .thumb = true};
+        }
+        return {.address = pc - 8, .opcode = buffer.read<arm::instruction>().value, .thumb = false};
+    }
+    // empty if nothing is different
+    [[nodiscard]]auto compare(u64 const from) const
+        -> std::string {
+        auto const& expected = m_reference.get_regitsters_contents();
+        auto const& actual   = m_candidate.get_regitsters_contents();
+        auto differences = std::string{};
+        auto const check = [&](std::string_view const name, u32 const reference, u32 const candidate) {
+            if (reference == candidate) return;
+            differences += fmt::format("  {:<5} {:#010x} interpreter, {:#010x} candidate\n", name, reference, candidate);
+        };
+        for (u32 i = 0; i < 16; ++i) {
+            check(fmt::format("r{}", i), expected[i].value, actual[i].value);
+        }
+        check("cpsr", expected.cpsr().val, actual.cpsr().val);
+        check("spsr", expected.spsr().val, actual.spsr().val);
+        if (m_reference_memory.writes() != m_candidate_memory.writes()) {
+            differences += "  writes differ\n";
+            differences += describe_writes("interpreter", m_reference_memory.writes());
+            differences += describe_writes("candidate", m_candidate_memory.writes());
+        }
+        if (differences.empty()) return differences;
+
+        auto report = fmt::format("diverged after {} instructions, in these:\n", from);
+        for (auto const& [address, opcode, thumb] : m_trace) {
+            report += thumb
+                ? fmt::format("  {:#010x}: {:#06x} (thumb)\n", address, opcode)
+                : fmt::format("  {:#010x}: {:#010x} {}\n", address, opcode, disassemble_arm(opcode));
+        }
+        return report + differences;
+    }
+    [[nodiscard]]static auto describe_writes(std::string_view const who, std::vector<memory_write> const& writes)
+        -> std::string {
+        auto result = fmt::format("  {}:\n", who);
+        for (auto const& [address, value, size] : writes) {
+            result += fmt::format("    [{:#010x}] = {:#010x}, {} bytes\n", address, value, 4u >> static_cast<u32>(size));
+        }
+        return result;
+    }
+
+    write_log<Memory> m_reference_memory;
+    write_log<Memory> m_candidate_memory;
+    arm7tdmi m_reference;
+    arm7tdmi m_candidate;
+    std::vector<traced> m_trace;
+    engine m_engine;
+};
+
+}
+
+#endif
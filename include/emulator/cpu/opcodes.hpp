@@ -98,13 +98,14 @@ private:
 
 } // namespace arm
 
+// thumb has no bells and whistles worth collapsing, every variation is just its own
+// entry in the set, so this one is a plain wrapper around the enum
 class thumb_instruction {
 public:
     enum class set : u32;
     constexpr thumb_instruction(set);
     [[nodiscard]]constexpr auto as_index() const noexcept -> size_t;
     [[nodiscard]]constexpr auto handle() const noexcept -> set;
-    [[nodiscard]]constexpr auto base() const noexcept -> thumb_instruction;
     [[nodiscard]]static consteval auto count() noexcept -> size_t;
 private:
   set m_instruction;
@@ -632,6 +633,124 @@ static_assert(instruction_spec::construct<instruction_spec::set::orr>(immediate_
 
 } // namespace arm
 
+enum class thumb_instruction::set : u32 {
+    lsl_imm, lsr_imm, asr_imm,
+    add_reg, sub_reg, add_imm3, sub_imm3,
+    mov_imm, cmp_imm, add_imm, sub_imm,
+    and_, eor, lsl, lsr, asr, adc, sbc, ror, //NOLINT
+    tst, neg, cmp, cmn, orr, mul, bic, mvn,
+    add_hi, cmp_hi, mov_hi, bx,
+    ldr_pc,
+    str_reg, strb_reg, ldr_reg, ldrb_reg,
+    strh_reg, ldsb_reg, ldrh_reg, ldsh_reg,
+    str_imm, ldr_imm, strb_imm, ldrb_imm,
+    strh_imm, ldrh_imm,
+    str_sp, ldr_sp,
+    add_pc, add_sp,
+    add_sp_imm,
+    push, pop,
+    stmia, ldmia,
+    b_cond,
+    swi,
+    b,
+    bl_hi, bl_lo,
+    undefined,
+
+    count,
+};
+
+constexpr thumb_instruction::thumb_instruction(set instruction)
+    : m_instruction{instruction} {}
+constexpr auto thumb_instruction::as_index() const noexcept
+    -> size_t { return std::to_underlying(m_instruction); }
+constexpr auto thumb_instruction::handle() const noexcept
+    -> set { return m_instruction; }
+consteval auto thumb_instruction::count() noexcept
+    -> size_t { return std::to_underlying(set::count); }
+
+namespace thumb::detail {
+// bits 15 to 6 are enough to tell every thumb instruction apart,
+// including alu and hi register operations
+inline constexpr std::size_t decode_bits = 10;
+
+[[nodiscard]]constexpr auto to_index(instruction const instr) noexcept
+    -> std::size_t { return instr.value >> (16 - decode_bits); }
+
+[[nodiscard]]constexpr auto decode_slow(instruction const instr) noexcept
+    -> thumb_instruction::set {
+    using enum thumb_instruction::set;
+    switch (instr[15, 13].value) {
+        case 0b000: {
+            if (instr[12, 11].value == 0b11) {
+                constexpr std::array add_subtract{add_reg, sub_reg, add_imm3, sub_imm3};
+                return add_subtract[instr[10, 9].value];
+            }
+            constexpr std::array move_shifted{lsl_imm, lsr_imm, asr_imm};
+            return move_shifted[instr[12, 11].value];
+        }
+        case 0b001: {
+            constexpr std::array immediate{mov_imm, cmp_imm, add_imm, sub_imm};
+            return immediate[instr[12, 11].value];
+        }
+        case 0b010: {
+            if (instr[12] == 0_bit) {
+                if (instr[11] == 1_bit) return ldr_pc;
+                if (instr[10] == 0_bit) {
+                    constexpr std::array alu{
+                        and_, eor, lsl, lsr, asr, adc, sbc, ror,
+                        tst,  neg, cmp, cmn, orr, mul, bic, mvn,
+                    };
+                    return alu[instr[9, 6].value];
+                }
+                constexpr std::array hi_register{add_hi, cmp_hi, mov_hi, bx};
+                return hi_register[instr[9, 8].value];
+            }
+            if (instr[9] == 0_bit) {
+                constexpr std::array register_offset{str_reg, strb_reg, ldr_reg, ldrb_reg};
+                return register_offset[instr[11, 10].value];
+            }
+            constexpr std::array sign_extended{strh_reg, ldsb_reg, ldrh_reg, ldsh_reg};
+            return sign_extended[instr[11, 10].value];
+        }
+        case 0b011: {
+            constexpr std::array immediate_offset{str_imm, ldr_imm, strb_imm, ldrb_imm};
+            return immediate_offset[instr[12, 11].value];
+        }
+        case 0b100: {
+            if (instr[12] == 0_bit) return instr[11] == 1_bit ? ldrh_imm : strh_imm;
+            return instr[11] == 1_bit ? ldr_sp : str_sp;
+        }
+        case 0b101: {
+            if (instr[12] == 0_bit) return instr[11] == 1_bit ? add_sp : add_pc;
+            if (instr[11, 8].value == 0b0000) return add_sp_imm;
+            if (instr[10, 9].value == 0b10) return instr[11] == 1_bit ? pop : push;
+            return undefined;
+        }
+        case 0b110: {
+            if (instr[12] == 0_bit) return instr[11] == 1_bit ? ldmia : stmia;
+            if (instr[11, 8].value == 0b1111) return swi;
+            if (instr[11, 8].value == 0b1110) return undefined;
+            return b_cond;
+        }
+        case 0b111: {
+            constexpr std::array branch{b, undefined, bl_hi, bl_lo};
+            return branch[instr[12, 11].value];
+        }
+        default: std::unreachable();
+    }
+}
+
+consteval auto generate_decode_lut() {
+    auto ret = std::array<thumb_instruction::set, 1uz << decode_bits>{};
+    for (std::size_t i = 0; i < ret.size(); ++i) {
+        ret[i] = decode_slow({hword{static_cast<u16>(i << (16 - decode_bits))}});
+    }
+    return ret;
+}
+
+inline constexpr auto decode_lut = generate_decode_lut();
+} // namespace thumb::detail
+
 } // namespace fgba::cpu
 
 
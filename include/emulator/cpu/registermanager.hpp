@@ -6,6 +6,8 @@
 #include <cassert>
 
 #include "emulator/cpudefines.hpp"
+#include "emulator/save-state.hpp"
+#include "fgba-defines.hpp"
 
 namespace fgba::cpu {
 
@@ -110,26 +112,133 @@ public:
         -> word const& {
         return (*this)[index.value];
     }
+    // ldm and stm with the s bit reach past whatever mode is banked in
+    [[nodiscard]]constexpr auto user(size_t const index) noexcept
+        -> word& { return m_register_bank[index]; }
     [[nodiscard]]constexpr auto pc() noexcept
         -> word& { return m_register_bank[15]; }
     [[nodiscard]]constexpr auto lr() noexcept
         -> word& { return (*this)[14]; }
     [[nodiscard]]constexpr auto sp() noexcept
         -> word& { return (*this)[13]; }
+    // flags are brought up to date first, so whatever is done with cpsr sees the real nzcv
     [[nodiscard]]constexpr auto cpsr() noexcept
-        -> psr& { return m_cpsr; }
+        -> psr& {
+        materialize_flags();
+        return m_cpsr;
+    }
     [[nodiscard]]constexpr auto cpsr() const noexcept
-        -> psr const& { return m_cpsr; }
+        -> psr const& {
+        materialize_flags();
+        return m_cpsr;
+    }
+    // t bit is never lazy, looking at it doesn't need flags
+    [[nodiscard]]constexpr auto is_thumb() const noexcept
+        -> bool { return m_cpsr.is_thumb(); }
+    // carry going into adc, rrx and friends
+    [[nodiscard]]constexpr auto carry() const noexcept
+        -> bool {
+#ifdef FGBA_LAZY_FLAGS
+        if (m_flags_pending) return m_flag_carry;
+#endif
+        return m_cpsr.check_ccf(ccf::c);
+    }
+    // nz from result, c as given, v stays
+    FGBA_FORCE_INLINE
+    constexpr auto set_logical_flags(word const result, bool const carry) noexcept
+        -> void {
+#ifdef FGBA_LAZY_FLAGS
+        m_flag_result   = result.value;
+        m_flag_carry    = carry;
+        m_flags_pending = true;
+#else
+        set_nzc(result.value, carry);
+#endif
+    }
+    // nz from result, c as given, v from whether operands of the same sign gave a result of the other
+    FGBA_FORCE_INLINE
+    constexpr auto set_arithmetic_flags(word const result, bool const carry, word const operand1, word const operand2) noexcept
+        -> void {
+#ifdef FGBA_LAZY_FLAGS
+        m_flag_result       = result.value;
+        m_flag_carry        = carry;
+        m_overflow_operand1 = operand1.value;
+        m_overflow_operand2 = operand2.value;
+        m_overflow_result   = result.value;
+        m_flags_pending     = true;
+        m_overflow_pending  = true;
+#else
+        set_nzc(result.value, carry);
+        m_cpsr.set_ccf(ccf::v, overflowed(operand1.value, operand2.value, result.value));
+#endif
+    }
     [[nodiscard]]constexpr auto spsr() noexcept
         -> psr& { return m_spsr[m_spsr_index]; }
     [[nodiscard]]constexpr auto spsr() const noexcept
         -> psr const& { return m_spsr[m_spsr_index]; }
+    // writes whatever lazy flags are pending into cpsr, nothing to do without FGBA_LAZY_FLAGS
+    constexpr auto materialize_flags() const noexcept
+        -> void {
+#ifdef FGBA_LAZY_FLAGS
+        if (m_flags_pending) {
+            set_nzc(m_flag_result, m_flag_carry);
+            m_flags_pending = false;
+        }
+        if (m_overflow_pending) {
+            // logical operations in between changed the result but not the one v came from
+            m_cpsr.set_ccf(ccf::v, overflowed(m_overflow_operand1, m_overflow_operand2, m_overflow_result));
+            m_overflow_pending = false;
+        }
+#endif
+    }
+    // only what the cpu really has, flags go in worked out and whatever lazy flags kept is left behind
+    auto save_state(state_writer& state) const
+        -> void {
+        state.write(cpsr());
+        state.write(m_register_bank);
+        state.write(m_spsr);
+        state.write(m_active_registers_offset);
+        state.write(u32{m_spsr_index});
+    }
+    auto load_state(state_reader& state)
+        -> void {
+        state.read_into(m_cpsr);
+        state.read_into(m_register_bank);
+        state.read_into(m_spsr);
+        state.read_into(m_active_registers_offset);
+        m_spsr_index = state.read<u32>();
+#ifdef FGBA_LAZY_FLAGS
+        m_flags_pending    = false;
+        m_overflow_pending = false;
+#endif
+    }
 private:
-    psr m_cpsr; 
+    [[nodiscard]]static constexpr auto overflowed(u32 const operand1, u32 const operand2, u32 const result) noexcept
+        -> bool { return (((operand1 ^ result) & ~(operand1 ^ operand2)) >> 31) != 0; }
+    constexpr auto set_nzc(u32 const result, bool const carry) const noexcept
+        -> void {
+        m_cpsr.val = (m_cpsr.val & ~(ccf::n | ccf::z | ccf::c))
+                   | (result & ccf::n)
+                   | (result == 0 ? ccf::z : 0_u32)
+                   | (carry ? ccf::c : 0_u32);
+    }
+    // mutable so flags can be worked out when someone only reads cpsr
+    mutable psr m_cpsr; 
     std::array<word, 31> m_register_bank;
     std::array<psr, 5> m_spsr;
     std::array<unsigned, 16> m_active_registers_offset;
-    unsigned m_spsr_index;
+    unsigned m_spsr_index{};
+#ifdef FGBA_LAZY_FLAGS
+    // Lazy flags: flag setting data processing only records what it computed and cpsr is updated
+    // from it once something actually looks at nzcv, most flags are overwritten before that.
+    mutable u32 m_flag_result{};
+    mutable u32 m_overflow_operand1{};
+    mutable u32 m_overflow_operand2{};
+    mutable u32 m_overflow_result{};
+    mutable bool m_flag_carry{};
+    mutable bool m_flags_pending{};
+    mutable bool m_overflow_pending{};
+#endif
 };
 
 }
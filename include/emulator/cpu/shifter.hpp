@@ -206,10 +206,11 @@ template<shifts Shift, s_bit S>
 constexpr auto barrel([[maybe_unused]] word const instruction, word const operand, [[maybe_unused]] cpu::register_manager const& rm) noexcept
     -> shift_t<S> {
 
-    [[maybe_unused]]auto const shift_amount          = instruction[11, 5].value;
+    [[maybe_unused]]auto const shift_amount          = instruction[11, 7].value;
     [[maybe_unused]]auto const shift_register        = instruction[11, 8].value;
-    [[maybe_unused]]auto const register_shift_amount = rm[shift_register].value;
-    [[maybe_unused]]auto const carryin               = rm.cpsr().check_ccf(ccf::c);
+    // only the bottom byte of rs counts
+    [[maybe_unused]]auto const register_shift_amount = rm[shift_register].value & 0xff;
+    [[maybe_unused]]auto const carryin               = rm.carry();
 
 
     if constexpr (Shift == cpu::shifts::null) {
@@ -229,13 +230,13 @@ constexpr auto barrel([[maybe_unused]] word const instruction, word const operan
     } else if constexpr (Shift == shifts::ror) {
         return shifter::shiftror<S>(shift_amount, operand);
     } else if constexpr (Shift == shifts::rslsl) {
-        return shifter::shiftrslsl<S>(shift_amount, operand, carryin);
+        return shifter::shiftrslsl<S>(register_shift_amount, operand, carryin);
     } else if constexpr (Shift == shifts::rslsr) {
-        return shifter::shiftrslsr<S>(shift_amount, operand, carryin);
+        return shifter::shiftrslsr<S>(register_shift_amount, operand, carryin);
     } else if constexpr (Shift == shifts::rsasr) {
-        return shifter::shiftrsasr<S>(shift_amount, operand, carryin);
+        return shifter::shiftrsasr<S>(register_shift_amount, operand, carryin);
     } else if constexpr (Shift == shifts::rsror) {
-        return shifter::shiftrsror<S>(shift_amount, operand, carryin);
+        return shifter::shiftrsror<S>(register_shift_amount, operand, carryin);
     } else {
         static_assert(always_false<Shift>, "you passed UNACCEPTABLE shift enum");
     }
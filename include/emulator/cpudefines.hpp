@@ -1,12 +1,15 @@
 #ifndef FGBA_DEFINES_HPP
 #define FGBA_DEFINES_HPP
+#include <array>
 #include <bit>
 #include <mdspan>
 #include <cstring>
 #include <cstddef>
 #include <type_traits>
+#include <utility>
 #include "fgba-defines.hpp"
 #include "utility/funky-ints.hpp"
+#include "utility/triple-buffer.hpp"
 //Utility header where helpers and aliases are defined
 
 namespace fgba {
@@ -30,7 +33,54 @@ template<>
 struct half_width<u16> { using type = u8; };
 template<typename T>
 using half_width_t = typename half_width<T>::type;
-using lcd_display_view = std::mdspan<std::byte const, std::extents<size_t, 3, 240, 160>>;
+inline constexpr size_t lcd_width  = 240;
+inline constexpr size_t lcd_height = 160;
+// how ppu lays out pixels it draws, whatever is cheapest for the frontend to take
+enum class pixel_format : u8 {
+    rgb888,
+    rgba8888,
+    bgra8888,
+    rgb565,
+    // what gba uses itself, so it is just a copy
+    bgr555,
+
+    count,
+};
+[[nodiscard]]constexpr auto bytes_per_pixel(pixel_format const format) noexcept
+    -> size_t {
+    switch (format) {
+        case pixel_format::rgb888:   return 3;
+        case pixel_format::rgba8888: return 4;
+        case pixel_format::bgra8888: return 4;
+        case pixel_format::rgb565:   return 2;
+        case pixel_format::bgr555:   return 2;
+        default: return 0;
+    }
+}
+// rows of the screen top to bottom, each is lcd_width pixels in the given format
+using lcd_rows_view = std::mdspan<std::byte const, std::extents<size_t, lcd_height, std::dynamic_extent>>;
+struct lcd_display_view {
+    lcd_rows_view rows;
+    pixel_format format;
+};
+// finished frame, the way it is handed from the emulator to whoever shows it
+struct lcd_frame {
+    alignas(32) std::array<std::byte, lcd_width * lcd_height * 4> pixels;
+    pixel_format format;
+    // frames since power on
+    u64 number;
+
+    [[nodiscard]]auto view() const noexcept
+        -> lcd_display_view {
+        return {
+            .rows   = lcd_rows_view{pixels.data(), lcd_width * bytes_per_pixel(format)},
+            .format = format,
+        };
+    }
+    [[nodiscard]]auto size_bytes() const noexcept
+        -> size_t { return lcd_width * lcd_height * bytes_per_pixel(format); }
+};
+using lcd_frame_mailbox = triple_buffer<lcd_frame>;
 
 inline constexpr std::byte uninitialized_byte{0xeb};
 inline constexpr u32 unitialized_word{0xebebebeb};
@@ -53,6 +103,41 @@ enum ccf : u32 {
     c = 1_u32 << 29,
     v = 1_u32 << 28,
 };
+// top nibble of every arm instruction and bits 11:8 of a thumb conditional branch
+enum class condition : u32 {
+    eq, ne, cs, cc, mi, pl, vs, vc, hi, ls, ge, lt, gt, le, al, nv,
+
+    count,
+};
+// Bit k of the entry for a condition says whether it passes when cpsr flags, as the nzcv nibble, are k.
+// Checking a condition is then a shift and a mask instead of a switch with a branch per case.
+inline constexpr auto condition_table = [] {
+    auto table = std::array<u16, std::to_underlying(condition::count)>{};
+    for (u32 flags = 0; flags < 16; ++flags) {
+        bool const n = (flags & 0b1000) != 0;
+        bool const z = (flags & 0b0100) != 0;
+        bool const c = (flags & 0b0010) != 0;
+        bool const v = (flags & 0b0001) != 0;
+        auto const passes = std::array{
+            z, not z, c, not c, n, not n, v, not v,
+            c and not z, not c or z, n == v, n != v, not z and n == v, z or n != v,
+            // nv is unpredictable on armv4, never executing it is what most emulators settle on
+            true, false,
+        };
+        for (u32 cond = 0; cond < passes.size(); ++cond) {
+            table[cond] |= static_cast<u16>(passes[cond] << flags);
+        }
+    }
+    return table;
+}();
+// psr is whole cpsr value, flags sit in its top nibble
+FGBA_FORCE_INLINE
+constexpr auto condition_passed(u32 const psr, u32 const cond) noexcept
+    -> bool { return ((condition_table[cond] >> (psr >> 28)) & 1) != 0; }
+// al is what nearly all arm code is, checking for it first skips the table and doesn't need cpsr at all
+FGBA_FORCE_INLINE
+constexpr auto is_unconditional(arm::instruction const instruction) noexcept
+    -> bool { return instruction.value >> 28 == std::to_underlying(condition::al); }
 template<typename E>
 consteval auto enum_size() -> size_t { return E::size; }
 enum class shifts : unsigned {
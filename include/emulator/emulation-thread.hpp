@@ -0,0 +1,115 @@
+#ifndef FGBA_EMULATION_THREAD_HPP_POQWIEURYT
+#define FGBA_EMULATION_THREAD_HPP_POQWIEURYT
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "emulator/cpu/registermanager.hpp"
+#include "emulator/cpudefines.hpp"
+#include "emulator/gbaemu.hpp"
+#include "emulator/movie.hpp"
+#include "emulator/rewind-buffer.hpp"
+#include "utility/spsc-queue.hpp"
+#include "utility/triple-buffer.hpp"
+
+namespace fgba {
+// runs the machine at its own pace on its own thread.
+// the owning thread only talks to it through commands and gets frames and cpu state back,
+// nothing it does ever waits on the emulator or the other way around
+class emulation_thread {
+public:
+    enum class command_type : u8 {
+        pause,
+        resume,
+        // runs a single frame while paused
+        step_frame,
+        // argument says whether to skip bios
+        reset,
+        // argument is the slot, states are kept in memory
+        save_state,
+        load_state,
+        // argument is how many snapshots to go back
+        rewind,
+        // argument is how many frames to run ahead, 0 turns it off
+        set_run_ahead,
+        // argument is the keys held down, see key
+        set_keys,
+        // recording starts from wherever the machine is and goes into the movie path on stop.
+        // reset, loading a state and rewinding stop it too
+        start_recording,
+        stop_recording,
+
+        count,
+    };
+    struct command {
+        command_type type;
+        u32 argument;
+    };
+    static constexpr u32 state_slot_count = 4;
+    // real hardware frame, a bit under 60 of them in a second
+    static constexpr auto frame_duration = std::chrono::nanoseconds{
+        gameboy_advance::cycles_per_frame * 1'000'000'000 / gameboy_advance::clock_rate
+    };
+
+    // machine has to outlive the thread, it starts paused
+    explicit emulation_thread(gameboy_advance& gba, rewind_config const& rewind = {}, std::filesystem::path movie_path = "fgba.movie");
+    emulation_thread(emulation_thread const&) = delete;
+    auto operator=(emulation_thread const&)
+        -> emulation_thread& = delete;
+    ~emulation_thread();
+
+    // false if too many commands are queued, nothing was posted then
+    auto post(command) noexcept
+        -> bool;
+    [[nodiscard]]auto get_frames() noexcept
+        -> lcd_frame_mailbox& { return m_gba->get_frames(); }
+    // registers as they were at the end of the last emulated frame
+    [[nodiscard]]auto get_cpu_snapshots() noexcept
+        -> triple_buffer<cpu::register_manager>& { return m_cpu_snapshots; }
+    [[nodiscard]]auto is_running() const noexcept
+        -> bool { return m_running.load(std::memory_order_relaxed); }
+    [[nodiscard]]auto get_run_ahead() const noexcept
+        -> u32 { return m_run_ahead.load(std::memory_order_relaxed); }
+    [[nodiscard]]auto is_recording() const noexcept
+        -> bool { return m_recording_flag.load(std::memory_order_relaxed); }
+    [[nodiscard]]auto get_rewind_config() const noexcept
+        -> rewind_config const& { return m_rewind.get_config(); }
+private:
+    auto run(std::stop_token const& stop)
+        -> void;
+    auto handle(command) 
+        -> void;
+    auto run_frame()
+        -> void;
+    // writes out whatever was recorded, if anything
+    auto stop_recording()
+        -> void;
+
+    gameboy_advance* m_gba;
+    spsc_queue<command, 64> m_commands;
+    // bumped on every post, paused thread sleeps on it
+    std::atomic<u32> m_posted{0};
+    std::atomic<bool> m_running{false};
+    std::atomic<u32> m_run_ahead{0};
+    std::atomic<bool> m_recording_flag{false};
+    u32 m_pending_steps{0};
+    triple_buffer<cpu::register_manager> m_cpu_snapshots;
+    std::array<std::vector<std::byte>, state_slot_count> m_state_slots;
+    rewind_buffer m_rewind;
+    // the latest snapshot goes here before the rewind buffer takes a delta of it
+    std::vector<std::byte> m_snapshot;
+    u16 m_keys{0};
+    std::optional<movie> m_recording;
+    std::filesystem::path m_movie_path;
+    // last, so everything above is there for as long as the thread runs
+    std::jthread m_thread;
+};
+}
+
+#endif
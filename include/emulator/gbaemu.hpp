@@ -8,28 +8,92 @@
 #include "emulator/cpudefines.hpp"
 #include "emulator/mmu/mmu.hpp"
 #include "emulator/ppu/ppu.hpp"
+#include "emulator/save-state.hpp"
+#include "emulator/scheduler.hpp"
+#include <cstddef>
 #include <filesystem>
+#include <span>
+#include <vector>
 
 namespace fgba {
 class gameboy_advance {
 public:
+    static constexpr u64 clock_rate       = 16'777'216;
+    static constexpr u64 cycles_per_frame = ppu::cycles_per_frame;
+
     gameboy_advance();
     auto load_bios(std::filesystem::path const& path) 
         -> void {
         m_mmu.load_bios(path);
     }
+    auto load_gamerom(std::filesystem::path const& path)
+        -> void {
+        m_mmu.load_gamerom(path);
+    }
+    // bios is empty when none was loaded
+    [[nodiscard]]auto loaded_bios() const noexcept
+        -> std::span<std::byte const> { return m_mmu.loaded_bios(); }
+    [[nodiscard]]auto loaded_cartridge() const noexcept
+        -> std::span<std::byte const> { return m_mmu.loaded_cartridge(); }
+    // power cycle, everything but bios, cartridge and its save memory goes back to how it was
+    // at construction. without bios the cpu is put straight into the state bios leaves it in
+    // before jumping into the cartridge
+    auto reset(bool skip_bios = false)
+        -> void;
+    // returns amount of cycles actually run, last block can go a bit over
+    auto run_for(u64 cycles)
+        -> u64;
+    auto run_frame()
+        -> u64 {
+        return run_for(cycles_per_frame);
+    }
+    // runs a frame for real, then `frames` more from a snapshot of it and rolls back.
+    // only the last of those is shown, so input shows up on screen `frames` frames earlier than
+    // the game itself would show it. returns cycles of the real frame
+    auto run_frame_ahead(u32 frames)
+        -> u64;
+    // everything but bios and cartridge, which have to be the same ones when the state is loaded.
+    // saving into the same buffer again doesn't allocate
+    auto save_state(std::vector<std::byte>& state, save_compression compression = save_compression::none) const
+        -> void;
+    [[nodiscard]]auto save_state(save_compression compression = save_compression::none) const
+        -> std::vector<std::byte>;
+    // throws if the state is from another version or damaged, in the latter case the machine
+    // may be left half loaded and should be reset or loaded again
+    auto load_state(std::span<std::byte const> state)
+        -> void;
     [[nodiscard]]auto dump_cpu_state() const noexcept
         -> cpu::arm7tdmi const& {
             return m_cpu;
         }
+    // instructions the cpu stepped through since reset, the ones run-ahead threw away included
+    [[nodiscard]]auto retired_instructions() const noexcept
+        -> u64 { return m_cpu.retired(); }
     [[nodiscard]]auto get_display_view() const noexcept
         -> lcd_display_view {
         return m_ppu.get_display_view();
     }
+    [[nodiscard]]auto get_frames() noexcept
+        -> lcd_frame_mailbox& {
+        return m_ppu.get_frames();
+    }
+    // see key for which bit is which
+    auto set_keys(u16 pressed) noexcept
+        -> void { m_mmu.get_keypad().set_pressed(pressed); }
+    auto set_pixel_format(pixel_format format) noexcept
+        -> void { m_ppu.set_pixel_format(format); }
 private:
+    // every other part takes its memory from here, so it goes first
+    mmu::memory_arena m_arena;
+    scheduler m_scheduler;
     cpu::arm7tdmi m_cpu;
     ppu::ppu m_ppu;
     mmu::memory_managment_unit m_mmu;
+    // kept around so run-ahead and rewind don't allocate every frame
+    std::vector<std::byte> m_run_ahead_state;
+    std::vector<std::byte> m_load_scratch;
+    // whole machine as it came out of the constructor, which is what reset goes back to
+    std::vector<std::byte> m_power_on_state;
 };
 }
 
@@ -4,18 +4,38 @@
 #include "emulator/ppu/registers.hpp"
 #include "emulator/ppu/ppu.hpp"
 #include "emulator/mmu/memoryprimitives.hpp"
+#include "emulator/mmu/keypad.hpp"
+#include "emulator/mmu/waitstates.hpp"
 
 namespace fgba::mmu {
 
 class io_registers_map {
 public: 
     using mem_spec = mem_spec<bounds<0x04000000, 0x04000400>, mem_type::ram, bus_size::word>;
-    io_registers_map(ppu::ppu& ppu)
-        : m_ppu{ppu} {}
+    io_registers_map(ppu::ppu& ppu, waitstate_table& waitstates, keypad& keypad)
+        : m_ppu{ppu}, m_waitstates{waitstates}, m_keypad{keypad} {}
+    // registers are handled a byte at a time, wider accesses are just glued together
     template<typename T>
-    auto read(u32 address) const -> T { return address; }
+    auto read(u32 address) const -> T {
+        auto result = T{0};
+        for (u32 i = 0; i < sizeof(T); ++i) {
+            result |= static_cast<T>(static_cast<T>(read_byte(address + i)) << (8 * i));
+        }
+        return result;
+    }
+    template<typename T>
+    auto write(u32 address, T data) -> void {
+        for (u32 i = 0; i < sizeof(T); ++i) {
+            write_byte(address + i, static_cast<u8>(data >> (8 * i)));
+        }
+    }
+private:
+    [[nodiscard]]auto read_byte(u32 address) const -> u8;
+    auto write_byte(u32 address, u8 data) -> void;
 private:
     ppu::ppu& m_ppu;
+    waitstate_table& m_waitstates;
+    keypad& m_keypad;
 };
 
 
@@ -0,0 +1,55 @@
+#ifndef FGBA_KEYPAD_HPP_WERTYUSDFG
+#define FGBA_KEYPAD_HPP_WERTYUSDFG
+
+#include <utility>
+
+#include "fgba-defines.hpp"
+
+namespace fgba {
+// in the order of KEYINPUT bits
+enum class key : u8 {
+    a,
+    b,
+    select,
+    start,
+    right,
+    left,
+    up,
+    down,
+    r,
+    l,
+
+    count,
+};
+[[nodiscard]]constexpr auto key_mask(key const key) noexcept
+    -> u16 { return static_cast<u16>(1u << std::to_underlying(key)); }
+}
+
+namespace fgba::mmu {
+// Buttons as the game sees them. Whoever owns the machine says what is held down, between frames
+// or whenever, the game finds out the next time it reads KEYINPUT.
+class keypad {
+public:
+    static constexpr u32 keyinput_addr = 0x0400'0130;
+    static constexpr u32 keycnt_addr   = 0x0400'0132;
+    static constexpr u16 all_keys      = (1u << std::to_underlying(key::count)) - 1;
+
+    // set bit means the key is held down, same bit order as the register
+    constexpr auto set_pressed(u16 const keys) noexcept
+        -> void { m_pressed = keys & all_keys; }
+    [[nodiscard]]constexpr auto pressed() const noexcept
+        -> u16 { return m_pressed; }
+    // register itself is active low
+    [[nodiscard]]constexpr auto keyinput() const noexcept
+        -> u16 { return static_cast<u16>(~m_pressed & all_keys); }
+    [[nodiscard]]constexpr auto keycnt() const noexcept
+        -> u16 { return m_keycnt; }
+    constexpr auto set_keycnt(u16 const value) noexcept
+        -> void { m_keycnt = value & 0xc3ff; }
+private:
+    u16 m_pressed{0};
+    u16 m_keycnt{0};
+};
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef FGBA_MAPPED_FILE_HPP_RTYUFGHJVB
+#define FGBA_MAPPED_FILE_HPP_RTYUFGHJVB
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace fgba::mmu {
+
+// Read only view of a whole file. Where mmap is available nothing is copied, pages are brought
+// in by the os as they are touched and are shared with every other process mapping the same file.
+// Elsewhere the file is simply read into memory.
+class mapped_file {
+public:
+    mapped_file() noexcept = default;
+    // throws if the file can't be opened, is empty or can't be mapped
+    explicit mapped_file(std::filesystem::path const& path);
+    mapped_file(mapped_file&& other) noexcept;
+    auto operator=(mapped_file&& other) noexcept
+        -> mapped_file&;
+    ~mapped_file();
+
+    [[nodiscard]]auto data() const noexcept
+        -> std::byte const* { return m_data; }
+    [[nodiscard]]auto size() const noexcept
+        -> std::size_t { return m_size; }
+    [[nodiscard]]auto bytes() const noexcept
+        -> std::span<std::byte const> { return {m_data, m_size}; }
+    [[nodiscard]]auto empty() const noexcept
+        -> bool { return m_size == 0; }
+private:
+    auto release() noexcept
+        -> void;
+
+    std::byte const* m_data{};
+    std::size_t m_size{};
+    // only used when there is no mmap
+    std::unique_ptr<std::byte[]> m_buffer;
+};
+
+}
+
+#endif
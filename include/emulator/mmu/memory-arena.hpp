@@ -0,0 +1,78 @@
+#ifndef FGBA_MEMORY_ARENA_HPP_LKJHZXCVBN
+#define FGBA_MEMORY_ARENA_HPP_LKJHZXCVBN
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+#include "emulator/mmu/memoryprimitives.hpp"
+#include "emulator/mmu/zeroed-pages.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::mmu {
+
+// All of the guest memory in one reservation laid out like the gba address map, just squeezed:
+// region n (address bits 24-27) lives at base + (n << slot_shift). Only what a region really has
+// is committed, the rest of its slot stays inaccessible and works as a guard against running off the end.
+// Everything being in one place keeps it close together for the tlb and makes a snapshot a memcpy per region.
+class memory_arena {
+public:
+    // biggest region is 256KiB of ewram, so every slot is followed by at least as much guard
+    static constexpr u32 slot_shift   = 19;
+    static constexpr u32 slot_size    = 1u << slot_shift;
+    static constexpr u32 region_count = 16;
+
+    explicit memory_arena(mem_fill fill = default_mem_fill)
+        : m_base{detail::reserve_pages(arena_size)}, m_fill{fill} {}
+    memory_arena(memory_arena const&) = delete;
+    auto operator=(memory_arena const&)
+        -> memory_arena& = delete;
+    // views handed out point into it
+    memory_arena(memory_arena&&) = delete;
+    auto operator=(memory_arena&&)
+        -> memory_arena& = delete;
+
+    template<spec Spec>
+    [[nodiscard]]static constexpr auto region_of() noexcept
+        -> u32 { return static_cast<u32>(Spec::bounds::lower_bound >> 24); }
+    template<spec Spec>
+    [[nodiscard]]static constexpr auto offset_of() noexcept
+        -> std::size_t { return std::size_t{region_of<Spec>()} << slot_shift; }
+
+    // commits the slot of the region and hands out its memory, every region is claimed once by whoever owns it
+    template<spec Spec>
+    [[nodiscard]]auto claim()
+        -> mem_view<Spec> {
+        static_assert(Spec::bounds::size <= slot_size, "region doesn't fit into its slot");
+        auto* const memory = m_base.get() + offset_of<Spec>();
+        detail::commit_pages(memory, Spec::bounds::size);
+        auto const bytes = std::span<std::byte, Spec::bounds::size>{memory, Spec::bounds::size};
+        if (m_fill == mem_fill::poison) {
+            stdr::fill(bytes, uninitialized_byte);
+        }
+        m_sizes[region_of<Spec>()] = static_cast<u32>(Spec::bounds::size);
+        return mem_view<Spec>{bytes};
+    }
+    [[nodiscard]]auto base() noexcept
+        -> std::byte* { return m_base.get(); }
+    // whatever is claimed in the region, empty if nothing is
+    [[nodiscard]]auto region(u32 const region) noexcept
+        -> std::span<std::byte> { return {m_base.get() + (std::size_t{region} << slot_shift), m_sizes[region]}; }
+    [[nodiscard]]auto region(u32 const region) const noexcept
+        -> std::span<std::byte const> { return {m_base.get() + (std::size_t{region} << slot_shift), m_sizes[region]}; }
+private:
+    static constexpr std::size_t arena_size = std::size_t{region_count} << slot_shift;
+    struct arena_deleter {
+        auto operator()(std::byte* const base) const noexcept
+            -> void { detail::deallocate_zeroed(base, arena_size); }
+    };
+
+    std::unique_ptr<std::byte, arena_deleter> m_base;
+    std::array<u32, region_count> m_sizes{};
+    mem_fill m_fill;
+};
+
+}
+
+#endif
@@ -49,53 +49,27 @@ concept spec = requires {
 };
 static_assert(spec<decltype(dummy)>);
 namespace fgba::mmu {
-template<spec T>
-class mem_owner {
-public:
-    using mem_spec = T;
-    mem_owner()
-        : m_mem_ptr{std::make_unique<std::array<std::byte, T::bounds::size>>()} {
-        stdr::fill(*m_mem_ptr, uninitialized_byte);
-    }
-    mem_owner(mem_owner&&) noexcept = default;
-    auto operator=(mem_owner&&) noexcept
-        -> mem_owner& = default;
-    template<typename U>
-        requires (sizeof(U) <= std::to_underlying(T::bus_size))
-    auto read(u32 address) const noexcept 
-        -> U {
-        assert(address >= T::bounds::lower_bound);
-        assert(address <= T::bounds::upper_bound - sizeof(T));
-        U res;
-        std::memcpy(&res, m_mem_ptr->data() + (address - T::bounds::lower_bound), sizeof(T));
-        return res;
-    }
-    template<typename U>
-        requires (sizeof(U) <= std::to_underlying(T::bus_size))
-    auto write(u32 address, U data) noexcept 
-        -> void requires (T::mem_type == mem_type::ram) {
-        assert(address >= T::bounds::lower_bound);
-        assert(address <= T::bounds::upper_bound - sizeof(T));
-        std::memcpy(m_mem_ptr->data() + (address - T::bounds::lower_bound), &data, sizeof(T));
-    }
-    [[nodiscard]] constexpr auto begin()        noexcept { return m_mem_ptr->begin();  }
-    [[nodiscard]] constexpr auto begin()  const noexcept { return m_mem_ptr->begin();  }
-    [[nodiscard]] constexpr auto end()          noexcept { return m_mem_ptr->end();    }
-    [[nodiscard]] constexpr auto end()    const noexcept { return m_mem_ptr->end();    }
-    [[nodiscard]] constexpr auto cbegin() const noexcept { return m_mem_ptr->cbegin(); }
-    [[nodiscard]] constexpr auto cend()   const noexcept { return m_mem_ptr->cend();   }
-    [[nodiscard]] constexpr auto data()         noexcept { return m_mem_ptr->data();   }
-    [[nodiscard]] constexpr auto data()   const noexcept { return m_mem_ptr->data();   }
-private:
-    std::unique_ptr<std::array<std::byte, T::bounds::size>> m_mem_ptr;
+// what fresh memory looks like. zeroes are free, the poison pattern touches every page
+// but makes reads of memory nobody wrote stand out
+enum class mem_fill : u8 {
+    zero,
+    poison,
+
+    count,
 };
+// release builds can still ask for poison with FGBA_POISON_MEMORY
+#if defined(NDEBUG) and not defined(FGBA_POISON_MEMORY)
+inline constexpr mem_fill default_mem_fill = mem_fill::zero;
+#else
+inline constexpr mem_fill default_mem_fill = mem_fill::poison;
+#endif
 
 template<spec T>
 class mem_view {
 public:
     using mem_spec = T;
-    mem_view(mem_owner<T> const& mem)
-        : m_mem_view{std::span<std::byte, T::bounds::size>{mem}} {}
+    explicit mem_view(std::span<std::byte, T::bounds::size> mem) noexcept
+        : m_mem_view{mem} {}
     mem_view(mem_view const&) noexcept = default;
     auto operator=(mem_view const&) noexcept
         -> mem_view& = default;
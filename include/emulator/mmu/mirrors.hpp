@@ -0,0 +1,35 @@
+#ifndef FGBA_MMU_MIRRORS_HPP_QWMZNXBCVA
+#define FGBA_MMU_MIRRORS_HPP_QWMZNXBCVA
+
+#include <array>
+
+#include "fgba-defines.hpp"
+
+namespace fgba::mmu {
+
+// offset bits of every region by address bits 27:24, the ones above them only pick a mirror
+inline constexpr auto region_masks = std::array<u32, 16>{
+    // bios, nothing, ewram, iwram
+    0x00ff'ffff, 0x00ff'ffff, 0x3'ffff, 0x7fff,
+    // io, palette, vram, oam
+    0x00ff'ffff, 0x3ff, 0x1'ffff, 0x3ff,
+    // three cartridge windows, 32MiB each
+    0x01ff'ffff, 0x01ff'ffff, 0x01ff'ffff, 0x01ff'ffff, 0x01ff'ffff, 0x01ff'ffff,
+    // sram
+    0xffff, 0xffff,
+};
+
+// the same address for every mirror of a byte, anything keeping track of memory by address goes through this
+[[nodiscard]]constexpr auto canonical_address(u32 const address) noexcept
+    -> u32 {
+    auto const region = (address >> 24) & 0xf;
+    auto const mask   = region_masks[region];
+    auto offset = address & mask;
+    // vram is 96KiB, upper 32KiB of every 128KiB mirror are the object tiles again
+    if (region == 0x6 and offset >= 0x1'8000) offset -= 0x8000;
+    return (address & 0x0f00'0000 & ~mask) | offset;
+}
+
+}
+
+#endif
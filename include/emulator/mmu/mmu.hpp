@@ -4,11 +4,14 @@
 #include <utility>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <optional>
 #include <source_location>
+#include <span>
 #include <tuple>
 #include <type_traits>
 
@@ -17,7 +20,13 @@
 #include "fmt/format.h"
 #include "emulator/mmu/memoryprimitives.hpp"
 #include "emulator/mmu/io-registers-map.hpp"
+#include "emulator/mmu/keypad.hpp"
+#include "emulator/mmu/mapped-file.hpp"
+#include "emulator/mmu/mirrors.hpp"
+#include "emulator/mmu/memory-arena.hpp"
+#include "emulator/mmu/waitstates.hpp"
 #include "emulator/ppu/ppu.hpp"
+#include "emulator/save-state.hpp"
 #include "fgba-defines.hpp"
 namespace stdr = std::ranges;
 namespace stdv = std::views;
@@ -32,62 +41,43 @@ using oam_spec      = mem_spec<bounds<0x07000000, 0x07000400>, mem_type::ram, bu
 using gprom0_spec   = mem_spec<bounds<0x08000000, 0x0a000000>, mem_type::rom, bus_size::hword>;
 using gprom1_spec   = mem_spec<bounds<0x0a000000, 0x0c000000>, mem_type::rom, bus_size::hword>;
 using gprom2_spec   = mem_spec<bounds<0x0c000000, 0x0e000000>, mem_type::rom, bus_size::hword>;
-using sram_spec     = mem_spec<bounds<0x0e000000, 0x0e00ffff>, mem_type::ram, bus_size::byte>;
+using sram_spec     = mem_spec<bounds<0x0e000000, 0x0e010000>, mem_type::ram, bus_size::byte>;
 
-namespace detail {
-template<
-    typename Tuple, 
-    typename F, 
-    typename Indices = std::make_index_sequence<std::tuple_size_v<Tuple>> 
->
-struct func_table;
-template<typename Tuple, typename F, size_t I>
-decltype(auto) apply_for_index(Tuple& tup, F&& func) {
-    return std::invoke(std::forward<F>(func), std::get<I>(tup));
-}
-template<typename Tuple, typename F, size_t... Is>
-struct func_table<Tuple, F, std::index_sequence<Is...>> {
-    static constexpr std::array table{
-        &apply_for_index<Tuple, F, Is>...
-    };
+// Fast path memory map.
+//
+// Every access goes through a page table indexed by address bits 27:24 (the region) and 16:15 
+// (32KiB subpage, only vram actually needs it because of its weird 96KiB-in-128KiB mirroring).
+// Entry points straight to the host memory backing the region so load boils down to mask, compare 
+// and memcpy. Offset which is not below the limit goes to the slow path, that is how io, sram, 
+// writes to rom, reads past the end of the cartridge and unmapped memory are handled
+// (they just have limit of 0 or the size of what is really there).
+//
+// Writes to video memory take one more look at the entry, see write_video.
+struct page {
+    std::byte* data{};
+    u32 mask{};
+    u32 limit{};
+    bool video{};
 };
-template<typename Tuple, typename F>
-decltype(auto) runtime_get(Tuple& tup, size_t index, F&& func) {
-    using tuple_type = std::remove_reference_t<Tuple>;
-    return std::invoke(func_table<tuple_type, F>::table[index], tup, std::forward<F>(func));
-}
-}
+inline constexpr u32 page_table_size   = 64;
+inline constexpr u32 pram_region       = 0x5;
+inline constexpr u32 vram_region       = 0x6;
+inline constexpr u32 oam_region        = 0x7;
+inline constexpr u32 address_space_end = 0x1000'0000;
+using page_table = std::array<page, page_table_size>;
+
+// page table mirrors regions the same way canonical_address folds them
+static_assert(region_masks[0x2] == ewram_spec::bounds::size - 1 and region_masks[0x3] == iwram_spec::bounds::size - 1);
+static_assert(region_masks[0x5] == pram_spec::bounds::size - 1 and region_masks[0x7] == oam_spec::bounds::size - 1);
+static_assert(region_masks[0x8] == gprom0_spec::bounds::size - 1 and region_masks[0xe] == sram_spec::bounds::size - 1);
+
+[[nodiscard]]constexpr auto page_index(u32 address) noexcept
+    -> u32 { return ((address >> 22) & 0b11'1100) | ((address >> 15) & 0b11); }
 
-template<typename T, typename MemAccessor>
-[[nodiscard]] auto read_impl(MemAccessor&& mem, u32 address)
-    -> std::optional<T> {
-    using spec_type = std::decay_t<MemAccessor>::mem_spec;
-    if constexpr (std::same_as<spec_type, sram_spec>) return std::nullopt;
-    else {
-        if (address >= spec_type::bounds::upper_bound) return std::nullopt;
-        if constexpr (sizeof(T) >= std::to_underlying(spec_type::bus_size)) {
-            return (mem.template read<half_width_t<T>>(address) << 4 * sizeof(T)) | mem.template read<half_width_t<T>>(address + 2);
-        } else {
-            return mem.template read<T>(address);
-        }
-    }
-}
 class memory_managment_unit {
 public:
-    memory_managment_unit(ppu::ppu& ppu) 
-        : m_mem{
-            mem_owner<bios_spec>{}, 
-            mem_owner<ewram_spec>{}, 
-            mem_owner<iwram_spec>{}, 
-            ppu,
-            ppu.get_pram(),
-            ppu.get_vram(),
-            ppu.get_oam(),
-            mem_owner<gprom0_spec>{},
-            mem_owner<gprom1_spec>{},
-            mem_owner<gprom2_spec> {},
-            mem_owner<sram_spec>{},
-        } {}
+    // bios, work ram and sram are claimed from the same arena the ppu took its memory from
+    memory_managment_unit(ppu::ppu& ppu, memory_arena& arena);
     memory_managment_unit(memory_managment_unit const&) = delete;
     auto operator=(memory_managment_unit const&)
         -> memory_managment_unit& = delete;
@@ -95,37 +85,128 @@ public:
     auto operator=(memory_managment_unit&&) noexcept
         -> memory_managment_unit& = delete;
     template<typename T>
-    [[nodiscard]]auto read(u32 address) const noexcept
-        -> std::optional<T> {
-        return detail::runtime_get(m_mem, 0, [address](auto&& mem_region) {
-            return read_impl<T>(mem_region, address);
-        });
+    [[nodiscard]]FGBA_FORCE_INLINE auto read(u32 address) const noexcept
+        -> T {
+        auto const& page   = m_read_pages[page_index(address)];
+        auto const  offset = address & page.mask & ~static_cast<u32>(sizeof(T) - 1);
+        if (offset < page.limit and address < address_space_end) [[likely]] {
+            T result;
+            std::memcpy(&result, page.data + offset, sizeof(T));
+            return result;
+        }
+        return read_slow<T>(address);
     }
     template<typename T>
-    auto write(u32 address, T data)
+    FGBA_FORCE_INLINE auto write(u32 address, T data) noexcept
         -> void {
-        detail::runtime_get(m_mem, 0, [](auto&& mem_region) {
-        });
+        auto const& page   = m_write_pages[page_index(address)];
+        auto const  offset = address & page.mask & ~static_cast<u32>(sizeof(T) - 1);
+        if (offset < page.limit and address < address_space_end) [[likely]] {
+            if (page.video) [[unlikely]] {
+                write_video<T>(address, page.data + offset, data);
+                return;
+            }
+            std::memcpy(page.data + offset, &data, sizeof(T));
+            return;
+        }
+        write_slow<T>(address, data);
+    }
+    // this is what cpu bus talks to. Narrow reads are replicated across the whole data bus
+    // so cpu can pick the right lane just by rotating it. Both return how many cycles the access took
+    auto memory_access_read(cpu::address address, cpu::data_size mas, word& data_bus) noexcept
+        -> u32 {
+        switch (mas) {
+            case cpu::data_size::word:  data_bus = word{read<u32>(address.value)}; break;
+            case cpu::data_size::hword: data_bus = word{u32{read<u16>(address.value)} * 0x0001'0001_u32}; break;
+            case cpu::data_size::byte:  data_bus = word{u32{read<u8>(address.value)} * 0x0101'0101_u32}; break;
+            default: std::unreachable();
+        }
+        m_open_bus = data_bus.value;
+        return access_cycles(address.value, mas);
+    }
+    auto memory_access_write(cpu::address address, cpu::data_size mas, word data_bus) noexcept
+        -> u32 {
+        switch (mas) {
+            case cpu::data_size::word:  write<u32>(address.value, data_bus.value); break;
+            case cpu::data_size::hword: write<u16>(address.value, static_cast<u16>(data_bus.value)); break;
+            case cpu::data_size::byte:  write<u8>(address.value, static_cast<u8>(data_bus.value)); break;
+            default: std::unreachable();
+        }
+        return access_cycles(address.value, mas);
     }
+    // what a sequential access would cost, without doing one
+    [[nodiscard]]auto sequential_cycles(cpu::address address, cpu::data_size mas) const noexcept
+        -> u32 { return m_waitstates.cycles(address.value, mas, true); }
+    // a word read which leaves open bus and sequential tracking alone, for decoding ahead
+    [[nodiscard]]auto peek(cpu::address address) const noexcept
+        -> word { return word{read<u32>(address.value)}; }
 
+    [[nodiscard]]auto get_keypad() noexcept
+        -> keypad& { return m_keypad; }
     auto load_bios(std::filesystem::path const& path) 
         -> void;
     auto load_gamerom(std::filesystem::path const& path_to_cartridge)
         -> void;
+    // empty until one is loaded
+    [[nodiscard]]auto loaded_bios() const noexcept
+        -> std::span<std::byte const> {
+        if (not m_bios_loaded) return {};
+        return {m_bios.data(), bios_spec::bounds::size};
+    }
+    [[nodiscard]]auto loaded_cartridge() const noexcept
+        -> std::span<std::byte const> { return m_cartridge.bytes(); }
+    // bus state only, memory regions are saved with the arena and the cartridge is not part of a state
+    auto save_state(state_writer& state) const
+        -> void;
+    auto load_state(state_reader& state)
+        -> void;
+private:
+    // cpu doesn't say whether an access is sequential, but an access right
+    // after the previous one is what sequential means
+    FGBA_FORCE_INLINE auto access_cycles(u32 const address, cpu::data_size const mas) noexcept
+        -> u32 {
+        auto const sequential = address == m_next_sequential;
+        m_next_sequential = address + (4u >> std::to_underlying(mas));
+        return m_waitstates.cycles(address, mas, sequential);
+    }
+    auto map_cartridge() noexcept
+        -> void;
+    // video memory has no byte lanes, those are sorted out on the slow path.
+    // ppu hears about the rest so it knows which lines to draw again
+    template<typename T>
+    auto write_video(u32 const address, std::byte* const destination, T const data) noexcept
+        -> void {
+        if constexpr (sizeof(T) == 1) {
+            write_slow<T>(address, data);
+        } else {
+            std::memcpy(destination, &data, sizeof(T));
+            if (address >> 24 != oam_region) m_ppu.note_write(address);
+        }
+    }
+    template<typename T>
+    [[nodiscard]]auto read_slow(u32 address) const noexcept
+        -> T;
+    template<typename T>
+    auto write_slow(u32 address, T data) noexcept
+        -> void;
 private:
-    std::tuple<
-        mem_owner<bios_spec>, 
-        mem_owner<ewram_spec>, 
-        mem_owner<iwram_spec>, 
-        io_registers_map, 
-        mem_view<pram_spec>, 
-        mem_view<vram_spec>, 
-        mem_view<oam_spec>, 
-        mem_owner<gprom0_spec>, 
-        mem_owner<gprom1_spec>, 
-        mem_owner<gprom2_spec>, 
-        mem_owner<sram_spec>
-    > m_mem;
+    waitstate_table        m_waitstates;
+    keypad                 m_keypad;
+    u32                    m_next_sequential{0};
+    // last thing read through the cpu bus, mostly the opcode prefetched last.
+    // unmapped memory reads back as this
+    u32                    m_open_bus{0};
+    bool                   m_bios_loaded{false};
+    mem_view<bios_spec>    m_bios;
+    mem_view<ewram_spec>   m_ewram;
+    mem_view<iwram_spec>   m_iwram;
+    io_registers_map       m_io;
+    // all three wait state windows look at this one mapping
+    mapped_file            m_cartridge;
+    mem_view<sram_spec>    m_sram;
+    ppu::ppu&              m_ppu;
+    page_table m_read_pages{};
+    page_table m_write_pages{};
 };
 }
 
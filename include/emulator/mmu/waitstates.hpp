@@ -0,0 +1,90 @@
+#ifndef FGBA_WAITSTATES_HPP_ZXCVQWERAS
+#define FGBA_WAITSTATES_HPP_ZXCVQWERAS
+
+#include <array>
+#include <utility>
+
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::mmu {
+
+// How many cycles a bus access takes, looked up by region, width and whether it is sequential.
+//
+// Internal memory is fixed, cartridge windows and sram follow WAITCNT. 32 bit accesses to
+// 16 bit buses are two accesses back to back, the second one is always sequential.
+// The whole thing is rebuilt on every WAITCNT write, so an access is a single index.
+class waitstate_table {
+public:
+    static constexpr u32 waitcnt_addr = 0x0400'0204;
+
+    constexpr waitstate_table() noexcept { set_waitcnt(0); }
+
+    [[nodiscard]]FGBA_FORCE_INLINE constexpr auto cycles(u32 const address, cpu::data_size const mas, bool const sequential) const noexcept
+        -> u32 {
+        return m_cycles[index_of((address >> 24) & 0xf, mas, sequential)];
+    }
+    [[nodiscard]]constexpr auto waitcnt() const noexcept
+        -> u16 { return m_waitcnt; }
+    // gamepak type bit is read only and always reads 0 for a gba cartridge
+    constexpr auto set_waitcnt(u16 const value) noexcept
+        -> void {
+        m_waitcnt = static_cast<u16>(value & 0x7fff);
+        rebuild();
+    }
+private:
+    [[nodiscard]]static constexpr auto index_of(u32 const region, cpu::data_size const mas, bool const sequential) noexcept
+        -> u32 { return region << 3 | static_cast<u32>(std::to_underlying(mas)) << 1 | (sequential ? 1 : 0); }
+
+    constexpr auto set(u32 const region, u32 const narrow_n, u32 const narrow_s, u32 const wide_n, u32 const wide_s) noexcept
+        -> void {
+        for (auto const mas : {cpu::data_size::hword, cpu::data_size::byte}) {
+            m_cycles[index_of(region, mas, false)] = static_cast<u8>(narrow_n);
+            m_cycles[index_of(region, mas, true)]  = static_cast<u8>(narrow_s);
+        }
+        m_cycles[index_of(region, cpu::data_size::word, false)] = static_cast<u8>(wide_n);
+        m_cycles[index_of(region, cpu::data_size::word, true)]  = static_cast<u8>(wide_s);
+    }
+    // 32 bit bus, everything takes the same time
+    constexpr auto set_word_bus(u32 const region, u32 const cycles) noexcept
+        -> void { set(region, cycles, cycles, cycles, cycles); }
+    // 16 bit bus
+    constexpr auto set_hword_bus(u32 const region, u32 const n, u32 const s) noexcept
+        -> void { set(region, n, s, n + s, s + s); }
+
+    constexpr auto rebuild() noexcept
+        -> void {
+        constexpr std::array<u32, 4> first_access{4, 3, 2, 8};
+        auto const field = [this](u32 const shift, u32 const width) {
+            return (m_waitcnt >> shift) & ((1u << width) - 1);
+        };
+        // bios, iwram, io, oam and unmapped space take a single cycle whatever the width
+        for (u32 region = 0; region < 16; ++region) set_word_bus(region, 1);
+        set_hword_bus(0x2, 3, 3);
+        set_hword_bus(0x5, 1, 1);
+        set_hword_bus(0x6, 1, 1);
+
+        struct window { u32 region; u32 first_shift; u32 second_shift; u32 second_slow; };
+        for (auto const [region, first_shift, second_shift, second_slow] : {
+            window{0x8, 2, 4, 2},
+            window{0xa, 5, 7, 4},
+            window{0xc, 8, 10, 8},
+        }) {
+            auto const n = 1 + first_access[field(first_shift, 2)];
+            auto const s = 1 + (field(second_shift, 1) != 0 ? 1 : second_slow);
+            set_hword_bus(region, n, s);
+            set_hword_bus(region + 1, n, s);
+        }
+        // sram only has an 8 bit bus, wider accesses still take a single access worth of time
+        auto const sram = 1 + first_access[field(0, 2)];
+        set_word_bus(0xe, sram);
+        set_word_bus(0xf, sram);
+    }
+
+    std::array<u8, 16 * 8> m_cycles{};
+    u16 m_waitcnt{0};
+};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef FGBA_ZEROED_PAGES_HPP_QPWOEIRUTY
+#define FGBA_ZEROED_PAGES_HPP_QPWOEIRUTY
+
+#include <cstddef>
+#include <cstdlib>
+
+#include "fmt/format.h"
+#include "utility/fatexception.hpp"
+
+#if __has_include(<sys/mman.h>)
+#   include <sys/mman.h>
+#   define FGBA_HAS_ANONYMOUS_MMAP 1
+#else
+#   define FGBA_HAS_ANONYMOUS_MMAP 0
+#endif
+
+namespace fgba::mmu::detail {
+
+// Fresh anonymous pages. They read as zero and are backed by the shared zero page until
+// something is written to them, so memory which the game never touches costs nothing.
+// Where there is no mmap, calloc is the next best thing, big blocks usually end up mmapped anyway.
+[[nodiscard]]inline auto allocate_zeroed(std::size_t const size)
+    -> std::byte* {
+#if FGBA_HAS_ANONYMOUS_MMAP
+    auto* const pages = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) {
+        throw runtime_error{fmt::format("couldn't reserve {} bytes of emulated memory", size)};
+    }
+#else
+    auto* const pages = std::calloc(size, 1);
+    if (pages == nullptr) {
+        throw runtime_error{fmt::format("couldn't reserve {} bytes of emulated memory", size)};
+    }
+#endif
+    return static_cast<std::byte*>(pages);
+}
+// Address space only, nothing can be read or written until it is committed. Without mmap
+// it is all committed (and zeroed) from the start and there is nothing to guard with.
+[[nodiscard]]inline auto reserve_pages(std::size_t const size)
+    -> std::byte* {
+#if FGBA_HAS_ANONYMOUS_MMAP
+    auto* const pages = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (pages == MAP_FAILED) {
+        throw runtime_error{fmt::format("couldn't reserve {} bytes of address space", size)};
+    }
+    return static_cast<std::byte*>(pages);
+#else
+    return allocate_zeroed(size);
+#endif
+}
+// makes reserved pages usable, they still read as zero and take no memory until written
+inline auto commit_pages([[maybe_unused]]std::byte* const pages, [[maybe_unused]]std::size_t const size)
+    -> void {
+#if FGBA_HAS_ANONYMOUS_MMAP
+    if (::mprotect(pages, size, PROT_READ | PROT_WRITE) != 0) {
+        throw runtime_error{fmt::format("couldn't commit {} bytes of emulated memory", size)};
+    }
+#endif
+}
+inline auto deallocate_zeroed(std::byte* const pages, [[maybe_unused]]std::size_t const size) noexcept
+    -> void {
+#if FGBA_HAS_ANONYMOUS_MMAP
+    ::munmap(pages, size);
+#else
+    std::free(pages); //NOLINT
+#endif
+}
+
+}
+
+#endif
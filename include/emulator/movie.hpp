@@ -0,0 +1,51 @@
+#ifndef FGBA_MOVIE_HPP_POIUYTLKJH
+#define FGBA_MOVIE_HPP_POIUYTLKJH
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+#include "emulator/gbaemu.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba {
+// Everything needed to play a session back exactly: the state it started from and the keys held
+// on every frame after that. A frame is one run_frame(), keys are set right before it.
+// Bios and cartridge are not in it, only their hashes, they have to be the same ones on playback.
+struct movie {
+    // "FGBAMOVI"
+    static constexpr u64 magic   = 0x4956'4f4d'4142'4746;
+    static constexpr u32 version = 2;
+
+    // hash of nothing when it was recorded without a bios
+    u64 bios_hash{};
+    u64 cartridge_hash{};
+    // compressed save state, so the movie doesn't depend on whatever ran before it
+    std::vector<std::byte> start_state;
+    // checksum of the machine right after start_state is loaded. bios and cartridge are checked
+    // on their own, this catches a build which runs the same state differently
+    u64 start_checksum{};
+    std::vector<u16> keys;
+};
+
+// throws if the file can't be written
+auto write_movie(std::filesystem::path const& path, movie const& movie)
+    -> void;
+// throws if it can't be read or is not a movie of this version
+[[nodiscard]]auto read_movie(std::filesystem::path const& path)
+    -> movie;
+
+// machine is about to start recording from where it is now
+[[nodiscard]]auto start_movie(gameboy_advance const& gba)
+    -> movie;
+// puts the machine where the movie starts, throws if it was recorded with another bios or
+// cartridge, or if the state it starts from doesn't come out the same here
+auto start_replay(gameboy_advance& gba, movie const& movie)
+    -> void;
+// hash of the whole machine state, two runs which agree on it every frame did the same thing.
+// scratch is for the state, reusing it keeps this from allocating
+[[nodiscard]]auto state_checksum(gameboy_advance const& gba, std::vector<std::byte>& scratch)
+    -> u64;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef FGBA_COLOR_CONVERSION_HPP_ZMXNCBVKSL
+#define FGBA_COLOR_CONVERSION_HPP_ZMXNCBVKSL
+
+#include <cstddef>
+#include <span>
+
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::ppu {
+
+enum class conversion_kernel {
+    scalar,
+    sse2,
+    avx2,
+
+    count,
+};
+
+// fastest kernel this machine can run, picked once on the first call
+[[nodiscard]]auto best_conversion_kernel() noexcept
+    -> conversion_kernel;
+[[nodiscard]]auto is_supported(conversion_kernel) noexcept
+    -> bool;
+
+// bgr555 colors the way they sit in vram and palette, two bytes each, turned into pixels of the given format.
+// destination has to fit source.size() / 2 * bytes_per_pixel(format) bytes
+auto convert_bgr555(pixel_format, std::span<std::byte const> source, std::byte* destination) noexcept
+    -> void;
+// same, but with a specific kernel, it has to be supported
+auto convert_bgr555(conversion_kernel, pixel_format, std::span<std::byte const> source, std::byte* destination) noexcept
+    -> void;
+
+namespace detail {
+using conversion_ptr = auto (*)(std::byte const*, std::size_t, std::byte*) noexcept -> void;
+// avx2 kernels live in their own translation unit which is the only one built with avx2 enabled
+[[nodiscard]]auto avx2_conversion(pixel_format) noexcept
+    -> conversion_ptr;
+} // namespace detail
+
+} // namespace fgba::ppu
+
+#endif
@@ -3,14 +3,17 @@
 
 #include <bit>
 #include <cstddef>
+#include <memory>
 #include <span>
 #include <mdspan>
-#include <sys/_types/_uintptr_t.h>
 
 #include "emulator/cpudefines.hpp"
+#include "emulator/save-state.hpp"
+#include "emulator/scheduler.hpp"
 #include "emulator/ppu/registers.hpp"
 #include "spdlog/spdlog.h"
 #include "emulator/mmu/memoryprimitives.hpp"
+#include "emulator/mmu/memory-arena.hpp"
 namespace fgba::mmu {
 class io_registers_map;
 }
@@ -18,32 +21,142 @@ namespace fgba::ppu {
 using pram_spec     = mem_spec<bounds<0x05000000, 0x05000400>, mem_type::ram, bus_size::hword>;
 using vram_spec     = mem_spec<bounds<0x06000000, 0x06018000>, mem_type::ram, bus_size::hword>;
 using oam_spec      = mem_spec<bounds<0x07000000, 0x07000400>, mem_type::ram, bus_size::hword>;
+
+inline constexpr u32 screen_width     = 240;
+inline constexpr u32 screen_height    = 160;
+// everything is in cpu cycles, a dot takes 4 of them
+inline constexpr u32 hdraw_cycles     = 960;
+inline constexpr u32 hblank_cycles    = 272;
+inline constexpr u32 cycles_per_line  = hdraw_cycles + hblank_cycles;
+inline constexpr u32 lines_per_frame  = 228;
+inline constexpr u64 cycles_per_frame = u64{cycles_per_line} * lines_per_frame;
+
 class ppu {
     friend class mmu::io_registers_map;
 public:
-    ppu();
+    // beam is driven by scheduler events from here on, vram, palette and oam are claimed from the arena
+    ppu(scheduler& scheduler, mmu::memory_arena& arena);
+    // scheduler holds on to this
+    ppu(ppu&&) = delete;
+    auto operator=(ppu&&)
+        -> ppu& = delete;
+    // what is being drawn right now, lines of the current frame may already be there
     [[nodiscard]]auto get_display_view() const noexcept
         -> lcd_display_view;
+    // finished frames, published as the beam enters vblank
+    [[nodiscard]]auto get_frames() noexcept
+        -> lcd_frame_mailbox& { return *m_frames; }
     auto get_vram()
-        -> mmu::mem_owner<vram_spec>& { return m_vram; }
+        -> mmu::mem_view<vram_spec> { return m_vram; }
     auto get_pram()
-        -> mmu::mem_owner<pram_spec>& { return m_pram; }
+        -> mmu::mem_view<pram_spec> { return m_pram; }
     auto get_oam()
-        -> mmu::mem_owner<oam_spec>& { return m_oam; }
+        -> mmu::mem_view<oam_spec> { return m_oam; }
+    // mmu reports every store into vram and palette, so lines which didn't change can be skipped
+    auto note_write(u32 address) noexcept
+        -> void {
+        if (address >> 24 == vram_region) {
+            auto offset = address & 0x1'ffff;
+            // upper 32KiB of a mirror are the object tiles again
+            if (offset >= vram_spec::bounds::size) offset -= 0x8000;
+            m_vram_stamps[offset / vram_block_size] = m_line_clock;
+        } else {
+            m_pram_stamp = m_line_clock;
+        }
+    }
+    // memory a state load put back without going through the bus, counts as written all over
+    auto note_rewrite(u32 const address, u32 const size) noexcept
+        -> void {
+        if (address >> 24 != vram_region and address >> 24 != pram_region) return;
+        for (u32 offset = 0; offset < size; offset += vram_block_size) {
+            note_write(address + offset);
+        }
+    }
+    // where object tiles start in vram, bitmap modes take some of their space for the background
+    [[nodiscard]]auto obj_tiles_offset() const noexcept
+        -> u32 { return m_dispcnt.bg_mode >= 3 ? 0x1'4000 : 0x1'0000; }
+    // registers only, memory is saved with the rest of the arena and the picture is redrawn from it
+    auto save_state(state_writer& state) const
+        -> void;
+    auto load_state(state_reader& state)
+        -> void;
+    [[nodiscard]]auto current_scanline() const noexcept
+        -> u32 { return m_vcount.current_scanline; }
+    // frames keep being drawn but nobody gets them, for frames which are going to be thrown away
+    auto set_frame_publishing(bool enabled) noexcept
+        -> void { m_publishing = enabled; }
+    // every line is redrawn in the new format on the next frame
+    auto set_pixel_format(pixel_format format) noexcept
+        -> void;
+    [[nodiscard]]auto get_pixel_format() const noexcept
+        -> pixel_format { return m_format; }
 private:
-    auto mode3() noexcept
+    static constexpr u32 pram_region     = 0x5;
+    static constexpr u32 vram_region     = 0x6;
+    static constexpr u32 vram_block_size = 0x100;
+
+    // what has to stay the same for the line to look the same
+    struct line_inputs {
+        u32 vram_begin;
+        u32 vram_end;
+        u16 control;
+        bool uses_palette;
+    };
+    struct line_state {
+        // line clock when it was last drawn, 0 means never
+        u64 drawn_at;
+        u16 control;
+    };
+
+    // lines are drawn as they enter hblank
+    static auto on_hblank(void* self, u64 deadline) noexcept
+        -> void;
+    static auto on_line_end(void* self, u64 deadline) noexcept
+        -> void;
+    auto enter_hblank() noexcept
         -> void;
+    auto next_line() noexcept
+        -> void;
+    auto publish_frame() noexcept
+        -> void;
+    [[nodiscard]]auto inputs_of(u32 line) const noexcept
+        -> line_inputs;
+    [[nodiscard]]auto is_dirty(u32 line, line_inputs const& inputs) const noexcept
+        -> bool;
+    auto render_line(u32 line) noexcept
+        -> void;
+    auto draw_bitmap(u32 line, u32 vram_offset, u32 width) noexcept
+        -> void;
+    auto draw_paletted(u32 line, u32 vram_offset) noexcept
+        -> void;
+    auto fill(u32 line, u32 from, u16 color) noexcept
+        -> void;
+    [[nodiscard]]auto line_pixels(u32 line) noexcept
+        -> std::byte* {
+        return m_display.data() + line * screen_width * bytes_per_pixel(m_format);
+    }
 private:
-    mmu::mem_owner<vram_spec> m_vram;
-    mmu::mem_owner<pram_spec> m_pram;
-    mmu::mem_owner<oam_spec> m_oam;
-    std::array<std::byte, 240 * 160 * 3> m_display;
+    scheduler* m_scheduler;
+    mmu::mem_view<vram_spec> m_vram;
+    mmu::mem_view<pram_spec> m_pram;
+    mmu::mem_view<oam_spec> m_oam;
+    // big enough for the widest format
+    alignas(32) std::array<std::byte, lcd_width * lcd_height * 4> m_display{};
+    // what most desktop drivers take without swizzling anything
+    pixel_format m_format{pixel_format::bgra8888};
     dispcnt m_dispcnt;
     dispstat m_dispstat;
     vcount m_vcount;
+    // counts scanlines since power on, it is what write stamps are made of
+    u64 m_line_clock{1};
+    std::array<u64, vram_spec::bounds::size / vram_block_size> m_vram_stamps{};
+    u64 m_pram_stamp{0};
+    std::array<line_state, screen_height> m_lines{};
+    // three frames are too much to keep inline
+    std::unique_ptr<lcd_frame_mailbox> m_frames{std::make_unique<lcd_frame_mailbox>()};
+    u64 m_frame_count{0};
+    bool m_publishing{true};
 };
 }
 
 #endif
-
-
@@ -0,0 +1,155 @@
+#ifndef FGBA_REWIND_BUFFER_HPP_GHJKTYUIBN
+#define FGBA_REWIND_BUFFER_HPP_GHJKTYUIBN
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "fgba-defines.hpp"
+#include "utility/zero-runs.hpp"
+
+namespace fgba {
+struct rewind_config {
+    // for deltas, the newest snapshot and scratch space come on top. 0 turns rewinding off
+    std::size_t memory_budget{32 * 1024 * 1024};
+    // frames between snapshots
+    u32 interval{2};
+};
+
+// History of save states for stepping back in time.
+//
+// Only the newest snapshot is kept whole, everything before it is a delta: the xor of two neighbouring
+// snapshots run through the zero run codec. Between two snapshots a game touches a few KiB of memory,
+// so a delta is about that big and most of the budget goes to history rather than copies of unchanged vram.
+// Deltas live back to back in one fixed block, oldest ones are overwritten when it runs out.
+// Once it is warmed up nothing allocates, taking a snapshot is a xor and an encode over the state.
+//
+// Snapshots have to be uncompressed states, so they are all the same size and line up byte for byte.
+class rewind_buffer {
+public:
+    explicit rewind_buffer(rewind_config const& config = {})
+        : m_config{config},
+          m_ring(config.memory_budget),
+          // anything smaller than that is an unusually quiet frame, running out of these first is fine
+          m_entries(std::max<std::size_t>(config.memory_budget / 1024, 16)) {}
+
+    [[nodiscard]]auto get_config() const noexcept
+        -> rewind_config const& { return m_config; }
+    // called once a frame, true when it is time for a snapshot
+    [[nodiscard]]auto frame_finished() noexcept
+        -> bool {
+        if (++m_frames_since_snapshot < m_config.interval) return false;
+        m_frames_since_snapshot = 0;
+        return true;
+    }
+    auto push(std::span<std::byte const> const state)
+        -> void {
+        if (m_current.size() != state.size()) {
+            // first one, or states changed shape and the old history means nothing
+            clear();
+            m_current.assign(state.begin(), state.end());
+            m_scratch.resize(state.size());
+            return;
+        }
+        for (std::size_t i = 0; i < state.size(); ++i) {
+            m_scratch[i] = m_current[i] ^ state[i];
+        }
+        m_encoded.clear();
+        zero_runs_encode(m_scratch, m_encoded);
+        store(m_encoded);
+        std::ranges::copy(state, m_current.begin());
+    }
+    // goes one snapshot back and returns it, nothing if there is no history left.
+    // it is good until the next push or step_back
+    [[nodiscard]]auto step_back()
+        -> std::optional<std::span<std::byte const>> {
+        if (m_count == 0) return std::nullopt;
+        auto const newest = m_entries[index_of(m_count - 1)];
+        if (not zero_runs_decode(std::span{m_ring}.subspan(newest.offset, newest.size), m_scratch)) {
+            // can't happen unless memory got trampled, history is useless from here
+            clear();
+            return std::nullopt;
+        }
+        for (std::size_t i = 0; i < m_current.size(); ++i) {
+            m_current[i] ^= m_scratch[i];
+        }
+        --m_count;
+        m_write = m_count == 0 ? 0 : newest.offset;
+        m_frames_since_snapshot = 0;
+        return std::span<std::byte const>{m_current};
+    }
+    auto clear() noexcept
+        -> void {
+        m_current.clear();
+        m_first = 0;
+        m_count = 0;
+        m_write = 0;
+        m_frames_since_snapshot = 0;
+    }
+    // how many times step_back can succeed
+    [[nodiscard]]auto depth() const noexcept
+        -> std::size_t { return m_count; }
+    [[nodiscard]]auto bytes_used() const noexcept
+        -> std::size_t {
+        auto used = std::size_t{0};
+        for (std::size_t i = 0; i < m_count; ++i) used += m_entries[index_of(i)].size;
+        return used;
+    }
+private:
+    struct entry {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    [[nodiscard]]auto index_of(std::size_t const nth) const noexcept
+        -> std::size_t { return (m_first + nth) % m_entries.size(); }
+    auto drop_oldest() noexcept
+        -> void {
+        m_first = index_of(1);
+        --m_count;
+    }
+    auto store(std::span<std::byte const> const delta)
+        -> void {
+        // doesn't fit even alone, history starts over from this snapshot
+        if (delta.size() > m_ring.size() / 2) {
+            m_first = 0;
+            m_count = 0;
+            m_write = 0;
+            return;
+        }
+        if (m_count == m_entries.size()) drop_oldest();
+        auto offset = m_write;
+        if (offset + delta.size() > m_ring.size()) {
+            // whatever sits past the write position is older than anything in front of it
+            while (m_count != 0 and m_entries[m_first].offset >= m_write) drop_oldest();
+            offset = 0;
+        }
+        // oldest deltas are always right ahead of the write position
+        while (m_count != 0) {
+            auto const& oldest = m_entries[m_first];
+            if (oldest.offset >= offset + delta.size() or offset >= oldest.offset + oldest.size) break;
+            drop_oldest();
+        }
+        std::ranges::copy(delta, m_ring.begin() + static_cast<std::ptrdiff_t>(offset));
+        m_entries[index_of(m_count)] = {.offset = offset, .size = delta.size()};
+        ++m_count;
+        m_write = offset + delta.size();
+    }
+
+    rewind_config m_config;
+    std::vector<std::byte> m_ring;
+    std::vector<entry> m_entries;
+    std::size_t m_first{0};
+    std::size_t m_count{0};
+    std::size_t m_write{0};
+    std::vector<std::byte> m_current;
+    std::vector<std::byte> m_scratch;
+    std::vector<std::byte> m_encoded;
+    u32 m_frames_since_snapshot{0};
+};
+
+}
+
+#endif
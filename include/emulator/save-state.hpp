@@ -0,0 +1,148 @@
+#ifndef FGBA_SAVE_STATE_HPP_MNBVCXZLKJ
+#define FGBA_SAVE_STATE_HPP_MNBVCXZLKJ
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "fmt/format.h"
+#include "fgba-defines.hpp"
+#include "utility/fatexception.hpp"
+#include "utility/zero-runs.hpp"
+
+namespace fgba {
+// Save states are a fixed header followed by tagged sections, each part of the machine writes its own.
+// Small things are written as they sit in memory, guest memory goes in as whole blocks.
+// States only load into the same version of the emulator on the same kind of host, they are not an exchange format.
+
+// bumped whenever anything about the layout changes, older states are refused instead of misread
+inline constexpr u32 save_state_version = 5;
+// "FGBASTAT"
+inline constexpr u64 save_state_magic   = 0x5441'5453'4142'4746;
+
+enum class save_compression : u8 {
+    none,
+    // memory blocks go through the zero run codec, states shrink to whatever the game actually uses
+    zero_runs,
+
+    count,
+};
+// tag in front of every section, loading something which got out of step fails right there
+enum class state_section : u32 {
+    scheduler = 0x5348'4353, // "SCHS"
+    cpu       = 0x5355'5043, // "CPUS"
+    ppu       = 0x5355'5050, // "PPUS"
+    mmu       = 0x5355'4d4d, // "MMUS"
+    memory    = 0x534d'454d, // "MEMS"
+};
+
+class state_writer {
+public:
+    // buffer is cleared but keeps its capacity, so saving into the same one over and over doesn't allocate
+    explicit state_writer(std::vector<std::byte>& buffer, save_compression const compression = save_compression::none)
+        : m_buffer{&buffer}, m_compression{compression} {
+        m_buffer->clear();
+        write(save_state_magic);
+        write(save_state_version);
+        write(compression);
+    }
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    auto write(T const& value)
+        -> void {
+        auto const* const bytes = reinterpret_cast<std::byte const*>(&value); //NOLINT
+        m_buffer->insert(m_buffer->end(), bytes, bytes + sizeof(T));
+    }
+    auto section(state_section const section)
+        -> void { write(section); }
+    auto write_block(std::span<std::byte const> const block)
+        -> void {
+        write(u64{block.size()});
+        if (m_compression == save_compression::none) {
+            m_buffer->insert(m_buffer->end(), block.begin(), block.end());
+            return;
+        }
+        // encoded size goes in front, it is only known afterwards
+        auto const size_at = m_buffer->size();
+        write(u64{0});
+        zero_runs_encode(block, *m_buffer);
+        auto const encoded = u64{m_buffer->size() - size_at - sizeof(u64)};
+        std::memcpy(m_buffer->data() + size_at, &encoded, sizeof(encoded));
+    }
+private:
+    std::vector<std::byte>* m_buffer;
+    save_compression m_compression;
+};
+
+class state_reader {
+public:
+    // throws if it is not a state or a state of some other version
+    explicit state_reader(std::span<std::byte const> const state)
+        : m_state{state} {
+        if (read<u64>() != save_state_magic) {
+            throw runtime_error{"not a save state"};
+        }
+        if (auto const version = read<u32>(); version != save_state_version) {
+            throw runtime_error{fmt::format("save state is version {}, only {} can be loaded", version, save_state_version)};
+        }
+        m_compression = read<save_compression>();
+        if (m_compression >= save_compression::count) {
+            throw runtime_error{"save state is compressed in some unknown way"};
+        }
+    }
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    [[nodiscard]]auto read()
+        -> T {
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    auto read_into(T& value)
+        -> void { value = read<T>(); }
+    auto expect(state_section const section)
+        -> void {
+        if (read<state_section>() != section) {
+            throw runtime_error{"save state is damaged, a section is not where it should be"};
+        }
+    }
+    // block has to be exactly as big as destination
+    auto read_block(std::span<std::byte> const destination)
+        -> void {
+        if (read<u64>() != destination.size()) {
+            throw runtime_error{"save state is damaged, memory block doesn't match"};
+        }
+        if (m_compression == save_compression::none) {
+            std::memcpy(destination.data(), take(destination.size()).data(), destination.size());
+            return;
+        }
+        auto const encoded = take(read<u64>());
+        if (not zero_runs_decode(encoded, destination)) {
+            throw runtime_error{"save state is damaged, memory block doesn't decode"};
+        }
+    }
+    [[nodiscard]]auto at_end() const noexcept
+        -> bool { return m_offset == m_state.size(); }
+private:
+    auto take(std::size_t const size)
+        -> std::span<std::byte const> {
+        if (size > m_state.size() - m_offset) {
+            throw runtime_error{"save state ends too early"};
+        }
+        auto const bytes = m_state.subspan(m_offset, size);
+        m_offset += size;
+        return bytes;
+    }
+
+    std::span<std::byte const> m_state;
+    std::size_t m_offset{0};
+    save_compression m_compression{};
+};
+
+}
+
+#endif
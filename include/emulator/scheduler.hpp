@@ -0,0 +1,124 @@
+#ifndef FGBA_SCHEDULER_HPP_LAKSJDHFGZ
+#define FGBA_SCHEDULER_HPP_LAKSJDHFGZ
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "emulator/save-state.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba {
+
+// everything that happens at a known point of emulated time.
+// timers, dma and irq delivery get their own once they exist
+enum class event_type : u8 {
+    ppu_hblank,
+    ppu_line_end,
+
+    count,
+};
+
+// keeps emulated time and fires events once it reaches them.
+// cpu runs in bulk and reports how many cycles passed, so the only per block cost is one comparison
+class scheduler {
+public:
+    // called with the cycle the event was due at, which may be a bit in the past.
+    // follow ups should be scheduled from it and not from now() to not drift
+    using event_callback = auto (*)(void* context, u64 deadline) -> void;
+    static constexpr u64 never = std::numeric_limits<u64>::max();
+
+    scheduler() {
+        m_deadlines.fill(never);
+        m_queue.reserve(std::to_underlying(event_type::count) * 4);
+    }
+
+    auto set_handler(event_type const type, event_callback const callback, void* const context) noexcept
+        -> void {
+        m_handlers[std::to_underlying(type)] = {callback, context};
+    }
+    [[nodiscard]]auto now() const noexcept
+        -> u64 { return m_now; }
+    [[nodiscard]]auto next_deadline() const noexcept
+        -> u64 { return m_next; }
+    [[nodiscard]]auto is_scheduled(event_type const type) const noexcept
+        -> bool { return m_deadlines[std::to_underlying(type)] != never; }
+    // there is at most one pending event of each type, scheduling again moves it
+    auto schedule_at(event_type const type, u64 const deadline)
+        -> void {
+        m_deadlines[std::to_underlying(type)] = deadline;
+        m_queue.push_back({deadline, type});
+        std::ranges::push_heap(m_queue, std::greater{});
+        m_next = std::min(m_next, deadline);
+    }
+    auto schedule_in(event_type const type, u64 const cycles)
+        -> void { schedule_at(type, m_now + cycles); }
+    // heap entry stays behind and is dropped once it comes up
+    auto cancel(event_type const type) noexcept
+        -> void { m_deadlines[std::to_underlying(type)] = never; }
+
+    // handlers are not part of the state, they stay with whoever set them
+    auto save_state(state_writer& state) const
+        -> void {
+        state.section(state_section::scheduler);
+        state.write(m_now);
+        state.write(m_deadlines);
+    }
+    auto load_state(state_reader& state)
+        -> void {
+        state.expect(state_section::scheduler);
+        state.read_into(m_now);
+        state.read_into(m_deadlines);
+        m_queue.clear();
+        m_next = never;
+        for (std::size_t i = 0; i < m_deadlines.size(); ++i) {
+            if (m_deadlines[i] != never) schedule_at(static_cast<event_type>(i), m_deadlines[i]);
+        }
+    }
+
+    // moves time forward, whatever is due by then fires in deadline order
+    FGBA_FORCE_INLINE auto advance(u64 const cycles)
+        -> void {
+        m_now += cycles;
+        if (m_now >= m_next) [[unlikely]] dispatch();
+    }
+private:
+    struct event {
+        u64 deadline;
+        event_type type;
+        friend auto operator<=>(event const&, event const&) = default;
+    };
+    struct handler {
+        event_callback callback;
+        void* context;
+    };
+
+    auto dispatch()
+        -> void {
+        while (not m_queue.empty() and m_queue.front().deadline <= m_now) {
+            std::ranges::pop_heap(m_queue, std::greater{});
+            auto const [deadline, type] = m_queue.back();
+            m_queue.pop_back();
+            auto const index = std::to_underlying(type);
+            // cancelled or moved since it was pushed
+            if (m_deadlines[index] != deadline) continue;
+            m_deadlines[index] = never;
+            m_handlers[index].callback(m_handlers[index].context, deadline);
+        }
+        m_next = m_queue.empty() ? never : m_queue.front().deadline;
+    }
+
+    u64 m_now{0};
+    u64 m_next{never};
+    std::vector<event> m_queue;
+    std::array<u64, std::to_underlying(event_type::count)> m_deadlines{};
+    std::array<handler, std::to_underlying(event_type::count)> m_handlers{};
+};
+
+}
+
+#endif
@@ -46,4 +46,14 @@ consteval auto operator""_i8(unsigned long long i)
 
 #endif // DEBUG
 
+// call in return position which has to become a jump, so threaded handlers don't pile up on the stack
+#if defined(__clang__)
+    #define FGBA_MUSTTAIL [[clang::musttail]]
+#elif defined(__GNUC__) && __GNUC__ >= 15
+    #define FGBA_MUSTTAIL [[gnu::musttail]]
+#else
+    // at worst a block's worth of frames, optimizers turn it into a jump anyway
+    #define FGBA_MUSTTAIL
+#endif
+
 #endif
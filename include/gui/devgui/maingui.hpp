@@ -1,7 +1,7 @@
 #ifndef MAIN_GUI_HPP_DNJCEIJNA
 #define MAIN_GUI_HPP_DNJCEIJNA
 
-#include "emulator/gbaemu.hpp"
+#include "emulator/emulation-thread.hpp"
 #include "gui/display.hpp"
 #include "GLFW/glfw3.h"
 #include "emulator/cpu/registermanager.hpp"
@@ -22,9 +22,10 @@ private:
 auto setup_opengl_context() -> std::expected<window_ptr, std::string>; 
 auto setup_imgui(GLFWwindow* ctx) -> void;
 
-auto draw_main_gui(gameboy_advance& gba, display const& disp) -> void;
+auto draw_main_gui(emulation_thread& emu, display& disp) -> void;
+auto draw_emulation_menu(emulation_thread& emu) -> void;
 auto draw_cpu_registers_dump(cpu::register_manager const& rm) -> void;
-auto draw_emu_display(display const&) -> void;
+auto draw_emu_display(display&) -> void;
 }
 
 #endif
\ No newline at end of file
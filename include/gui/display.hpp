@@ -1,7 +1,8 @@
 #ifndef DISPLAY_HPP_SWNKAJQLJQNDKC
 #define DISPLAY_HPP_SWNKAJQLJQNDKC
 
-// #include <mdspan>
+#include <array>
+#include <cstddef>
 #include "emulator/cpudefines.hpp"
 #include "glad/gl.h"
 
@@ -9,7 +10,7 @@ namespace fgba::gui {
 
 class display {
 public:
-    display(lcd_display_view) noexcept;
+    display(lcd_frame_mailbox&) noexcept;
     display(display const&) = delete;
     display(display&&) noexcept;
     auto operator=(display const&) 
@@ -18,13 +19,33 @@ public:
         -> display&;
     ~display();
 
-    auto update() const noexcept 
+    // uploads the newest finished frame if there is one, never waits for the gpu or the emulator
+    auto update() noexcept 
         -> void;
     [[nodiscard]]auto get_handle() const noexcept 
         -> GLuint;
 private:
-    lcd_display_view m_view;
+    // how a pixel format is described to gl
+    struct gl_format {
+        GLint internal_format;
+        GLenum format;
+        GLenum type;
+        GLint unpack_alignment;
+    };
+    [[nodiscard]]static auto gl_format_of(pixel_format) noexcept
+        -> gl_format;
+    auto allocate_texture(pixel_format) noexcept
+        -> void;
+
+    // one is filled while the gpu may still be reading the other
+    static constexpr std::size_t upload_buffer_count = 2;
+
+    lcd_frame_mailbox* m_frames;
+    pixel_format m_pixel_format;
+    gl_format m_format;
     GLuint m_texture_id;
+    std::array<GLuint, upload_buffer_count> m_upload_buffers{};
+    std::size_t m_next_upload_buffer{0};
 };
 
 }
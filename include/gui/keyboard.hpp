@@ -0,0 +1,14 @@
+#ifndef FGBA_KEYBOARD_HPP_QWEZXCASDR
+#define FGBA_KEYBOARD_HPP_QWEZXCASDR
+
+#include "GLFW/glfw3.h"
+#include "fgba-defines.hpp"
+
+namespace fgba::gui {
+// keys held down right now as a mask of fgba::key.
+// x and z are a and b, a and s are the shoulders, enter and backspace are start and select
+[[nodiscard]]auto read_keypad(GLFWwindow* window) noexcept
+    -> u16;
+}
+
+#endif
@@ -75,17 +75,17 @@ struct basic_bitset {
     [[nodiscard]]constexpr auto operator[](unsigned bit_chunk_end, unsigned bit_chunk_begin) const & noexcept
         -> basic_bitset {
         auto mask = create_mask(bit_chunk_end, bit_chunk_begin);
-        return {(value & mask) >> bit_chunk_begin};
+        return {static_cast<BaseInt>((value & mask) >> bit_chunk_begin)};
     }
     [[nodiscard]]constexpr auto operator[](unsigned bit_chunk_end, unsigned bit_chunk_begin) && noexcept
         -> basic_bitset {
         auto mask = create_mask(bit_chunk_end, bit_chunk_begin);
-        return {(value & mask) >> bit_chunk_begin};
+        return {static_cast<BaseInt>((value & mask) >> bit_chunk_begin)};
     }
     [[nodiscard]]constexpr auto operator[](unsigned bit_chunk_end, unsigned bit_chunk_begin) const && noexcept
         -> basic_bitset {
         auto mask = create_mask(bit_chunk_end, bit_chunk_begin);
-        return {(value & mask) >> bit_chunk_begin};
+        return {static_cast<BaseInt>((value & mask) >> bit_chunk_begin)};
     }
     [[nodiscard]]constexpr auto lsl(unsigned amount) const noexcept
         -> basic_bitset { return {value << amount}; }
@@ -203,7 +203,11 @@ struct basic_bitset {
     
     
     [[nodiscard]]static constexpr auto create_mask(unsigned end_bit, unsigned begin_bit)
-        -> BaseInt { return (~static_cast<BaseInt>(0) >> (sizeof(BaseInt) * CHAR_BIT - (end_bit - begin_bit) - 1)) << begin_bit; }
+        -> BaseInt { 
+        // casts are there because narrower ints get promoted and the mask would come out all ones
+        auto const all_ones = static_cast<BaseInt>(~static_cast<BaseInt>(0));
+        return static_cast<BaseInt>(static_cast<BaseInt>(all_ones >> (sizeof(BaseInt) * CHAR_BIT - (end_bit - begin_bit) - 1)) << begin_bit); 
+    }
     BaseInt value;
 };
 
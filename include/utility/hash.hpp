@@ -0,0 +1,39 @@
+#ifndef FGBA_HASH_HPP_ASDFQWERZX
+#define FGBA_HASH_HPP_ASDFQWERZX
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "fgba-defines.hpp"
+
+namespace fgba {
+// Quick 64 bit hash for telling two blobs apart, save states mostly. Takes 8 bytes at a time,
+// so hashing a whole state is about as fast as copying it. Not meant to stand up to anyone trying to collide it.
+[[nodiscard]]inline auto hash_bytes(std::span<std::byte const> const bytes, u64 seed = 0) noexcept
+    -> u64 {
+    constexpr u64 multiplier = 0x9e37'79b9'7f4a'7c15;
+    auto const mix = [](u64 hash, u64 const value) {
+        hash ^= value * multiplier;
+        return std::rotl(hash, 29) * 0xbf58'476d'1ce4'e5b9;
+    };
+    auto hash = seed ^ (bytes.size() * multiplier);
+    auto offset = std::size_t{0};
+    for (u64 chunk = 0; offset + 8 <= bytes.size(); offset += 8) {
+        std::memcpy(&chunk, bytes.data() + offset, 8);
+        hash = mix(hash, chunk);
+    }
+    if (offset != bytes.size()) {
+        auto tail = u64{0};
+        std::memcpy(&tail, bytes.data() + offset, bytes.size() - offset);
+        hash = mix(hash, tail);
+    }
+    // last few chunks should still reach every bit
+    hash ^= hash >> 31;
+    hash *= 0x94d0'49bb'1331'11eb;
+    return hash ^ (hash >> 29);
+}
+}
+
+#endif
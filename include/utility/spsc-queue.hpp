@@ -0,0 +1,52 @@
+#ifndef FGBA_SPSC_QUEUE_HPP_MZNXBCVLAK
+#define FGBA_SPSC_QUEUE_HPP_MZNXBCVLAK
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+
+namespace fgba {
+// bounded queue for exactly one pushing and one popping thread, neither of them ever blocks
+template<typename T, std::size_t Capacity>
+    requires (std::has_single_bit(Capacity))
+class spsc_queue {
+public:
+    // producer side, false if the queue is full
+    [[nodiscard]]auto try_push(T const& value) noexcept
+        -> bool {
+        auto const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cache == Capacity) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cache == Capacity) return false;
+        }
+        m_slots[tail & index_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    // consumer side
+    [[nodiscard]]auto try_pop() noexcept
+        -> std::optional<T> {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail_cache) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tail_cache) return std::nullopt;
+        }
+        auto value = std::optional<T>{m_slots[head & index_mask]};
+        m_head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+private:
+    static constexpr std::size_t index_mask = Capacity - 1;
+
+    std::array<T, Capacity> m_slots{};
+    // indices only grow, each side keeps a stale copy of the other one to not bounce its cache line every time
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    std::size_t m_tail_cache{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_head_cache{0};
+};
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef FGBA_TRIPLE_BUFFER_HPP_QPWOEIRUTY
+#define FGBA_TRIPLE_BUFFER_HPP_QPWOEIRUTY
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace fgba {
+// hands values from one producer thread to one consumer thread without either of them waiting.
+// producer fills back() and publishes it, consumer picks up the newest published one,
+// anything published in between is dropped
+template<typename T>
+class triple_buffer {
+public:
+    // producer side
+    [[nodiscard]]auto back() noexcept
+        -> T& { return m_slots[m_back]; }
+    auto publish() noexcept
+        -> void {
+        auto const previous = m_middle.exchange(static_cast<std::uint8_t>(m_back | fresh_bit), std::memory_order_acq_rel);
+        m_back = previous & index_mask;
+    }
+    // consumer side, returns false if nothing new was published since the last call
+    auto acquire() noexcept
+        -> bool {
+        if ((m_middle.load(std::memory_order_relaxed) & fresh_bit) == 0) return false;
+        auto const previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & index_mask;
+        return true;
+    }
+    [[nodiscard]]auto front() const noexcept
+        -> T const& { return m_slots[m_front]; }
+private:
+    static constexpr std::uint8_t index_mask = 0b011;
+    static constexpr std::uint8_t fresh_bit  = 0b100;
+
+    std::array<T, 3> m_slots{};
+    // each side only ever touches its own index, keep them off each other's cache lines
+    alignas(64) std::uint8_t m_back{0};
+    alignas(64) std::atomic<std::uint8_t> m_middle{1};
+    alignas(64) std::uint8_t m_front{2};
+};
+}
+
+#endif
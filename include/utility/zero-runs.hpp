@@ -0,0 +1,97 @@
+#ifndef FGBA_ZERO_RUNS_HPP_YTREWQPOIU
+#define FGBA_ZERO_RUNS_HPP_YTREWQPOIU
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "fgba-defines.hpp"
+
+namespace fgba {
+// Tiny codec for data which is mostly zeroes: fresh guest memory, unused sram, and xor deltas of two snapshots.
+// Encoded stream is a list of [varint zeroes][varint n][n literal bytes] which covers the input exactly.
+// It is nowhere near lz4 on real data, but it runs at memcpy speed and that is all it needs to be.
+namespace detail {
+// short zero runs inside of literals cost more to split on than to just copy
+inline constexpr std::size_t min_zero_run = 8;
+
+inline auto put_varint(std::vector<std::byte>& destination, std::size_t value)
+    -> void {
+    while (value >= 0x80) {
+        destination.push_back(static_cast<std::byte>(value | 0x80));
+        value >>= 7;
+    }
+    destination.push_back(static_cast<std::byte>(value));
+}
+[[nodiscard]]inline auto get_varint(std::span<std::byte const> const source, std::size_t& offset, std::size_t& value) noexcept
+    -> bool {
+    value = 0;
+    for (u32 shift = 0; shift < 64; shift += 7) {
+        if (offset >= source.size()) return false;
+        auto const byte = std::to_integer<std::size_t>(source[offset++]);
+        value |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+// how many zero bytes there are from offset on, looked at 8 at a time
+[[nodiscard]]inline auto zeroes_from(std::span<std::byte const> const source, std::size_t offset, std::size_t const limit) noexcept
+    -> std::size_t {
+    auto const begin = offset;
+    auto const end   = std::min(source.size(), offset + limit);
+    for (u64 chunk = 0; offset + 8 <= end; offset += 8) {
+        std::memcpy(&chunk, source.data() + offset, 8);
+        if (chunk != 0) break;
+    }
+    while (offset < end and source[offset] == std::byte{0}) ++offset;
+    return offset - begin;
+}
+}
+
+// appends encoded source to whatever is already in destination
+inline auto zero_runs_encode(std::span<std::byte const> const source, std::vector<std::byte>& destination)
+    -> void {
+    auto position = std::size_t{0};
+    while (position < source.size()) {
+        auto const zeroes = detail::zeroes_from(source, position, source.size());
+        position += zeroes;
+        auto const literal_begin = position;
+        while (position < source.size()) {
+            if (source[position] != std::byte{0}) {
+                ++position;
+                continue;
+            }
+            auto const run = detail::zeroes_from(source, position, detail::min_zero_run);
+            if (run >= detail::min_zero_run or position + run == source.size()) break;
+            position += run;
+        }
+        detail::put_varint(destination, zeroes);
+        detail::put_varint(destination, position - literal_begin);
+        destination.insert(destination.end(), source.begin() + literal_begin, source.begin() + position);
+    }
+}
+// false if the stream is broken or doesn't describe exactly destination.size() bytes
+[[nodiscard]]inline auto zero_runs_decode(std::span<std::byte const> const source, std::span<std::byte> const destination) noexcept
+    -> bool {
+    auto offset   = std::size_t{0};
+    auto position = std::size_t{0};
+    while (offset < source.size()) {
+        auto zeroes  = std::size_t{0};
+        auto literal = std::size_t{0};
+        if (not detail::get_varint(source, offset, zeroes) or not detail::get_varint(source, offset, literal)) return false;
+        if (zeroes > destination.size() - position) return false;
+        std::memset(destination.data() + position, 0, zeroes);
+        position += zeroes;
+        if (literal > destination.size() - position or literal > source.size() - offset) return false;
+        std::memcpy(destination.data() + position, source.data() + offset, literal);
+        position += literal;
+        offset   += literal;
+    }
+    return position == destination.size();
+}
+
+}
+
+#endif
@@ -2,27 +2,130 @@
 #include "emulator/cpudefines.hpp"
 #include "emulator/cpu/instruction-impl/implementation.hpp"
 #include "emulator/cpu/opcodes.hpp"
+#include <utility>
 
 
 namespace fgba::cpu {
 
 arm7tdmi::arm7tdmi() {}
 
+auto arm7tdmi::reset(word const entry, mode const mode) -> void {
+    m_registers = register_manager{};
+    for (auto const bank : {mode::svc, mode::irq, mode::fiq, mode::abt, mode::und, mode::sys}) {
+        m_registers.switch_mode(bank);
+        for (u32 i = 0; i < 15; ++i) m_registers[i] = 0_word;
+        if (bank != mode::sys) m_registers.spsr().val = 0;
+    }
+    // arm state with both interrupts masked
+    m_registers.cpsr().val = 0b1100'0000 | static_cast<u32>(mode);
+    m_registers.switch_mode(mode);
+    m_registers.pc() = entry;
+    m_block_cache.clear();
+    m_retired = 0;
+    flush_pipeline();
+    refill_pipeline();
+    increment_program_counter();
+}
+
+auto arm7tdmi::skip_bios() -> void {
+    reset(0x0800'0000_word, mode::sys);
+    for (auto const& [bank, sp] : {
+        std::pair{mode::svc, 0x0300'7fe0_word},
+        std::pair{mode::irq, 0x0300'7fa0_word},
+        std::pair{mode::sys, 0x0300'7f00_word},
+    }) {
+        m_registers.switch_mode(bank);
+        m_registers.sp() = sp;
+    }
+    // bios unmasks interrupts on its way out
+    m_registers.cpsr().val = static_cast<u32>(mode::sys);
+}
+
 auto arm7tdmi::advance_execution() -> void {
-    if (m_registers.cpsr().is_thumb()) {
-        //TODO: implement thumb
+    if (m_registers.is_thumb()) {
+        auto current_instruction = m_prefetch_buffer.read<thumb::instruction>();
+        prefetch();
+        cpu::thumb::execute(*this, current_instruction);
     } else {
         auto current_instruction = m_prefetch_buffer.read<arm::instruction>();
         prefetch();
-        auto decoded = decode(current_instruction);
-        cpu::arm::execute(*this, decoded, current_instruction);
+        // instruction which fails its condition still takes its fetch and nothing else
+        if (is_unconditional(current_instruction) or condition_passed(m_registers.cpsr().val, current_instruction.value >> 28)) {
+            auto decoded = decode(current_instruction);
+            cpu::arm::execute(*this, decoded, current_instruction);
+        }
     }
     increment_program_counter();
+    ++m_retired;
+}
+
+auto arm7tdmi::execute_block() -> u32 {
+    if (m_registers.is_thumb()) {
+        advance_execution();
+        return m_bus.take_cycles();
+    }
+    auto const start = address{m_registers.pc() - 8_word};
+    auto& block = m_block_cache.lookup(*this, start.value);
+    if (block.entries.empty()) {
+        advance_execution();
+        return m_bus.take_cycles();
+    }
+#ifdef FGBA_ENABLE_JIT
+    if (auto const native = m_block_cache.native_code(block, start.value); native.code != nullptr) {
+        auto const [executed, passed] = run_native(native, m_block_cache.generation());
+        return finish_block(block, start, executed, passed);
+    }
+#endif
+#ifdef FGBA_THREADED_DISPATCH
+    auto const [executed, passed] = arm::run_threaded(*this, block.threaded.data(), m_block_cache.generation());
+#else
+    auto const [executed, passed] = arm::run_entries(*this, block.entries, m_block_cache.generation());
+#endif
+    return finish_block(block, start, executed, passed);
 }
 
+auto arm7tdmi::finish_block(block_cache::block const& block, address const start, u32 const executed, bool const passed)
+    -> u32 {
+    // blocks don't go through the prefetch buffer, but hardware still fetched every one of
+    // them and a block never leaves its region, so they all cost the same
+    m_bus.add_cycles(executed * m_bus.sequential_cycles(start, data_size::word));
+    m_retired += executed;
+    // branches refill the pipeline themselves, unless they failed their condition
+    if (executed != block.entries.size() or not block.ends_in_branch or not passed) {
+        // instructions being fetched again were already paid for above
+        auto const cycles = m_bus.cycles();
+        resync_pipeline();
+        m_bus.rewind_cycles(cycles);
+    }
+    return m_bus.take_cycles();
+}
+
+#ifdef FGBA_ENABLE_JIT
+auto arm7tdmi::run_native(jit::translation const native, u32 const generation)
+    -> arm::block_run {
+    auto context = jit::context{
+        .registers  = {},
+        .cpu        = this,
+        .read       = arm::jit_read(),
+        .write      = arm::jit_write(),
+        .generation = generation,
+        .executed   = 0,
+        .passed     = 1,
+    };
+    for (u32 i = 0; i < 15; ++i) {
+        if ((native.registers >> i) & 1) context.registers[i] = &m_registers[i];
+    }
+    context.registers[registers::pc] = &m_registers.pc();
+    native.code(&context);
+    return {.executed = context.executed, .passed = context.passed != 0};
+}
+#endif
+
 auto arm7tdmi::prefetch() -> void {
-    if (m_registers.cpsr().is_thumb()) {
-        //TODO: implement thumb
+    if (m_registers.is_thumb()) {
+        m_bus.access_read(address{m_registers.pc().value}, data_size::hword);
+        auto bus_contents = m_bus.load_from();
+        m_prefetch_buffer.write<hword>(bus_contents.as<hword>());
     } else {
         m_bus.access_read(address{m_registers.pc().value}, data_size::word);
         auto bus_contents = m_bus.load_from();
@@ -34,15 +137,22 @@ auto arm7tdmi::flush_pipeline() -> void {
     m_prefetch_buffer.flush();
 }
 
+auto arm7tdmi::resync_pipeline() -> void {
+    flush_pipeline();
+    m_registers.pc() -= 8_word;
+    refill_pipeline();
+    increment_program_counter();
+}
+
 auto arm7tdmi::increment_program_counter() -> void {
-    if (m_registers.cpsr().is_thumb()) {
+    if (m_registers.is_thumb()) {
         m_registers.pc() += 2_word;
     } else {
         m_registers.pc() += 4_word;
     }
 }
 auto arm7tdmi::refill_pipeline() -> void {
-    if (m_registers.cpsr().is_thumb()) {
+    if (m_registers.is_thumb()) {
         prefetch();
         m_registers.pc() += 2_word;
         prefetch();
@@ -53,7 +163,27 @@ auto arm7tdmi::refill_pipeline() -> void {
     }
 }
 
-auto arm7tdmi::connect_bus(connector connector)
+auto arm7tdmi::connect_bus(bus_connector connector)
     -> void { m_bus.connect(connector); }
 
+auto arm7tdmi::save_state(state_writer& state) const
+    -> void {
+    state.section(state_section::cpu);
+    m_registers.save_state(state);
+    state.write(m_prefetch_buffer);
+    // whatever was last on the bus, it is what open bus reads give back
+    state.write(m_bus.load_from());
+    // cycles spent but not yet taken, like a reset refilling the pipeline
+    state.write(m_bus.cycles());
+}
+auto arm7tdmi::load_state(state_reader& state)
+    -> void {
+    state.expect(state_section::cpu);
+    m_registers.load_state(state);
+    state.read_into(m_prefetch_buffer);
+    m_bus.load_on(state.read<word>());
+    m_bus.take_cycles();
+    m_bus.add_cycles(state.read<u32>());
+}
+
 } // namespace fgba::cpu
@@ -0,0 +1,157 @@
+#include "emulator/cpu/block-cache.hpp"
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/instruction-impl/implementation.hpp"
+#ifdef FGBA_ENABLE_JIT
+#include "emulator/cpu/jit/translator.hpp"
+#endif
+#include "emulator/cpu/opcodes.hpp"
+#include "emulator/cpudefines.hpp"
+#include <cassert>
+
+namespace fgba::cpu {
+
+namespace {
+
+enum class control_flow {
+    straight,
+    branch,
+    // might write pc or switch state in some way the block can't follow
+    leaves_block,
+};
+
+[[nodiscard]]constexpr auto classify(arm::instruction_spec const spec, arm::instruction const instruction) noexcept
+    -> control_flow {
+    using enum arm::instruction_spec::set;
+    auto const straight_unless = [](bool writes_pc) {
+        return writes_pc ? control_flow::leaves_block : control_flow::straight;
+    };
+    auto const rd = instruction[15, 12].value;
+    switch (spec.base()) {
+        case b:
+        case bl:
+        case bx:
+            return control_flow::branch;
+        case tst:
+        case teq:
+        case cmp:
+        case cmn:
+        case str:
+        case stm:
+            return control_flow::straight;
+        case and_: case orr: case eor: case bic:
+        case add: case adc: case sub: case sbc: case rsb: case rsc:
+        case mov: case mvn:
+        case mrs:
+        case ldr:
+        case swp:
+            return straight_unless(rd == registers::pc);
+        case mul:
+            return straight_unless(instruction[19, 16].value == registers::pc);
+        case mll:
+            return straight_unless(rd == registers::pc or instruction[19, 16].value == registers::pc);
+        case ldm:
+            return straight_unless(instruction[15] == 1_bit);
+        // msr can flip thumb bit, the rest are exceptions of some sort
+        default:
+            return control_flow::leaves_block;
+    }
+}
+
+} // namespace
+
+#ifdef FGBA_ENABLE_JIT
+block_cache::block_cache()
+    : m_translator{std::make_unique<jit::translator>(arm::jit_fallback())} {}
+block_cache::~block_cache() = default;
+#endif
+
+auto block_cache::lookup(arm7tdmi& cpu, u32 const pc)
+    -> block& {
+    m_retired.clear();
+    if (auto const it = m_blocks.find(pc); it != m_blocks.end()) {
+        return it->second;
+    }
+    auto const page = code_page(pc);
+    m_code_pages.set(page);
+    m_page_blocks[page].push_back(pc);
+    return m_blocks.emplace(pc, compile(cpu, pc)).first->second;
+}
+
+auto block_cache::compile(arm7tdmi& cpu, u32 const pc)
+    -> block {
+    auto result = block{};
+    // looking ahead isn't something hardware does, so it costs nothing and leaves no trace in a state
+    auto const page_end = (pc | (code_page_size - 1)) + 1;
+    for (auto current = pc; current < page_end and result.entries.size() < max_block_length; current += 4) {
+        auto const instruction = arm::instruction{cpu.m_bus.peek(address{word{current}})};
+        auto const spec        = decode(instruction);
+        auto const handler     = arm::handler_for(spec);
+        if (handler == nullptr) break;
+
+        auto const flow = classify(spec, instruction);
+        if (flow == control_flow::leaves_block) break;
+        result.entries.push_back({handler, instruction});
+        if (flow == control_flow::branch) {
+            result.ends_in_branch = true;
+            break;
+        }
+    }
+#ifdef FGBA_THREADED_DISPATCH
+    result.threaded.reserve(result.entries.size() + 1);
+    for (auto const& [handler, instruction] : result.entries) {
+        auto const threaded = arm::threaded_handler_for(decode(instruction));
+        // made from the same table, so whatever has a handler has a threaded one too
+        assert(threaded != nullptr);
+        result.threaded.push_back({threaded, instruction});
+    }
+    result.threaded.push_back({arm::threaded_exit(), arm::instruction{}});
+#endif
+    return result;
+}
+
+#ifdef FGBA_ENABLE_JIT
+auto block_cache::native_code(block& block, u32 const pc)
+    -> jit::translation {
+    if (block.runs == jit_threshold) return block.native;
+    if (++block.runs < jit_threshold) return {};
+    auto translated = m_translator->translate(block.entries, pc);
+    if (not translated) {
+        // out of room, every translation goes and the hot ones will come back on their own
+        for (auto& [start, cached] : m_blocks) {
+            cached.native = {};
+            cached.runs   = 0;
+        }
+        m_translator->reset();
+        block.runs = jit_threshold;
+        translated = m_translator->translate(block.entries, pc);
+    }
+    block.native = translated.value_or(jit::translation{});
+    return block.native;
+}
+#endif
+
+auto block_cache::invalidate_page(u32 const page)
+    -> void {
+    if (auto const it = m_page_blocks.find(page); it != m_page_blocks.end()) {
+        for (auto const start : it->second) {
+            m_retired.push_back(m_blocks.extract(start));
+        }
+        m_page_blocks.erase(it);
+    }
+    m_code_pages.reset(page);
+    ++m_generation;
+}
+
+auto block_cache::clear() noexcept
+    -> void {
+    m_blocks.clear();
+    m_page_blocks.clear();
+    m_retired.clear();
+    m_code_pages.reset();
+#ifdef FGBA_ENABLE_JIT
+    m_translator->reset();
+#endif
+    ++m_generation;
+}
+
+} // namespace fgba::cpu
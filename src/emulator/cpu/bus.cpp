@@ -4,34 +4,21 @@
 
 namespace fgba::cpu {
 
-bus::bus(connector connector) noexcept
-    : m_connection{connector}, m_data{unitialized_word} {}
-
-auto bus::connect(connector connector) noexcept 
-    -> void { m_connection = connector; }
-
-auto bus::load_on(word data) noexcept
-    -> void { m_data = data; }
-
-auto bus::load_from() const noexcept
-    -> word { return m_data; }
-
-auto bus::access_read(address address, data_size mas) 
-    -> void {
-    m_connection.access_read(address, mas, m_data);
-}
-auto bus::access_write(address address, data_size mas)
-    -> void {
-    m_connection.access_write(address, mas, m_data);
-}
-
 auto connector::access_read(address address, data_size mas, word& data_bus)
-    -> void {
-    std::invoke(m_read_impl, m_mmu, address, mas, data_bus);
+    -> u32 {
+    return std::invoke(m_read_impl, m_mmu, address, mas, data_bus);
 }
 auto connector::access_write(address address, data_size mas, word data_bus)
-    -> void {
-    std::invoke(m_write_impl, m_mmu, address, mas, data_bus);
+    -> u32 {
+    return std::invoke(m_write_impl, m_mmu, address, mas, data_bus);
+}
+auto connector::sequential_cycles(address address, data_size mas) const
+    -> u32 {
+    return std::invoke(m_cycles_impl, m_mmu, address, mas);
+}
+auto connector::peek(address address)
+    -> word {
+    return std::invoke(m_peek_impl, m_mmu, address);
 }
 
 
@@ -1,4 +1,4 @@
-#include "disassembler.hpp"
+#include "emulator/cpu/disassembler.hpp"
 #include <fmt/core.h>
 
 #include <algorithm>
@@ -784,5 +784,17 @@ auto arm_instruction_to_string(u32 instruction)
     }
     return ret; 
 }
+auto disassemble_arm(std::span<std::byte const> binary)
+    -> std::vector<std::string> {
+    return disassemble(binary);
+}
+auto disassemble_arm(u32 instruction)
+    -> std::string {
+    try {
+        return arm_instruction_to_string(instruction);
+    } catch (...) {
+        return "<undefined>";
+    }
+}
 }
 //NOLINTEND
\ No newline at end of file
@@ -4,7 +4,10 @@
 #include "emulator/cpu/opcodes.hpp"
 #include "emulator/cpudefines.hpp"
 #include <array>
+#include <utility>
 #include "emulator/cpu/instruction-impl/implementation.hpp"
+#include "utility/fatexception.hpp"
+#include <fmt/format.h>
 //You know shits about to get down when you see this
 //NOLINTBEGIN
 namespace fgba::cpu::arm {
@@ -19,7 +22,6 @@ namespace  {
 [[nodiscard]]constexpr auto mov_impl(word operand1)                noexcept { return operand1; }
 
 
-using impl_ptr = auto (*)(arm7tdmi&, instruction) -> void;
 using impl_array = std::array<impl_ptr, instruction_spec::count()>;
 
 enum class ignore_dest {
@@ -97,6 +99,71 @@ consteval auto bind_operation(impl_array& arr) -> void {
     bind_operation_with_shift<Operation, Instr, Id, shifts::rsasr>(arr);   
     bind_operation_with_shift<Operation, Instr, Id, shifts::rsror>(arr);   
 }
+template<immediate_operand Im, shifts Shift, data_size Data, mll_signedndesd Sign, direction Dir, indexing Ind, write_back Wb>
+consteval auto bind_single_transfer(impl_array& arr) -> void {
+    arr[instruction_spec::construct<instruction_spec::set::ldr>(
+        Im, Shift, Dir, Ind, Wb, Data, Sign
+    ).as_index()] = &instruction_executor::data_load<Im, Shift, Dir, Ind, Wb, Data, Sign>;
+    // there is no signed store
+    if constexpr (Sign == mll_signedndesd::unsigned_) {
+        arr[instruction_spec::construct<instruction_spec::set::str>(
+            Im, Shift, Dir, Ind, Wb, Data
+        ).as_index()] = &instruction_executor::data_store<Im, Shift, Dir, Ind, Wb, Data>;
+    }
+}
+template<immediate_operand Im, shifts Shift, data_size Data, mll_signedndesd Sign>
+consteval auto bind_transfer(impl_array& arr) -> void {
+    bind_single_transfer<Im, Shift, Data, Sign, direction::up,   indexing::pre,  write_back::off>(arr);
+    bind_single_transfer<Im, Shift, Data, Sign, direction::up,   indexing::pre,  write_back::on >(arr);
+    bind_single_transfer<Im, Shift, Data, Sign, direction::up,   indexing::post, write_back::off>(arr);
+    bind_single_transfer<Im, Shift, Data, Sign, direction::up,   indexing::post, write_back::on >(arr);
+    bind_single_transfer<Im, Shift, Data, Sign, direction::down, indexing::pre,  write_back::off>(arr);
+    bind_single_transfer<Im, Shift, Data, Sign, direction::down, indexing::pre,  write_back::on >(arr);
+    bind_single_transfer<Im, Shift, Data, Sign, direction::down, indexing::post, write_back::off>(arr);
+    bind_single_transfer<Im, Shift, Data, Sign, direction::down, indexing::post, write_back::on >(arr);
+}
+// words and unsigned bytes take a 12 bit immediate or a register shifted by an immediate
+template<data_size Data>
+consteval auto bind_shifted_transfer(impl_array& arr) -> void {
+    using enum mll_signedndesd;
+    bind_transfer<immediate_operand::on,  shifts::null,  Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::null,  Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::asr32, Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::lsr32, Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::rrx,   Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::lsl,   Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::lsr,   Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::asr,   Data, unsigned_>(arr);
+    bind_transfer<immediate_operand::off, shifts::ror,   Data, unsigned_>(arr);
+}
+template<s_bit S, direction Dir, indexing Ind, write_back Wb>
+consteval auto bind_block_transfer(impl_array& arr) -> void {
+    arr[instruction_spec::construct<instruction_spec::set::stm>(S, Dir, Wb, Ind).as_index()] =
+        &instruction_executor::block_data_store<S, Dir, Ind, Wb>;
+    arr[instruction_spec::construct<instruction_spec::set::ldm>(S, Dir, Wb, Ind).as_index()] =
+        &instruction_executor::block_data_load<S, Dir, Ind, Wb>;
+}
+template<s_bit S>
+consteval auto bind_block_transfers(impl_array& arr) -> void {
+    bind_block_transfer<S, direction::up,   indexing::pre,  write_back::off>(arr);
+    bind_block_transfer<S, direction::up,   indexing::pre,  write_back::on >(arr);
+    bind_block_transfer<S, direction::up,   indexing::post, write_back::off>(arr);
+    bind_block_transfer<S, direction::up,   indexing::post, write_back::on >(arr);
+    bind_block_transfer<S, direction::down, indexing::pre,  write_back::off>(arr);
+    bind_block_transfer<S, direction::down, indexing::pre,  write_back::on >(arr);
+    bind_block_transfer<S, direction::down, indexing::post, write_back::off>(arr);
+    bind_block_transfer<S, direction::down, indexing::post, write_back::on >(arr);
+}
+template<s_bit S, accumulate A>
+consteval auto bind_multiply(impl_array& arr) -> void {
+    using enum mll_signedndesd;
+    arr[instruction_spec::construct<instruction_spec::set::mul>(S, A).as_index()] =
+        &instruction_executor::multiply<S, A>;
+    arr[instruction_spec::construct<instruction_spec::set::mll>(S, A, unsigned_).as_index()] =
+        &instruction_executor::multiply_long<S, A, unsigned_>;
+    arr[instruction_spec::construct<instruction_spec::set::mll>(S, A, signed_).as_index()] =
+        &instruction_executor::multiply_long<S, A, signed_>;
+}
 consteval auto init_arm_impl_ptrs() {
     impl_array ret{};
 
@@ -107,6 +174,8 @@ consteval auto init_arm_impl_ptrs() {
     bind_operation<and_impl, instruction_spec::set::and_, ignore_dest::off>(ret);
     bind_operation<orr_impl, instruction_spec::set::orr, ignore_dest::off>(ret);
     bind_operation<bic_impl, instruction_spec::set::bic, ignore_dest::off>(ret);
+    bind_operation<mov_impl, instruction_spec::set::mov, ignore_dest::off>(ret);
+    bind_operation<mvn_impl, instruction_spec::set::mvn, ignore_dest::off>(ret);
     bind_operation<add_impl, instruction_spec::set::add, ignore_dest::off>(ret);
     bind_operation<adc_impl, instruction_spec::set::adc, ignore_dest::off>(ret);
     bind_operation<sub_impl, instruction_spec::set::sub, ignore_dest::off>(ret);
@@ -117,10 +186,34 @@ consteval auto init_arm_impl_ptrs() {
     bind_operation<eor_impl, instruction_spec::set::teq, ignore_dest::on>(ret);
     bind_operation<sub_impl, instruction_spec::set::cmp, ignore_dest::on>(ret);
     bind_operation<add_impl, instruction_spec::set::cmn, ignore_dest::on>(ret);
+    bind_multiply<s_bit::off, accumulate::off>(ret);
+    bind_multiply<s_bit::off, accumulate::on >(ret);
+    bind_multiply<s_bit::on,  accumulate::off>(ret);
+    bind_multiply<s_bit::on,  accumulate::on >(ret);
+    bind_shifted_transfer<data_size::word>(ret);
+    bind_shifted_transfer<data_size::byte>(ret);
+    // halfwords and signed bytes only have an immediate or a plain register
+    bind_transfer<immediate_operand::on,  shifts::null, data_size::hword, mll_signedndesd::unsigned_>(ret);
+    bind_transfer<immediate_operand::off, shifts::null, data_size::hword, mll_signedndesd::unsigned_>(ret);
+    bind_transfer<immediate_operand::on,  shifts::null, data_size::hword, mll_signedndesd::signed_>(ret);
+    bind_transfer<immediate_operand::off, shifts::null, data_size::hword, mll_signedndesd::signed_>(ret);
+    bind_transfer<immediate_operand::on,  shifts::null, data_size::byte,  mll_signedndesd::signed_>(ret);
+    bind_transfer<immediate_operand::off, shifts::null, data_size::byte,  mll_signedndesd::signed_>(ret);
+    bind_block_transfers<s_bit::off>(ret);
+    bind_block_transfers<s_bit::on>(ret);
     return ret;
 }
 inline constexpr impl_array arm_impl_ptrs = init_arm_impl_ptrs();
 
+using threaded_array = std::array<threaded_ptr, instruction_spec::count()>;
+
+// one threaded handler for every distinct handler above, they are instantiated from its values
+template<std::size_t... I>
+consteval auto init_threaded_ptrs(std::index_sequence<I...>) {
+    return threaded_array{(arm_impl_ptrs[I] == nullptr ? nullptr : &instruction_executor::threaded<arm_impl_ptrs[I]>)...};
+}
+inline constexpr threaded_array threaded_ptrs = init_threaded_ptrs(std::make_index_sequence<instruction_spec::count()>{});
+
 }
 
 
@@ -129,6 +222,38 @@ inline constexpr impl_array arm_impl_ptrs = init_arm_impl_ptrs();
 //NOLINTEND
 namespace fgba::cpu::arm {
 auto arm::execute(arm7tdmi& cpu, instruction_spec spec, instruction instruction) -> void {
-    std::invoke(arm_impl_ptrs[spec.as_index()], cpu, instruction);
+    auto const handler = arm_impl_ptrs[spec.as_index()];
+    if (handler == nullptr) [[unlikely]] {
+        throw runtime_error{fmt::format("arm instruction {:#010x} is not implemented", instruction.value)};
+    }
+    std::invoke(handler, cpu, instruction);
+}
+auto arm::handler_for(instruction_spec spec) noexcept -> impl_ptr {
+    return arm_impl_ptrs[spec.as_index()];
+}
+auto arm::threaded_handler_for(instruction_spec spec) noexcept -> threaded_ptr {
+    return threaded_ptrs[spec.as_index()];
+}
+auto arm::threaded_exit() noexcept -> threaded_ptr {
+    return &instruction_executor::threaded_exit;
+}
+auto arm::run_entries(arm7tdmi& cpu, std::span<block_cache::entry const> entries, u32 generation) -> block_run {
+    return instruction_executor::run_entries(cpu, entries, generation);
+}
+auto arm::run_threaded(arm7tdmi& cpu, threaded_entry const* entries, u32 generation) -> block_run {
+    auto context = threaded_context{.cpu = &cpu, .generation = generation, .executed = 0, .passed = true};
+    entries->handler(context, entries);
+    return {.executed = context.executed, .passed = context.passed};
+}
+#ifdef FGBA_ENABLE_JIT
+auto arm::jit_fallback() noexcept -> jit::fallback_ptr {
+    return &instruction_executor::jit_fallback;
+}
+auto arm::jit_read() noexcept -> jit::read_ptr {
+    return &instruction_executor::jit_read;
+}
+auto arm::jit_write() noexcept -> jit::write_ptr {
+    return &instruction_executor::jit_write;
 }
+#endif
 }
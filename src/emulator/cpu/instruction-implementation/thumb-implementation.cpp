@@ -0,0 +1,114 @@
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/instruction-impl/detail/thumb-instruction-executor.hpp"
+#include "emulator/cpu/instruction-impl/implementation.hpp"
+#include "emulator/cpu/opcodes.hpp"
+#include "emulator/cpudefines.hpp"
+#include "utility/fatexception.hpp"
+#include <fmt/format.h>
+#include <array>
+#include <utility>
+
+namespace fgba::cpu::thumb {
+
+namespace {
+
+using impl_array = std::array<impl_ptr, thumb_instruction::count()>;
+
+consteval auto init_thumb_impl_ptrs() {
+    using enum thumb_instruction::set;
+    using executor = instruction_executor;
+    impl_array ret{};
+    auto bind = [&](thumb_instruction::set instr) -> impl_ptr& {
+        return ret[thumb_instruction{instr}.as_index()];
+    };
+
+    bind(lsl_imm)    = executor::move_shifted<shifts::lsl>;
+    bind(lsr_imm)    = executor::move_shifted<shifts::lsr>;
+    bind(asr_imm)    = executor::move_shifted<shifts::asr>;
+    bind(add_reg)    = executor::add_subtract<add_reg>;
+    bind(sub_reg)    = executor::add_subtract<sub_reg>;
+    bind(add_imm3)   = executor::add_subtract<add_imm3>;
+    bind(sub_imm3)   = executor::add_subtract<sub_imm3>;
+    bind(mov_imm)    = executor::immediate<mov_imm>;
+    bind(cmp_imm)    = executor::immediate<cmp_imm>;
+    bind(add_imm)    = executor::immediate<add_imm>;
+    bind(sub_imm)    = executor::immediate<sub_imm>;
+    bind(and_)       = executor::alu<and_>;
+    bind(eor)        = executor::alu<eor>;
+    bind(lsl)        = executor::alu<lsl>;
+    bind(lsr)        = executor::alu<lsr>;
+    bind(asr)        = executor::alu<asr>;
+    bind(adc)        = executor::alu<adc>;
+    bind(sbc)        = executor::alu<sbc>;
+    bind(ror)        = executor::alu<ror>;
+    bind(tst)        = executor::alu<tst>;
+    bind(neg)        = executor::alu<neg>;
+    bind(cmp)        = executor::alu<cmp>;
+    bind(cmn)        = executor::alu<cmn>;
+    bind(orr)        = executor::alu<orr>;
+    bind(mul)        = executor::alu<mul>;
+    bind(bic)        = executor::alu<bic>;
+    bind(mvn)        = executor::alu<mvn>;
+    bind(add_hi)     = executor::hi_register<add_hi>;
+    bind(cmp_hi)     = executor::hi_register<cmp_hi>;
+    bind(mov_hi)     = executor::hi_register<mov_hi>;
+    bind(bx)         = executor::bx;
+    bind(ldr_pc)     = executor::pc_relative_load;
+    bind(str_reg)    = executor::register_offset<str_reg>;
+    bind(strb_reg)   = executor::register_offset<strb_reg>;
+    bind(ldr_reg)    = executor::register_offset<ldr_reg>;
+    bind(ldrb_reg)   = executor::register_offset<ldrb_reg>;
+    bind(strh_reg)   = executor::register_offset<strh_reg>;
+    bind(ldsb_reg)   = executor::register_offset<ldsb_reg>;
+    bind(ldrh_reg)   = executor::register_offset<ldrh_reg>;
+    bind(ldsh_reg)   = executor::register_offset<ldsh_reg>;
+    bind(str_imm)    = executor::immediate_offset<str_imm>;
+    bind(ldr_imm)    = executor::immediate_offset<ldr_imm>;
+    bind(strb_imm)   = executor::immediate_offset<strb_imm>;
+    bind(ldrb_imm)   = executor::immediate_offset<ldrb_imm>;
+    bind(strh_imm)   = executor::immediate_offset<strh_imm>;
+    bind(ldrh_imm)   = executor::immediate_offset<ldrh_imm>;
+    bind(str_sp)     = executor::sp_relative<str_sp>;
+    bind(ldr_sp)     = executor::sp_relative<ldr_sp>;
+    bind(add_pc)     = executor::load_address<add_pc>;
+    bind(add_sp)     = executor::load_address<add_sp>;
+    bind(add_sp_imm) = executor::adjust_sp;
+    bind(push)       = executor::push_pop<push>;
+    bind(pop)        = executor::push_pop<pop>;
+    bind(stmia)      = executor::block_transfer<stmia>;
+    bind(ldmia)      = executor::block_transfer<ldmia>;
+    bind(b_cond)     = executor::conditional_branch;
+    bind(b)          = executor::branch;
+    bind(bl_hi)      = executor::long_branch<bl_hi>;
+    bind(bl_lo)      = executor::long_branch<bl_lo>;
+    // swi and undefined are waiting for exceptions to exist
+    return ret;
+}
+inline constexpr impl_array thumb_impl_ptrs = init_thumb_impl_ptrs();
+
+auto unimplemented(arm7tdmi&, instruction const instruction) -> void {
+    throw runtime_error{fmt::format("thumb instruction {:#06x} is not implemented", instruction.value)};
+}
+
+// decode lut and the table above folded into one,
+// so the opcode leads straight to the handler
+consteval auto init_thumb_dispatch() {
+    auto ret = std::array<impl_ptr, detail::decode_lut.size()>{};
+    for (std::size_t i = 0; i < ret.size(); ++i) {
+        auto const handler = thumb_impl_ptrs[thumb_instruction{detail::decode_lut[i]}.as_index()];
+        ret[i] = handler != nullptr ? handler : unimplemented;
+    }
+    return ret;
+}
+inline constexpr auto thumb_dispatch = init_thumb_dispatch();
+
+} // namespace
+
+auto execute(arm7tdmi& cpu, instruction const instruction) -> void {
+    thumb_dispatch[detail::to_index(instruction)](cpu, instruction);
+}
+auto handler_for(thumb_instruction const instruction) noexcept -> impl_ptr {
+    return thumb_impl_ptrs[instruction.as_index()];
+}
+
+} // namespace fgba::cpu::thumb
@@ -0,0 +1,56 @@
+#include "emulator/cpu/jit/code-buffer.hpp"
+#include "utility/fatexception.hpp"
+#include "fmt/format.h"
+
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace fgba::cpu::jit {
+
+namespace {
+
+// keeps every block starting on a cache line
+constexpr std::size_t block_alignment = 64;
+
+[[nodiscard]]auto page_size() noexcept
+    -> std::size_t {
+    static auto const size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+}
+
+code_buffer::code_buffer(std::size_t const size)
+    : m_size{size} {
+    auto* const mapping = ::mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw runtime_error{fmt::format("couldn't map {} bytes for native code", size)};
+    }
+    m_memory = static_cast<std::byte*>(mapping);
+}
+
+code_buffer::~code_buffer() {
+    ::munmap(m_memory, m_size);
+}
+
+auto code_buffer::install(std::span<u8 const> const code)
+    -> void const* {
+    auto const at = (m_used + block_alignment - 1) & ~(block_alignment - 1);
+    if (code.size() > m_size or at > m_size - code.size()) return nullptr;
+    // only pages the code lands on are flipped, the rest of the buffer stays as it is
+    auto const first = at & ~(page_size() - 1);
+    auto const last  = (at + code.size() + page_size() - 1) & ~(page_size() - 1);
+    if (::mprotect(m_memory + first, last - first, PROT_READ | PROT_WRITE) != 0) {
+        throw runtime_error{"couldn't make native code writable"};
+    }
+    std::memcpy(m_memory + at, code.data(), code.size());
+    if (::mprotect(m_memory + first, last - first, PROT_READ | PROT_EXEC) != 0) {
+        throw runtime_error{"couldn't make native code executable"};
+    }
+    m_used = at + code.size();
+    return m_memory + at;
+}
+
+}
@@ -0,0 +1,352 @@
+#include "emulator/cpu/jit/translator.hpp"
+#include "emulator/cpu/jit/x64-emitter.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace fgba::cpu::jit {
+
+static_assert(std::is_same_v<handler_ptr, arm::impl_ptr>);
+// native code stores straight into the registers the context points at
+static_assert(sizeof(word) == sizeof(u32) and std::is_standard_layout_v<word>);
+
+namespace {
+
+// guest registers live in these, all of them are caller saved so they are spilled around calls anyway.
+// rax is scratch, rbx holds the context
+constexpr auto host_registers = std::array{
+    x64::rcx, x64::rdx, x64::rsi, x64::r8, x64::r9, x64::r10, x64::r11,
+};
+constexpr u32 pc_index = 15;
+
+enum class unary : u8 {
+    none,
+    neg,
+    not_,
+};
+// how an operation is put together from operand2 in eax: unary op on it, then rn combined into it
+struct recipe {
+    unary before;
+    std::optional<x64_alu> with_rn;
+};
+
+// by opcode bits, only the ones which need neither carry nor flags
+constexpr auto recipes = std::array<std::optional<recipe>, 16>{
+    /* and */ recipe{unary::none, x64_alu::and_},
+    /* eor */ recipe{unary::none, x64_alu::xor_},
+    /* sub */ recipe{unary::neg,  x64_alu::add},
+    // eax - rn
+    /* rsb */ recipe{unary::none, x64_alu::sub},
+    /* add */ recipe{unary::none, x64_alu::add},
+    /* adc */ std::nullopt,
+    /* sbc */ std::nullopt,
+    /* rsc */ std::nullopt,
+    /* tst */ std::nullopt,
+    /* teq */ std::nullopt,
+    /* cmp */ std::nullopt,
+    /* cmn */ std::nullopt,
+    /* orr */ recipe{unary::none, x64_alu::or_},
+    /* mov */ recipe{unary::none, std::nullopt},
+    /* bic */ recipe{unary::not_, x64_alu::and_},
+    /* mvn */ recipe{unary::not_, std::nullopt},
+};
+
+enum class access : u8 {
+    none,
+    load,
+    store,
+};
+
+struct native_instruction {
+    recipe how;
+    u32 rd;
+    u32 rn;
+    u32 rm;
+    bool immediate;
+    // already rotated
+    u32 value;
+    // lsl, lsr, asr, ror as they are encoded
+    u32 shift_type;
+    u32 shift_amount;
+    // loads and stores work base and offset out the way add and sub do, rd is what gets transferred
+    access memory{access::none};
+    bool byte{};
+    bool pre{};
+    bool write_back{};
+
+    [[nodiscard]]auto registers() const noexcept
+        -> u16 {
+        auto result = 1_u32 << rd;
+        if (how.with_rn) result |= 1_u32 << rn;
+        if (not immediate) result |= 1_u32 << rm;
+        return static_cast<u16>(result);
+    }
+};
+
+[[nodiscard]]constexpr auto field(u32 const instruction, u32 const high, u32 const low) noexcept
+    -> u32 { return (instruction >> low) & ((2_u32 << (high - low)) - 1); }
+
+// register operand is only ever shifted by an immediate
+[[nodiscard]]auto shift_is_native(u32 const instruction, native_instruction const& result) noexcept
+    -> bool {
+    if (result.immediate) return true;
+    // shift by register, or rrx which needs carry
+    if (field(instruction, 4, 4) != 0 or (result.shift_type == 3 and result.shift_amount == 0)) return false;
+    return result.rm != pc_index;
+}
+
+// word and unsigned byte ldr and str. pc can only be the base of a literal load, its address is known right here
+[[nodiscard]]auto decode_transfer(u32 const instruction, u32 const pc) noexcept
+    -> std::optional<native_instruction> {
+    auto const up = field(instruction, 23, 23) == 1;
+    auto result = native_instruction{
+        .how          = up ? recipe{unary::none, x64_alu::add} : recipe{unary::neg, x64_alu::add},
+        .rd           = field(instruction, 15, 12),
+        .rn           = field(instruction, 19, 16),
+        .rm           = field(instruction, 3, 0),
+        .immediate    = field(instruction, 25, 25) == 0,
+        .value        = field(instruction, 11, 0),
+        .shift_type   = field(instruction, 6, 5),
+        .shift_amount = field(instruction, 11, 7),
+        .memory       = field(instruction, 20, 20) == 1 ? access::load : access::store,
+        .byte         = field(instruction, 22, 22) == 1,
+        .pre          = field(instruction, 24, 24) == 1,
+        // post indexing always writes back
+        .write_back   = field(instruction, 24, 24) == 0 or field(instruction, 21, 21) == 1,
+    };
+    if (result.rd == pc_index or not shift_is_native(instruction, result)) return std::nullopt;
+    if (result.rn == pc_index) {
+        if (not result.immediate or result.write_back) return std::nullopt;
+        result.value = up ? pc + result.value : pc - result.value;
+        result.how   = recipe{unary::none, std::nullopt};
+    }
+    return result;
+}
+
+// the bits are picked apart right here, it is only ever a handful of shapes
+[[nodiscard]]auto decode_native(u32 const instruction, u32 const pc) noexcept
+    -> std::optional<native_instruction> {
+    auto const bits = [instruction](u32 high, u32 low) { return field(instruction, high, low); };
+    if (bits(31, 28) != 0xe) return std::nullopt;
+    if (bits(27, 26) == 1) return decode_transfer(instruction, pc);
+    // al, data processing, s clear
+    if (bits(27, 26) != 0 or bits(20, 20) != 0) return std::nullopt;
+    auto const how = recipes[bits(24, 21)];
+    if (not how) return std::nullopt;
+
+    auto result = native_instruction{
+        .how          = *how,
+        .rd           = bits(15, 12),
+        .rn           = bits(19, 16),
+        .rm           = bits(3, 0),
+        .immediate    = bits(25, 25) == 1,
+        .value        = std::rotr(bits(7, 0), static_cast<int>(2 * bits(11, 8))),
+        .shift_type   = bits(6, 5),
+        .shift_amount = bits(11, 7),
+    };
+    if (result.rd == pc_index or (how->with_rn and result.rn == pc_index)) return std::nullopt;
+    if (not shift_is_native(instruction, result)) return std::nullopt;
+    return result;
+}
+
+class block_emitter {
+public:
+    explicit block_emitter(u16 const allocated)
+        : m_allocated{allocated} {
+        auto next = std::size_t{0};
+        for (u32 guest = 0; guest < 16; ++guest) {
+            if ((allocated >> guest) & 1) m_host[guest] = host_registers[next++];
+        }
+    }
+
+    auto prologue()
+        -> void {
+        m_code.push(x64::rbx);
+        m_code.mov64(x64::rbx, x64::rdi);
+    }
+    auto native(native_instruction const& instruction)
+        -> void {
+        if (m_stale) load_all();
+        operand2(instruction);
+        if (instruction.how.with_rn) {
+            m_code.alu32(*instruction.how.with_rn, x64::rax, m_host[instruction.rn]);
+        }
+        m_code.mov32(m_host[instruction.rd], x64::rax);
+        m_dirty |= 1_u32 << instruction.rd;
+    }
+    // a straight call into the bus. the call clobbers host registers, so they go back to the context around it
+    auto transfer(native_instruction const& instruction, u32 const next_pc, u32 const executed)
+        -> void {
+        if (m_stale) load_all();
+        // a store can throw the block away and it is left right after the store then
+        if (instruction.memory == access::store) finish_native(next_pc, executed);
+        else flush();
+        operand2(instruction);
+        if (instruction.how.with_rn) {
+            m_code.alu32(*instruction.how.with_rn, x64::rax, m_host[instruction.rn]);
+        }
+        // rdi is not needed before the call, it is the second scratch register until then
+        if (instruction.write_back) {
+            m_code.load64(x64::rdi, x64::rbx, register_offset(instruction.rn));
+            m_code.store32(x64::rdi, 0, x64::rax);
+        }
+        if (not instruction.pre) m_code.mov32(x64::rax, m_host[instruction.rn]);
+
+        auto const size = static_cast<u32>(instruction.byte ? data_size::byte : data_size::word);
+        if (instruction.memory == access::store) {
+            // rd might live in an argument register, it is read before any of them is written
+            m_code.mov32(x64::rdx, m_host[instruction.rd]);
+            m_code.mov_imm32(x64::rcx, size);
+        } else {
+            m_code.mov_imm32(x64::rdx, size);
+        }
+        m_code.mov32(x64::rsi, x64::rax);
+        m_code.mov64(x64::rdi, x64::rbx);
+        auto const thunk = instruction.memory == access::store ? offsetof(context, write) : offsetof(context, read);
+        m_code.load64(x64::rax, x64::rbx, static_cast<i32>(thunk));
+        m_code.call(x64::rax);
+        if (instruction.memory == access::store) {
+            m_code.test32(x64::rax, x64::rax);
+            m_exits.push_back(m_code.jz());
+        } else {
+            // written back after the base, so a loaded base wins
+            m_code.load64(x64::rcx, x64::rbx, register_offset(instruction.rd));
+            m_code.store32(x64::rcx, 0, x64::rax);
+        }
+        m_stale = true;
+    }
+
+    auto fallback(fallback_ptr const fallback, block_cache::entry const& entry, u32 const pc, u32 const index)
+        -> void {
+        flush();
+        m_code.mov64(x64::rdi, x64::rbx);
+        m_code.mov_imm64(x64::rsi, reinterpret_cast<std::uintptr_t>(entry.handler)); //NOLINT
+        m_code.mov_imm32(x64::rdx, entry.instruction.value);
+        m_code.mov_imm32(x64::rcx, pc);
+        m_code.mov_imm32(x64::r8, index);
+        m_code.mov_imm64(x64::rax, reinterpret_cast<std::uintptr_t>(fallback)); //NOLINT
+        m_code.call(x64::rax);
+        m_code.test32(x64::rax, x64::rax);
+        m_exits.push_back(m_code.jz());
+        m_stale = true;
+    }
+    // after a native instruction nobody has told the context how far the block got yet
+    auto finish_native(u32 const pc, u32 const executed)
+        -> void {
+        flush();
+        m_code.load64(x64::rax, x64::rbx, register_offset(pc_index));
+        m_code.store_imm32(x64::rax, 0, pc);
+        m_code.store_imm32(x64::rbx, offsetof(context, executed), executed);
+        m_code.store_imm32(x64::rbx, offsetof(context, passed), 1);
+    }
+    auto epilogue()
+        -> void {
+        for (auto const exit : m_exits) m_code.bind(exit);
+        m_code.pop(x64::rbx);
+        m_code.ret();
+    }
+    [[nodiscard]]auto bytes() const noexcept
+        -> std::vector<u8> const& { return m_code.bytes(); }
+private:
+    [[nodiscard]]static constexpr auto register_offset(u32 const guest) noexcept
+        -> i32 { return static_cast<i32>(offsetof(context, registers) + guest * sizeof(word*)); }
+
+    // operand2 goes into eax with the unary part of the recipe already applied
+    auto operand2(native_instruction const& instruction)
+        -> void {
+        if (instruction.immediate) {
+            auto value = instruction.value;
+            // unary part can be done right now
+            if (instruction.how.before == unary::neg) value = 0_u32 - value;
+            if (instruction.how.before == unary::not_) value = ~value;
+            m_code.mov_imm32(x64::rax, value);
+            return;
+        }
+        m_code.mov32(x64::rax, m_host[instruction.rm]);
+        auto const amount = static_cast<u8>(instruction.shift_amount);
+        switch (instruction.shift_type) {
+            // lsl #0 is the register as it is
+            case 0: if (amount != 0) m_code.shift32(x64_shift::shl, x64::rax, amount); break;
+            // lsr #0 and asr #0 stand for #32
+            case 1:
+                if (amount != 0) m_code.shift32(x64_shift::shr, x64::rax, amount);
+                else m_code.mov_imm32(x64::rax, 0);
+                break;
+            case 2: m_code.shift32(x64_shift::sar, x64::rax, amount != 0 ? amount : u8{31}); break;
+            default: m_code.shift32(x64_shift::ror, x64::rax, amount); break;
+        }
+        if (instruction.how.before == unary::neg) m_code.neg32(x64::rax);
+        if (instruction.how.before == unary::not_) m_code.not32(x64::rax);
+    }
+    auto load_all()
+        -> void {
+        for (u32 guest = 0; guest < 16; ++guest) {
+            if (((m_allocated >> guest) & 1) == 0) continue;
+            m_code.load64(x64::rax, x64::rbx, register_offset(guest));
+            m_code.load32(m_host[guest], x64::rax, 0);
+        }
+        m_stale = false;
+    }
+    auto flush()
+        -> void {
+        for (u32 guest = 0; guest < 16; ++guest) {
+            if (((m_dirty >> guest) & 1) == 0) continue;
+            m_code.load64(x64::rax, x64::rbx, register_offset(guest));
+            m_code.store32(x64::rax, 0, m_host[guest]);
+        }
+        m_dirty = 0;
+    }
+
+    x64_emitter m_code;
+    std::array<x64, 16> m_host{};
+    std::vector<x64_emitter::label> m_exits;
+    u32 m_allocated;
+    u32 m_dirty{0};
+    // host registers don't hold guest ones, nothing has loaded them yet or a call clobbered them
+    bool m_stale{true};
+};
+
+}
+
+translator::translator(fallback_ptr const fallback, std::size_t const buffer_size)
+    : m_fallback{fallback}, m_buffer{buffer_size} {}
+
+auto translator::translate(std::span<block_cache::entry const> const entries, u32 const start)
+    -> std::optional<translation> {
+    // greedy, an instruction gets to be native if its registers still fit next to the ones taken so far
+    auto decoded   = std::vector<std::optional<native_instruction>>(entries.size());
+    auto allocated = u16{0};
+    // pc as an instruction sees it, two ahead
+    auto const pc_at = [start](std::size_t const i) { return static_cast<u32>(start + 8 + 4 * i); };
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        auto const instruction = decode_native(entries[i].instruction.value, pc_at(i));
+        if (not instruction) continue;
+        auto const wanted = static_cast<u16>(allocated | instruction->registers());
+        if (std::popcount(wanted) > static_cast<int>(host_registers.size())) continue;
+        allocated  = wanted;
+        decoded[i] = instruction;
+    }
+    if (allocated == 0) return translation{};
+
+    auto emitter = block_emitter{allocated};
+    emitter.prologue();
+    for (u32 i = 0; i < entries.size(); ++i) {
+        if (not decoded[i]) emitter.fallback(m_fallback, entries[i], pc_at(i), i);
+        else if (decoded[i]->memory != access::none) emitter.transfer(*decoded[i], pc_at(i + 1), i + 1);
+        else emitter.native(*decoded[i]);
+    }
+    auto const count = static_cast<u32>(entries.size());
+    if (decoded.back()) emitter.finish_native(pc_at(count), count);
+    emitter.epilogue();
+
+    auto const* const code = m_buffer.install(emitter.bytes());
+    if (code == nullptr) return std::nullopt;
+    return translation{.code = reinterpret_cast<native_block>(code), .registers = allocated}; //NOLINT
+}
+
+}
@@ -207,5 +207,8 @@ namespace cpu {
 auto decode(arm::instruction const instruction) noexcept -> arm::instruction_spec {
     return {arm::offset_lut[arm::to_index(instruction)]};
 }
+auto decode(thumb::instruction const instruction) noexcept -> thumb_instruction {
+    return {thumb::detail::decode_lut[thumb::detail::to_index(instruction)]};
+}
 }
 } // namespace fgba
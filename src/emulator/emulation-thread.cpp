@@ -0,0 +1,150 @@
+#include "emulator/emulation-thread.hpp"
+#include "utility/fatexception.hpp"
+#include "spdlog/spdlog.h"
+
+#include <optional>
+#include <span>
+
+namespace fgba {
+
+emulation_thread::emulation_thread(gameboy_advance& gba, rewind_config const& rewind, std::filesystem::path movie_path)
+    : m_gba{&gba},
+      m_rewind{rewind},
+      m_movie_path{std::move(movie_path)},
+      m_thread{[this](std::stop_token const& stop) { run(stop); }} {}
+
+emulation_thread::~emulation_thread() {
+    m_thread.request_stop();
+    // it might be asleep waiting for a command
+    m_posted.fetch_add(1, std::memory_order_release);
+    m_posted.notify_one();
+    m_thread.join();
+}
+
+auto emulation_thread::post(command const cmd) noexcept
+    -> bool {
+    if (not m_commands.try_push(cmd)) return false;
+    m_posted.fetch_add(1, std::memory_order_release);
+    m_posted.notify_one();
+    return true;
+}
+
+auto emulation_thread::run(std::stop_token const& stop)
+    -> void {
+    using clock = std::chrono::steady_clock;
+    auto deadline = clock::now();
+    while (not stop.stop_requested()) {
+        // read before draining, so a command posted after that wakes the wait below
+        auto const posted = m_posted.load(std::memory_order_acquire);
+        while (auto const cmd = m_commands.try_pop()) {
+            handle(*cmd);
+        }
+        if (not m_running.load(std::memory_order_relaxed) and m_pending_steps == 0) {
+            m_posted.wait(posted, std::memory_order_acquire);
+            deadline = clock::now();
+            continue;
+        }
+        if (m_pending_steps != 0) --m_pending_steps;
+        run_frame();
+
+        deadline += frame_duration;
+        auto const now = clock::now();
+        // too far behind to ever catch up, keep the pace from here instead of rushing
+        if (now > deadline + frame_duration) {
+            deadline = now;
+        } else {
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+auto emulation_thread::handle(command const cmd)
+    -> void {
+    switch (cmd.type) {
+        case command_type::pause:      m_running.store(false, std::memory_order_relaxed); break;
+        case command_type::resume:     m_running.store(true, std::memory_order_relaxed);  break;
+        case command_type::step_frame: ++m_pending_steps; break;
+        // rewinding past a reset or a loaded state would land in a timeline which is gone.
+        // a movie can't follow the machine there either, so it ends where the timeline does
+        case command_type::reset: {
+            stop_recording();
+            m_gba->reset(cmd.argument != 0);
+            m_rewind.clear();
+            break;
+        }
+        case command_type::save_state: {
+            if (cmd.argument >= state_slot_count) break;
+            m_gba->save_state(m_state_slots[cmd.argument], save_compression::zero_runs);
+            break;
+        }
+        case command_type::load_state: {
+            if (cmd.argument >= state_slot_count or m_state_slots[cmd.argument].empty()) break;
+            stop_recording();
+            try {
+                m_gba->load_state(m_state_slots[cmd.argument]);
+                m_rewind.clear();
+            } catch (fgba::runtime_error const& e) {
+                spdlog::error("couldn't load state from slot {}: {}", cmd.argument + 1, e);
+                m_running.store(false, std::memory_order_relaxed);
+            }
+            break;
+        }
+        case command_type::rewind: {
+            auto state = std::optional<std::span<std::byte const>>{};
+            for (u32 step = 0; step < cmd.argument; ++step) {
+                auto const previous = m_rewind.step_back();
+                if (not previous.has_value()) break;
+                state = previous;
+            }
+            if (not state.has_value()) break;
+            stop_recording();
+            m_gba->load_state(*state);
+            break;
+        }
+        case command_type::set_run_ahead: m_run_ahead.store(cmd.argument, std::memory_order_relaxed); break;
+        case command_type::set_keys: {
+            m_keys = static_cast<u16>(cmd.argument);
+            m_gba->set_keys(m_keys);
+            break;
+        }
+        case command_type::start_recording: {
+            m_recording = start_movie(*m_gba);
+            m_recording_flag.store(true, std::memory_order_relaxed);
+            break;
+        }
+        case command_type::stop_recording: stop_recording(); break;
+        default: break;
+    }
+}
+
+auto emulation_thread::stop_recording()
+    -> void {
+    if (not m_recording.has_value()) return;
+    try {
+        write_movie(m_movie_path, *m_recording);
+        spdlog::info("{} frames recorded into {}", m_recording->keys.size(), m_movie_path.string());
+    } catch (fgba::runtime_error const& e) {
+        spdlog::error("recording is lost: {}", e);
+    }
+    m_recording.reset();
+    m_recording_flag.store(false, std::memory_order_relaxed);
+}
+
+auto emulation_thread::run_frame()
+    -> void try {
+    if (m_recording.has_value()) m_recording->keys.push_back(m_keys);
+    m_gba->run_frame_ahead(m_run_ahead.load(std::memory_order_relaxed));
+    if (m_rewind.get_config().memory_budget != 0 and m_rewind.frame_finished()) {
+        m_gba->save_state(m_snapshot);
+        m_rewind.push(m_snapshot);
+    }
+    m_cpu_snapshots.back() = m_gba->dump_cpu_state().get_regitsters_contents();
+    m_cpu_snapshots.publish();
+} catch (fgba::runtime_error const& e) {
+    // nothing on this thread can do anything about it, stop and let whoever watches know
+    spdlog::error("emulation stopped: {}", e);
+    m_running.store(false, std::memory_order_relaxed);
+    m_pending_steps = 0;
+}
+
+}
@@ -1,11 +1,117 @@
 #include "emulator/gbaemu.hpp"
 #include "utility/fatexception.hpp"
 #include "emulator/mmu/mmu.hpp"
+#include <algorithm>
+#include <cstring>
 #include <source_location>
+#include <utility>
 namespace fgba {
 static std::vector<std::byte> dummy;
 gameboy_advance::gameboy_advance()
-    : m_cpu{}, m_ppu{}, m_mmu{m_ppu} {
+    : m_arena{}, m_scheduler{}, m_cpu{}, m_ppu{m_scheduler, m_arena}, m_mmu{m_ppu, m_arena} {
+    m_cpu.connect_bus(m_mmu);
+    save_state(m_power_on_state);
 } 
 
+auto gameboy_advance::reset(bool const skip_bios)
+    -> void {
+    // save memory is on the cartridge, it doesn't go anywhere when the power does
+    auto const sram = m_arena.region(mmu::memory_arena::region_of<mmu::sram_spec>());
+    auto const kept = std::vector<std::byte>(sram.begin(), sram.end());
+    load_state(m_power_on_state);
+    std::ranges::copy(kept, sram.begin());
+    if (skip_bios) {
+        m_cpu.skip_bios();
+    } else {
+        m_cpu.reset();
+    }
+}
+
+auto gameboy_advance::run_for(u64 const cycles)
+    -> u64 {
+    // blocks aren't cut at deadlines, so events fire at most a block late
+    auto const start  = m_scheduler.now();
+    auto const target = start + cycles;
+    while (m_scheduler.now() < target) {
+        m_scheduler.advance(m_cpu.execute_block());
+    }
+    return m_scheduler.now() - start;
+}
+
+auto gameboy_advance::run_frame_ahead(u32 const frames)
+    -> u64 {
+    if (frames == 0) return run_frame();
+    // frames are not left switched off if something throws half way
+    struct publishing_guard {
+        ppu::ppu& ppu;
+        ~publishing_guard() { ppu.set_frame_publishing(true); }
+    } const guard{m_ppu};
+    m_ppu.set_frame_publishing(false);
+    auto const cycles = run_frame();
+    save_state(m_run_ahead_state);
+    for (u32 frame = 1; frame < frames; ++frame) {
+        run_frame();
+    }
+    m_ppu.set_frame_publishing(true);
+    run_frame();
+    load_state(m_run_ahead_state);
+    return cycles;
+}
+
+auto gameboy_advance::save_state(std::vector<std::byte>& state, save_compression const compression) const
+    -> void {
+    auto writer = state_writer{state, compression};
+    m_scheduler.save_state(writer);
+    m_cpu.save_state(writer);
+    m_ppu.save_state(writer);
+    m_mmu.save_state(writer);
+    writer.section(state_section::memory);
+    // bios is loaded, not emulated, so it stays out
+    for (u32 region = 1; region < mmu::memory_arena::region_count; ++region) {
+        if (auto const memory = m_arena.region(region); not memory.empty()) {
+            writer.write(region);
+            writer.write_block(memory);
+        }
+    }
+}
+auto gameboy_advance::save_state(save_compression const compression) const
+    -> std::vector<std::byte> {
+    auto state = std::vector<std::byte>{};
+    save_state(state, compression);
+    return state;
+}
+auto gameboy_advance::load_state(std::span<std::byte const> const state)
+    -> void {
+    auto reader = state_reader{state};
+    m_scheduler.load_state(reader);
+    m_cpu.load_state(reader);
+    m_ppu.load_state(reader);
+    m_mmu.load_state(reader);
+    reader.expect(state_section::memory);
+    for (u32 region = 1; region < mmu::memory_arena::region_count; ++region) {
+        auto const memory = m_arena.region(region);
+        if (memory.empty()) continue;
+        if (reader.read<u32>() != region) {
+            throw runtime_error{"save state is damaged, memory regions are out of order"};
+        }
+        if (m_load_scratch.size() < memory.size()) m_load_scratch.resize(memory.size());
+        auto const incoming = std::span{m_load_scratch}.first(memory.size());
+        reader.read_block(incoming);
+        // only pages which really differ are copied, blocks compiled from the rest stay valid
+        // and so do lines drawn from them.
+        // region << 24 | offset is the canonical address, which stands for every mirror of it
+        constexpr auto page_size = std::size_t{cpu::block_cache::code_page_size};
+        for (std::size_t page = 0; page < memory.size(); page += page_size) {
+            auto const size = std::min(page_size, memory.size() - page);
+            if (std::memcmp(memory.data() + page, incoming.data() + page, size) == 0) continue;
+            std::memcpy(memory.data() + page, incoming.data() + page, size);
+            m_cpu.invalidate_code(region << 24 | static_cast<u32>(page));
+            m_ppu.note_rewrite(region << 24 | static_cast<u32>(page), static_cast<u32>(size));
+        }
+    }
+    if (not reader.at_end()) {
+        throw runtime_error{"save state has something extra at the end"};
+    }
+}
+
 }
@@ -1,4 +1,4 @@
-#include "io-registers-map.hpp"
+#include "emulator/mmu/io-registers-map.hpp"
 
 #define CASE_BYTE_READ_FOR_B(register)\
 CASE_BYTE_READ_WITH_OFFSET(register, 0)
@@ -12,15 +12,58 @@ CASE_BYTE_READ_WITH_OFFSET(register, 2)\
 CASE_BYTE_READ_WITH_OFFSET(register, 3)
 #define CASE_BYTE_READ_WITH_OFFSET(register, offset)\
 case register##_addr + offset: {return m_ppu.m_##register.read<u8, offset>(); break;}
+#define CASE_BYTE_WRITE_FOR_H(register)\
+CASE_BYTE_WRITE_WITH_OFFSET(register, 0)\
+CASE_BYTE_WRITE_WITH_OFFSET(register, 1)
+#define CASE_BYTE_WRITE_WITH_OFFSET(register, offset)\
+case register##_addr + offset: {m_ppu.m_##register.write_byte<offset>(data); break;}
 
 namespace fgba::mmu {
-template<>
-auto io_registers_map::read<u8>(u32 address) const -> u8{
+auto io_registers_map::read_byte(u32 address) const -> u8{
     switch (address) {
     using namespace ppu;
         CASE_BYTE_READ_FOR_H(dispcnt)
         CASE_BYTE_READ_FOR_H(dispstat)
         CASE_BYTE_READ_FOR_H(vcount)
+        case waitstate_table::waitcnt_addr:     return static_cast<u8>(m_waitstates.waitcnt());
+        case waitstate_table::waitcnt_addr + 1: return static_cast<u8>(m_waitstates.waitcnt() >> 8);
+        case keypad::keyinput_addr:             return static_cast<u8>(m_keypad.keyinput());
+        case keypad::keyinput_addr + 1:         return static_cast<u8>(m_keypad.keyinput() >> 8);
+        case keypad::keycnt_addr:               return static_cast<u8>(m_keypad.keycnt());
+        case keypad::keycnt_addr + 1:           return static_cast<u8>(m_keypad.keycnt() >> 8);
+        default: return 0;
+    }
+}
+auto io_registers_map::write_byte(u32 address, u8 data) -> void {
+    switch (address) {
+    using namespace ppu;
+        CASE_BYTE_WRITE_FOR_H(dispcnt)
+        // status flags are read only, only irq enables go through
+        case dispstat_addr: {
+            constexpr u8 writable = 0b0011'1000;
+            auto const status = m_ppu.m_dispstat.read_byte<0>();
+            m_ppu.m_dispstat.write_byte<0>(static_cast<u8>((status & ~writable) | (data & writable)));
+            break;
+        }
+        CASE_BYTE_WRITE_WITH_OFFSET(dispstat, 1)
+        case waitstate_table::waitcnt_addr: {
+            m_waitstates.set_waitcnt(static_cast<u16>((m_waitstates.waitcnt() & 0xff00) | data));
+            break;
+        }
+        case waitstate_table::waitcnt_addr + 1: {
+            m_waitstates.set_waitcnt(static_cast<u16>((m_waitstates.waitcnt() & 0x00ff) | data << 8));
+            break;
+        }
+        // keyinput is read only
+        case keypad::keycnt_addr: {
+            m_keypad.set_keycnt(static_cast<u16>((m_keypad.keycnt() & 0xff00) | data));
+            break;
+        }
+        case keypad::keycnt_addr + 1: {
+            m_keypad.set_keycnt(static_cast<u16>((m_keypad.keycnt() & 0x00ff) | data << 8));
+            break;
+        }
+        default: break;
     }
 }
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "emulator/mmu/mapped-file.hpp"
+#include "utility/fatexception.hpp"
+#include "fmt/format.h"
+
+#include <fstream>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+#   define FGBA_HAS_MMAP 1
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#else
+#   define FGBA_HAS_MMAP 0
+#endif
+
+namespace fgba::mmu {
+
+#if FGBA_HAS_MMAP
+mapped_file::mapped_file(std::filesystem::path const& path) {
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw runtime_error{fmt::format("couldn't open {}", path.string())};
+    }
+    struct stat info{};
+    auto const stat_result = ::fstat(fd, &info);
+    auto const size = static_cast<std::size_t>(info.st_size);
+    if (stat_result != 0 or size == 0) {
+        ::close(fd);
+        throw runtime_error{fmt::format("{} is empty or unreadable", path.string())};
+    }
+    auto* const mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // mapping keeps the file alive on its own
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw runtime_error{fmt::format("couldn't map {}", path.string())};
+    }
+    m_data = static_cast<std::byte const*>(mapping);
+    m_size = size;
+}
+auto mapped_file::release() noexcept
+    -> void {
+    if (m_data != nullptr) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size); //NOLINT
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+#else
+mapped_file::mapped_file(std::filesystem::path const& path) {
+    auto file = std::ifstream{path, std::ios::binary | std::ios::ate};
+    if (not file) {
+        throw runtime_error{fmt::format("couldn't open {}", path.string())};
+    }
+    auto const size = static_cast<std::size_t>(file.tellg());
+    if (size == 0) {
+        throw runtime_error{fmt::format("{} is empty", path.string())};
+    }
+    // a bit of slack, so a word read at the very end stays inside the buffer like it does with mmap
+    m_buffer = std::make_unique<std::byte[]>(size + 4);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(m_buffer.get()), static_cast<std::streamsize>(size)); //NOLINT
+    m_data = m_buffer.get();
+    m_size = size;
+}
+auto mapped_file::release() noexcept
+    -> void {
+    m_buffer.reset();
+    m_data = nullptr;
+    m_size = 0;
+}
+#endif
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+    : m_data{std::exchange(other.m_data, nullptr)},
+      m_size{std::exchange(other.m_size, 0)},
+      m_buffer{std::move(other.m_buffer)} {}
+auto mapped_file::operator=(mapped_file&& other) noexcept
+    -> mapped_file& {
+    if (this != &other) {
+        release();
+        m_data   = std::exchange(other.m_data, nullptr);
+        m_size   = std::exchange(other.m_size, 0);
+        m_buffer = std::move(other.m_buffer);
+    }
+    return *this;
+}
+mapped_file::~mapped_file() {
+    release();
+}
+
+}
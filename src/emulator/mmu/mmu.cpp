@@ -5,6 +5,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -15,40 +16,221 @@
 
 
 namespace fgba::mmu {
-// constexpr std::array<int, 16> internal_region_mapping{
-//     0, -1, 1, 2, 3, 4, 5, 6, 7, 7, 8, 8, 9, 9, 10, -1 
-// };
-
-// auto get_region_type(address address) 
-//     -> memory_region_type {
-//     using enum memory_region_type;
-//     constexpr std::array<memory_region_type, 16> region_mapping {
-//         sysrom, invalid, ewram, iwram, ioregisters, paletteram, 
-//         vram, oam, flashrom0, flashrom0, flashrom1, flashrom1,
-//         flashrom2, flashrom2, sram, invalid, 
-//     };
-//     return region_mapping[(address >> 24) & 0xf];
-// }
-
-struct bounds {
-    u32 upper;
-    u32 lower;
-};
-
-// constexpr std::array<bounds, 11> boundaries {
-//     bounds{0x00003FFF, 0x00000000}, bounds{0x0203FFFF, 0x02000000}, 
-//     bounds{0x03007FFF, 0x03000000}, bounds{0x040003FE, 0x04000000}, 
-
-//     bounds{0x050003FF, 0x05000000}, bounds{0x06017FFF, 0x06000000}, bounds{0x070003FF, 0x07000000},
-
-//     bounds{0x09FFFFFF, 0x08000000}, bounds{0x0BFFFFFF, 0x0A000000}, 
-//     bounds{0x0DFFFFFF, 0x0C000000}, bounds{0x0E00FFFF, 0x0E000000}
-// };
-
-// auto memory_managment_unit::load_bios(readonlymem_view<> biosbin) 
-//     -> void {
-//     m_bios = readonlymem<0x00000000, 0x00003fff>(biosbin);
-// }
-
-
-}
\ No newline at end of file
+
+namespace {
+
+constexpr u32 io_region   = 0x4;
+constexpr u32 cartridge_first_region = 0x8;
+constexpr u32 cartridge_last_region  = 0xd;
+constexpr u32 sram_region = 0xe;
+constexpr u32 sram_mirror = 0xf;
+
+constexpr auto map_region(page_table& table, u32 region, page page) noexcept
+    -> void {
+    for (u32 subpage = 0; subpage < 4; ++subpage) {
+        table[region << 2 | subpage] = page;
+    }
+}
+template<spec Spec>
+constexpr auto mirrored(std::byte* data) noexcept
+    -> page {
+    static_assert(std::has_single_bit(Spec::bounds::size), "only power of two regions mirror cleanly");
+    return {
+        .data  = data,
+        .mask  = static_cast<u32>(Spec::bounds::size - 1),
+        .limit = static_cast<u32>(Spec::bounds::size),
+    };
+}
+template<typename T>
+[[nodiscard]]constexpr auto replicate(u8 data) noexcept
+    -> T { return static_cast<T>(data * static_cast<T>(0x0101'0101_u32)); }
+
+// nothing answers, so the bus still holds whatever was read last, narrow reads get their lane of it
+template<typename T>
+[[nodiscard]]constexpr auto open_bus(u32 last_read, u32 address) noexcept
+    -> T { return static_cast<T>(last_read >> ((address & 0b11 & ~static_cast<u32>(sizeof(T) - 1)) * 8)); }
+
+// past the end of the cartridge nothing drives the bus, it still holds
+// the address it was given which reads back as address / 2
+template<typename T>
+[[nodiscard]]constexpr auto cartridge_open_bus(u32 address) noexcept
+    -> T {
+    auto const hword_at = [](u32 const at) { return (at >> 1) & 0xffff; };
+    if constexpr (sizeof(T) == 4) {
+        auto const aligned = address & ~0b11u;
+        return static_cast<T>(hword_at(aligned) | hword_at(aligned + 2) << 16);
+    } else if constexpr (sizeof(T) == 2) {
+        return static_cast<T>(hword_at(address & ~0b1u));
+    } else {
+        return static_cast<T>(hword_at(address & ~0b1u) >> ((address & 1) * 8));
+    }
+}
+
+template<spec Spec>
+auto load_file(std::filesystem::path const& path, mem_view<Spec> destination)
+    -> std::size_t {
+    auto file = std::ifstream{path, std::ios::binary | std::ios::ate};
+    if (not file) {
+        throw runtime_error{fmt::format("couldn't open {}", path.string())};
+    }
+    auto const size = static_cast<std::size_t>(file.tellg());
+    if (size > Spec::bounds::size) {
+        throw runtime_error{fmt::format(
+            "{} is {} bytes, but it should fit in {}", path.string(), size, Spec::bounds::size
+        )};
+    }
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(destination.data()), static_cast<std::streamsize>(size)); //NOLINT
+    return size;
+}
+
+} // namespace
+
+memory_managment_unit::memory_managment_unit(ppu::ppu& ppu, memory_arena& arena)
+    : m_bios{arena.claim<bios_spec>()},
+      m_ewram{arena.claim<ewram_spec>()},
+      m_iwram{arena.claim<iwram_spec>()},
+      m_io{ppu, m_waitstates, m_keypad},
+      m_sram{arena.claim<sram_spec>()},
+      m_ppu{ppu} {
+    for (auto* table : {&m_read_pages, &m_write_pages}) {
+        map_region(*table, 0x2, mirrored<ewram_spec>(m_ewram.data()));
+        map_region(*table, 0x3, mirrored<iwram_spec>(m_iwram.data()));
+        map_region(*table, 0x5, mirrored<pram_spec>(ppu.get_pram().data()));
+        map_region(*table, 0x7, mirrored<oam_spec>(ppu.get_oam().data()));
+        // vram is 96KiB mirrored in 128KiB steps, and upper 32KiB of every
+        // mirror are pointing back to the last 32KiB (object tiles)
+        auto* const vram = ppu.get_vram().data();
+        map_region(*table, 0x6, {.data = vram, .mask = 0x1'ffff, .limit = static_cast<u32>(vram_spec::bounds::size)});
+        (*table)[0x6 << 2 | 0b11] = {.data = vram, .mask = 0x1'7fff, .limit = static_cast<u32>(vram_spec::bounds::size)};
+    }
+    for (auto const region : {pram_region, vram_region, oam_region}) {
+        for (u32 subpage = 0; subpage < 4; ++subpage) {
+            m_write_pages[region << 2 | subpage].video = true;
+        }
+    }
+    // everything past 16KiB of bios is not mirrored, it is open bus
+    map_region(m_read_pages, 0x0, {.data = m_bios.data(), .mask = 0x00ff'ffff, .limit = static_cast<u32>(bios_spec::bounds::size)});
+    map_cartridge();
+}
+
+auto memory_managment_unit::map_cartridge() noexcept
+    -> void {
+    // read table is never written through, so pointing it at the read only mapping is fine.
+    // only whole words go through the fast path, whatever is left of an odd sized rom is the slow path's job
+    auto const page = mmu::page{
+        .data  = const_cast<std::byte*>(m_cartridge.data()), //NOLINT
+        .mask  = static_cast<u32>(gprom0_spec::bounds::size - 1),
+        .limit = static_cast<u32>(m_cartridge.size() & ~std::size_t{0b11}),
+    };
+    for (u32 region = cartridge_first_region; region <= cartridge_last_region; ++region) {
+        map_region(m_read_pages, region, page);
+    }
+}
+
+auto memory_managment_unit::load_bios(std::filesystem::path const& path)
+    -> void {
+    load_file(path, m_bios);
+    m_bios_loaded = true;
+}
+auto memory_managment_unit::load_gamerom(std::filesystem::path const& path_to_cartridge)
+    -> void {
+    auto cartridge = mapped_file{path_to_cartridge};
+    if (cartridge.size() > gprom0_spec::bounds::size) {
+        throw runtime_error{fmt::format(
+            "{} is {} bytes, but it should fit in {}", path_to_cartridge.string(), cartridge.size(), gprom0_spec::bounds::size
+        )};
+    }
+    m_cartridge = std::move(cartridge);
+    map_cartridge();
+}
+
+auto memory_managment_unit::save_state(state_writer& state) const
+    -> void {
+    state.section(state_section::mmu);
+    state.write(m_waitstates.waitcnt());
+    state.write(m_keypad);
+    state.write(m_next_sequential);
+    state.write(m_open_bus);
+}
+auto memory_managment_unit::load_state(state_reader& state)
+    -> void {
+    state.expect(state_section::mmu);
+    m_waitstates.set_waitcnt(state.read<u16>());
+    state.read_into(m_keypad);
+    state.read_into(m_next_sequential);
+    state.read_into(m_open_bus);
+}
+
+template<typename T>
+auto memory_managment_unit::read_slow(u32 address) const noexcept
+    -> T {
+    if (address >= address_space_end) return open_bus<T>(m_open_bus, address);
+    switch (address >> 24) {
+        case io_region: {
+            if (address >= io_map_spec::bounds::upper_bound) break;
+            return m_io.read<T>(address & ~static_cast<u32>(sizeof(T) - 1));
+        }
+        case 0x8: case 0x9: case 0xa: case 0xb: case 0xc: case 0xd: {
+            auto const offset = address & (gprom0_spec::bounds::size - 1) & ~static_cast<u32>(sizeof(T) - 1);
+            if (offset + sizeof(T) <= m_cartridge.size()) {
+                T result;
+                std::memcpy(&result, m_cartridge.data() + offset, sizeof(T));
+                return result;
+            }
+            return cartridge_open_bus<T>(address);
+        }
+        // sram sits on the 8 bit bus so wider reads just see the same byte repeated
+        case sram_region:
+        case sram_mirror: {
+            auto const offset = address & (sram_spec::bounds::size - 1);
+            return replicate<T>(std::to_integer<u8>(m_sram.data()[offset]));
+        }
+        default: break;
+    }
+    return open_bus<T>(m_open_bus, address);
+}
+
+template<typename T>
+auto memory_managment_unit::write_slow(u32 address, T data) noexcept
+    -> void {
+    if (address >= address_space_end) return;
+    switch (address >> 24) {
+        case io_region: {
+            if (address >= io_map_spec::bounds::upper_bound) break;
+            m_io.write<T>(address & ~static_cast<u32>(sizeof(T) - 1), data);
+            break;
+        }
+        case sram_region:
+        case sram_mirror: {
+            auto const offset = address & (sram_spec::bounds::size - 1);
+            m_sram.data()[offset] = static_cast<std::byte>(data);
+            break;
+        }
+        // only bytes end up here. palette and background tiles get the byte in both halves
+        // of the halfword, oam and object tiles ignore byte writes altogether
+        case pram_region:
+        case vram_region: {
+            if constexpr (sizeof(T) == 1) {
+                auto const& page  = m_write_pages[page_index(address)];
+                auto const offset = address & page.mask & ~1_u32;
+                if (address >> 24 == vram_region and offset >= m_ppu.obj_tiles_offset()) break;
+                auto const doubled = replicate<u16>(data);
+                std::memcpy(page.data + offset, &doubled, sizeof(doubled));
+                m_ppu.note_write(address);
+            }
+            break;
+        }
+        // writes to bios, rom and unmapped memory go nowhere
+        default: break;
+    }
+}
+
+template auto memory_managment_unit::read_slow<u8>(u32) const noexcept -> u8;
+template auto memory_managment_unit::read_slow<u16>(u32) const noexcept -> u16;
+template auto memory_managment_unit::read_slow<u32>(u32) const noexcept -> u32;
+template auto memory_managment_unit::write_slow<u8>(u32, u8) noexcept -> void;
+template auto memory_managment_unit::write_slow<u16>(u32, u16) noexcept -> void;
+template auto memory_managment_unit::write_slow<u32>(u32, u32) noexcept -> void;
+
+}
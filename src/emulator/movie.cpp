@@ -0,0 +1,118 @@
+#include "emulator/movie.hpp"
+#include "utility/fatexception.hpp"
+#include "utility/hash.hpp"
+#include "fmt/format.h"
+
+#include <fstream>
+#include <type_traits>
+
+namespace fgba {
+namespace {
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+auto put(std::ofstream& file, T const& value)
+    -> void {
+    file.write(reinterpret_cast<char const*>(&value), sizeof(T)); //NOLINT
+}
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+auto get(std::ifstream& file)
+    -> T {
+    auto value = T{};
+    file.read(reinterpret_cast<char*>(&value), sizeof(T)); //NOLINT
+    return value;
+}
+
+} // namespace
+
+auto write_movie(std::filesystem::path const& path, movie const& movie)
+    -> void {
+    auto file = std::ofstream{path, std::ios::binary | std::ios::trunc};
+    if (not file) {
+        throw runtime_error{fmt::format("couldn't open {} for writing", path.string())};
+    }
+    put(file, movie::magic);
+    put(file, movie::version);
+    put(file, movie.bios_hash);
+    put(file, movie.cartridge_hash);
+    put(file, movie.start_checksum);
+    put(file, u64{movie.start_state.size()});
+    file.write(reinterpret_cast<char const*>(movie.start_state.data()), static_cast<std::streamsize>(movie.start_state.size())); //NOLINT
+    put(file, u64{movie.keys.size()});
+    file.write(reinterpret_cast<char const*>(movie.keys.data()), static_cast<std::streamsize>(movie.keys.size() * sizeof(u16))); //NOLINT
+    if (not file) {
+        throw runtime_error{fmt::format("couldn't write {}", path.string())};
+    }
+}
+
+auto read_movie(std::filesystem::path const& path)
+    -> movie {
+    auto file = std::ifstream{path, std::ios::binary | std::ios::ate};
+    if (not file) {
+        throw runtime_error{fmt::format("couldn't open {}", path.string())};
+    }
+    auto const file_size = static_cast<u64>(file.tellg());
+    file.seekg(0);
+    if (get<u64>(file) != movie::magic) {
+        throw runtime_error{fmt::format("{} is not a movie", path.string())};
+    }
+    if (auto const version = get<u32>(file); version != movie::version) {
+        throw runtime_error{fmt::format("{} is a version {} movie, only {} can be played", path.string(), version, movie::version)};
+    }
+    auto result = movie{};
+    result.bios_hash      = get<u64>(file);
+    result.cartridge_hash = get<u64>(file);
+    result.start_checksum = get<u64>(file);
+    // sizes are checked against the file before anything is allocated for them
+    auto const state_size = get<u64>(file);
+    if (not file or state_size > file_size) {
+        throw runtime_error{fmt::format("{} is damaged", path.string())};
+    }
+    result.start_state.resize(state_size);
+    file.read(reinterpret_cast<char*>(result.start_state.data()), static_cast<std::streamsize>(state_size)); //NOLINT
+    auto const frames = get<u64>(file);
+    if (not file or frames > file_size / sizeof(u16)) {
+        throw runtime_error{fmt::format("{} is damaged", path.string())};
+    }
+    result.keys.resize(frames);
+    file.read(reinterpret_cast<char*>(result.keys.data()), static_cast<std::streamsize>(frames * sizeof(u16))); //NOLINT
+    if (not file) {
+        throw runtime_error{fmt::format("{} ends too early", path.string())};
+    }
+    return result;
+}
+
+auto start_movie(gameboy_advance const& gba)
+    -> movie {
+    auto result = movie{};
+    result.bios_hash      = hash_bytes(gba.loaded_bios());
+    result.cartridge_hash = hash_bytes(gba.loaded_cartridge());
+    gba.save_state(result.start_state, save_compression::zero_runs);
+    auto scratch = std::vector<std::byte>{};
+    result.start_checksum = state_checksum(gba, scratch);
+    return result;
+}
+
+auto start_replay(gameboy_advance& gba, movie const& movie)
+    -> void {
+    if (hash_bytes(gba.loaded_cartridge()) != movie.cartridge_hash) {
+        throw runtime_error{"movie was recorded with a different cartridge"};
+    }
+    if (hash_bytes(gba.loaded_bios()) != movie.bios_hash) {
+        throw runtime_error{gba.loaded_bios().empty() ? "movie was recorded with a bios, but none is loaded" : "movie was recorded with a different bios"};
+    }
+    gba.load_state(movie.start_state);
+    auto scratch = std::vector<std::byte>{};
+    if (state_checksum(gba, scratch) != movie.start_checksum) {
+        throw runtime_error{"movie doesn't start where it was recorded, it must be from another build of the emulator"};
+    }
+}
+
+auto state_checksum(gameboy_advance const& gba, std::vector<std::byte>& scratch)
+    -> u64 {
+    gba.save_state(scratch);
+    return hash_bytes(scratch);
+}
+
+}
@@ -0,0 +1,61 @@
+// the only translation unit built with -mavx2, nothing in here runs before the cpu is checked for it
+#include "emulator/ppu/color-conversion.hpp"
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace fgba::ppu {
+
+namespace {
+
+#include "color-kernels.inl"
+
+struct avx2 {
+    using vec = __m256i;
+    static constexpr std::size_t lanes = 16;
+    struct vec_pair { vec first; vec second; };
+
+    FGBA_FORCE_INLINE static auto load(std::byte const* source) noexcept
+        -> vec { return _mm256_loadu_si256(reinterpret_cast<vec const*>(source)); } //NOLINT
+    FGBA_FORCE_INLINE static auto store(std::byte* destination, vec const data) noexcept
+        -> void { _mm256_storeu_si256(reinterpret_cast<vec*>(destination), data); } //NOLINT
+    FGBA_FORCE_INLINE static auto store_rgb(std::byte* destination, vec const pixels) noexcept
+        -> void {
+        store_rgb_12(destination,      _mm256_castsi256_si128(pixels));
+        store_rgb_12(destination + 12, _mm256_extracti128_si256(pixels, 1));
+    }
+    FGBA_FORCE_INLINE static auto splat(u16 const value) noexcept
+        -> vec { return _mm256_set1_epi16(static_cast<short>(value)); }
+    FGBA_FORCE_INLINE static auto and_(vec const lhs, vec const rhs) noexcept
+        -> vec { return _mm256_and_si256(lhs, rhs); }
+    FGBA_FORCE_INLINE static auto or_(vec const lhs, vec const rhs) noexcept
+        -> vec { return _mm256_or_si256(lhs, rhs); }
+    template<int Amount>
+    FGBA_FORCE_INLINE static auto shl(vec const data) noexcept
+        -> vec { return _mm256_slli_epi16(data, Amount); }
+    template<int Amount>
+    FGBA_FORCE_INLINE static auto shr(vec const data) noexcept
+        -> vec { return _mm256_srli_epi16(data, Amount); }
+    // unpacks work within 128 bit lanes, so pixels come out as 0-3, 8-11 and 4-7, 12-15
+    FGBA_FORCE_INLINE static auto interleave(vec const low, vec const high) noexcept
+        -> vec_pair {
+        auto const first  = _mm256_unpacklo_epi16(low, high);
+        auto const second = _mm256_unpackhi_epi16(low, high);
+        return {
+            _mm256_permute2x128_si256(first, second, 0x20),
+            _mm256_permute2x128_si256(first, second, 0x31),
+        };
+    }
+};
+
+} // namespace
+
+auto detail::avx2_conversion(pixel_format const format) noexcept
+    -> conversion_ptr {
+    return simd_kernel<avx2>(format);
+}
+
+} // namespace fgba::ppu
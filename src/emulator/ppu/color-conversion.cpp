@@ -0,0 +1,114 @@
+#include "emulator/ppu/color-conversion.hpp"
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+#ifdef FGBA_PPU_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace fgba::ppu {
+
+namespace {
+
+#include "color-kernels.inl"
+
+#ifdef FGBA_PPU_X86_KERNELS
+
+// sse2 is part of x86-64, so it is always there
+struct sse2 {
+    using vec = __m128i;
+    static constexpr std::size_t lanes = 8;
+    struct vec_pair { vec first; vec second; };
+
+    FGBA_FORCE_INLINE static auto load(std::byte const* source) noexcept
+        -> vec { return _mm_loadu_si128(reinterpret_cast<vec const*>(source)); } //NOLINT
+    FGBA_FORCE_INLINE static auto store(std::byte* destination, vec const data) noexcept
+        -> void { _mm_storeu_si128(reinterpret_cast<vec*>(destination), data); } //NOLINT
+    FGBA_FORCE_INLINE static auto store_rgb(std::byte* destination, vec const pixels) noexcept
+        -> void { store_rgb_12(destination, pixels); }
+    FGBA_FORCE_INLINE static auto splat(u16 const value) noexcept
+        -> vec { return _mm_set1_epi16(static_cast<short>(value)); }
+    FGBA_FORCE_INLINE static auto and_(vec const lhs, vec const rhs) noexcept
+        -> vec { return _mm_and_si128(lhs, rhs); }
+    FGBA_FORCE_INLINE static auto or_(vec const lhs, vec const rhs) noexcept
+        -> vec { return _mm_or_si128(lhs, rhs); }
+    template<int Amount>
+    FGBA_FORCE_INLINE static auto shl(vec const data) noexcept
+        -> vec { return _mm_slli_epi16(data, Amount); }
+    template<int Amount>
+    FGBA_FORCE_INLINE static auto shr(vec const data) noexcept
+        -> vec { return _mm_srli_epi16(data, Amount); }
+    FGBA_FORCE_INLINE static auto interleave(vec const low, vec const high) noexcept
+        -> vec_pair { return {_mm_unpacklo_epi16(low, high), _mm_unpackhi_epi16(low, high)}; }
+};
+
+#endif
+
+[[nodiscard]]constexpr auto scalar_kernel(pixel_format const format) noexcept
+    -> detail::conversion_ptr {
+    switch (format) {
+        case pixel_format::rgb888:   return convert_scalar<pixel_format::rgb888>;
+        case pixel_format::rgba8888: return convert_scalar<pixel_format::rgba8888>;
+        case pixel_format::bgra8888: return convert_scalar<pixel_format::bgra8888>;
+        case pixel_format::rgb565:   return convert_scalar<pixel_format::rgb565>;
+        default:                     return convert_scalar<pixel_format::bgr555>;
+    }
+}
+
+[[nodiscard]]auto kernel_for(conversion_kernel const kernel, pixel_format const format) noexcept
+    -> detail::conversion_ptr {
+    switch (kernel) {
+#ifdef FGBA_PPU_X86_KERNELS
+        case conversion_kernel::sse2: return simd_kernel<sse2>(format);
+        case conversion_kernel::avx2: return detail::avx2_conversion(format);
+#endif
+        default: return scalar_kernel(format);
+    }
+}
+
+} // namespace
+
+auto is_supported(conversion_kernel const kernel) noexcept
+    -> bool {
+    switch (kernel) {
+#ifdef FGBA_PPU_X86_KERNELS
+        case conversion_kernel::sse2: return true;
+        case conversion_kernel::avx2: return __builtin_cpu_supports("avx2") != 0;
+#endif
+        case conversion_kernel::scalar: return true;
+        default: return false;
+    }
+}
+
+auto best_conversion_kernel() noexcept
+    -> conversion_kernel {
+    static auto const best = [] {
+        for (auto kernel : {conversion_kernel::avx2, conversion_kernel::sse2}) {
+            if (is_supported(kernel)) return kernel;
+        }
+        return conversion_kernel::scalar;
+    }();
+    return best;
+}
+
+auto convert_bgr555(conversion_kernel const kernel, pixel_format const format, std::span<std::byte const> const source, std::byte* const destination) noexcept
+    -> void {
+    kernel_for(kernel, format)(source.data(), source.size() / 2, destination);
+}
+auto convert_bgr555(pixel_format const format, std::span<std::byte const> const source, std::byte* const destination) noexcept
+    -> void {
+    static auto const kernels = [] {
+        std::array<detail::conversion_ptr, std::to_underlying(pixel_format::count)> ret{};
+        for (std::size_t i = 0; i < ret.size(); ++i) {
+            ret[i] = kernel_for(best_conversion_kernel(), static_cast<pixel_format>(i));
+        }
+        return ret;
+    }();
+    kernels[std::to_underlying(format)](source.data(), source.size() / 2, destination);
+}
+
+} // namespace fgba::ppu
@@ -0,0 +1,118 @@
+// Color conversion kernels shared by every instruction set.
+//
+// It is included inside of an anonymous namespace by each color conversion translation unit,
+// they are built with different instruction sets enabled, so none of this may become a shared symbol.
+// Simd kernels are written against a tiny ops struct which each translation unit provides.
+
+template<pixel_format Format>
+auto convert_scalar(std::byte const* source, std::size_t const count, std::byte* destination) noexcept
+    -> void {
+    if constexpr (Format == pixel_format::bgr555) {
+        std::memcpy(destination, source, count * 2);
+    } else {
+        constexpr auto size = bytes_per_pixel(Format);
+        for (std::size_t i = 0; i < count; ++i) {
+            u16 color;
+            std::memcpy(&color, source + 2 * i, sizeof(color));
+            u32 const red   = color & 0x1f;
+            u32 const green = (color >> 5) & 0x1f;
+            u32 const blue  = (color >> 10) & 0x1f;
+            auto* const out = destination + size * i;
+            // 5 bit channels are just shifted up, this is what the ppu always did
+            if constexpr (Format == pixel_format::rgb565) {
+                auto const pixel = static_cast<u16>(red << 11 | green << 6 | blue);
+                std::memcpy(out, &pixel, sizeof(pixel));
+            } else if constexpr (Format == pixel_format::bgra8888) {
+                out[0] = static_cast<std::byte>(blue << 3);
+                out[1] = static_cast<std::byte>(green << 3);
+                out[2] = static_cast<std::byte>(red << 3);
+                out[3] = std::byte{0xff};
+            } else {
+                out[0] = static_cast<std::byte>(red << 3);
+                out[1] = static_cast<std::byte>(green << 3);
+                out[2] = static_cast<std::byte>(blue << 3);
+                if constexpr (size == 4) out[3] = std::byte{0xff};
+            }
+        }
+    }
+}
+
+template<typename Ops, pixel_format Format>
+auto convert_simd(std::byte const* source, std::size_t const count, std::byte* destination) noexcept
+    -> void {
+    constexpr auto step = Ops::lanes;
+    constexpr auto size = bytes_per_pixel(Format);
+    std::size_t i = 0;
+    for (; i + step <= count; i += step) {
+        auto const colors = Ops::load(source + 2 * i);
+        auto const red    = Ops::and_(colors, Ops::splat(0x1f));
+        auto const green  = Ops::and_(Ops::template shr<5>(colors), Ops::splat(0x1f));
+        auto const blue   = Ops::and_(Ops::template shr<10>(colors), Ops::splat(0x1f));
+        auto* const out   = destination + size * i;
+        if constexpr (Format == pixel_format::rgb565) {
+            Ops::store(out, Ops::or_(Ops::or_(Ops::template shl<11>(red), Ops::template shl<6>(green)), blue));
+        } else {
+            // every 16 bit lane holds two channels, interleaving two of those gives whole pixels
+            auto const channels = [](auto low, auto high) {
+                return Ops::or_(Ops::template shl<3>(low), Ops::template shl<11>(high));
+            };
+            auto const opaque = [](auto low) {
+                return Ops::or_(Ops::template shl<3>(low), Ops::splat(0xff00));
+            };
+            auto const [first, second] = [&] {
+                if constexpr (Format == pixel_format::bgra8888) {
+                    return Ops::interleave(channels(blue, green), opaque(red));
+                } else {
+                    return Ops::interleave(channels(red, green), opaque(blue));
+                }
+            }();
+            if constexpr (Format == pixel_format::rgb888) {
+                Ops::store_rgb(out, first);
+                Ops::store_rgb(out + 3 * step / 2, second);
+            } else {
+                Ops::store(out, first);
+                Ops::store(out + 4 * step / 2, second);
+            }
+        }
+    }
+    convert_scalar<Format>(source + 2 * i, count - i, destination + size * i);
+}
+
+template<typename Ops>
+[[nodiscard]]constexpr auto simd_kernel(pixel_format const format) noexcept
+    -> detail::conversion_ptr {
+    switch (format) {
+        case pixel_format::rgb888:   return convert_simd<Ops, pixel_format::rgb888>;
+        case pixel_format::rgba8888: return convert_simd<Ops, pixel_format::rgba8888>;
+        case pixel_format::bgra8888: return convert_simd<Ops, pixel_format::bgra8888>;
+        case pixel_format::rgb565:   return convert_simd<Ops, pixel_format::rgb565>;
+        // nothing to convert, copy is as fast as it gets
+        default:                     return convert_scalar<pixel_format::bgr555>;
+    }
+}
+
+#ifdef FGBA_PPU_X86_KERNELS
+
+// squeezes 4 rgb0 pixels into the low 12 bytes, sse2 has no byte shuffle so it is done with shifts
+FGBA_FORCE_INLINE inline auto pack_rgb(__m128i const pixels) noexcept
+    -> __m128i {
+    auto const odd_down = _mm_srli_epi64(pixels, 8);
+    auto const halves   = _mm_or_si128(
+        _mm_and_si128(pixels,   _mm_set1_epi64x(0x0000'0000'00ff'ffff)),
+        _mm_and_si128(odd_down, _mm_set1_epi64x(0x0000'ffff'ff00'0000))
+    );
+    return _mm_or_si128(
+        _mm_and_si128(halves, _mm_set_epi64x(0, 0x0000'ffff'ffff'ffff)),
+        _mm_slli_si128(_mm_srli_si128(halves, 8), 6)
+    );
+}
+// exactly 12 bytes, so the last pixels of the frame don't spill over
+FGBA_FORCE_INLINE inline auto store_rgb_12(std::byte* destination, __m128i const pixels) noexcept
+    -> void {
+    auto const packed = pack_rgb(pixels);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(destination), packed); //NOLINT
+    auto const tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+    std::memcpy(destination + 8, &tail, sizeof(tail));
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "emulator/ppu/ppu.hpp"
+#include "emulator/ppu/color-conversion.hpp"
 #include "emulator/cpudefines.hpp"
+#include <array>
 #include <ranges>
 #include <bit>
 #include <cstddef>
@@ -9,52 +11,212 @@
 namespace fgba {
 namespace  {
 
-struct color {
-    std::byte red;
-    std::byte green;
-    std::byte blue;
-};
-static_assert(alignof(color) == 1);
-[[nodiscard]] constexpr auto gbacolor_to_rgb(u16 color16) 
-    -> color {
-    return {
-        .red   = static_cast<std::byte>(8 * (color16 & 0x1f)),
-        .green = static_cast<std::byte>(8 * ((color16 >> 5) & 0x1f)),
-        .blue  = static_cast<std::byte>(8 * ((color16 >> 10)& 0x1f)),
-    };
-}
+constexpr u16 white = 0x7fff;
+// bg mode, frame select, forced blank and bg2 enable, nothing else matters for bitmap modes
+constexpr u16 relevant_dispcnt_bits = 0b0000'0100'1001'0111;
+constexpr u32 back_frame_offset     = 0xa000;
+constexpr u32 vblank_start          = ppu::screen_height;
+constexpr u32 vblank_end            = ppu::lines_per_frame - 1;
 
 } // anonymous namesapace
 
 namespace ppu {
-ppu::ppu() {
-    auto vram_view = std::span{m_vram};
-    size_t counter = 0;
-    unsigned color_offset = 0;
-    for (size_t i = 0; i < 160; ++i) {
-        for (size_t j = 0; j < 240; ++j) {
-            m_display[i*240*3 + j*3 +0] = static_cast<std::byte>(color_offset);
-            m_display[i*240*3 + j*3 +1] = static_cast<std::byte>(color_offset);
-            m_display[i*240*3 + j*3 +2] = static_cast<std::byte>(color_offset);
-        }
-        color_offset += 1;
+ppu::ppu(scheduler& scheduler, mmu::memory_arena& arena)
+    : m_scheduler{&scheduler},
+      m_vram{arena.claim<vram_spec>()},
+      m_pram{arena.claim<pram_spec>()},
+      m_oam{arena.claim<oam_spec>()} {
+    m_scheduler->set_handler(event_type::ppu_hblank, on_hblank, this);
+    m_scheduler->set_handler(event_type::ppu_line_end, on_line_end, this);
+    m_scheduler->schedule_in(event_type::ppu_hblank, hdraw_cycles);
+    // gradient until something is drawn, so it is obvious the display is alive
+    for (u32 line = 0; line < screen_height; ++line) {
+        auto const shade = static_cast<u16>(line * 0x1f / (screen_height - 1));
+        fill(line, 0, static_cast<u16>(shade | shade << 5 | shade << 10));
     }
+    publish_frame();
 }
 
 auto ppu::get_display_view() const noexcept
     -> lcd_display_view {
-    return lcd_display_view{m_display.data()};
+    return {
+        .rows   = lcd_rows_view{m_display.data(), lcd_width * bytes_per_pixel(m_format)},
+        .format = m_format,
+    };
+}
+
+auto ppu::set_pixel_format(pixel_format const format) noexcept
+    -> void {
+    m_format = format;
+    for (auto& state : m_lines) {
+        state.drawn_at = 0;
+    }
+}
+
+auto ppu::save_state(state_writer& state) const
+    -> void {
+    state.section(state_section::ppu);
+    state.write(m_dispcnt);
+    state.write(m_dispstat);
+    state.write(m_vcount);
+    state.write(m_frame_count);
+}
+auto ppu::load_state(state_reader& state)
+    -> void {
+    state.expect(state_section::ppu);
+    state.read_into(m_dispcnt);
+    state.read_into(m_dispstat);
+    state.read_into(m_vcount);
+    state.read_into(m_frame_count);
+    // lines are left alone, whoever puts memory back reports what changed through note_rewrite
+    // and the rest of them still look the same
+}
+
+auto ppu::on_hblank(void* const self, u64 const deadline) noexcept
+    -> void {
+    auto& ppu = *static_cast<class ppu*>(self);
+    ppu.enter_hblank();
+    ppu.m_scheduler->schedule_at(event_type::ppu_line_end, deadline + hblank_cycles);
+}
+auto ppu::on_line_end(void* const self, u64 const deadline) noexcept
+    -> void {
+    auto& ppu = *static_cast<class ppu*>(self);
+    ppu.next_line();
+    ppu.m_scheduler->schedule_at(event_type::ppu_hblank, deadline + hdraw_cycles);
+}
+
+// dispstat only keeps the irq enable bits, hblank, vblank and vcount irqs wait for irq delivery to exist
+auto ppu::enter_hblank() noexcept
+    -> void {
+    m_dispstat.f_hblank = 1;
+    if (m_vcount.current_scanline < screen_height) {
+        render_line(m_vcount.current_scanline);
+    }
+}
+auto ppu::next_line() noexcept
+    -> void {
+    ++m_line_clock;
+    auto const line = (m_vcount.current_scanline + 1u) % lines_per_frame;
+    m_vcount.current_scanline = static_cast<u16>(line);
+    m_dispstat.f_hblank       = 0;
+    if (line == vblank_start) {
+        m_dispstat.f_vblank = 1;
+        publish_frame();
+    }
+    if (line == vblank_end)   m_dispstat.f_vblank = 0;
+    m_dispstat.f_vcounter = line == m_dispstat.vcount_setting ? 1 : 0;
+}
+
+auto ppu::publish_frame() noexcept
+    -> void {
+    // frames nobody sees still happened, states have to count them
+    auto const number = m_frame_count++;
+    if (not m_publishing) return;
+    // lines are only redrawn when they change, so the working copy stays here
+    // and the finished frame is copied out instead of swapped
+    auto& frame  = m_frames->back();
+    frame.format = m_format;
+    frame.number = number;
+    std::memcpy(frame.pixels.data(), m_display.data(), frame.size_bytes());
+    m_frames->publish();
+}
+
+auto ppu::inputs_of(u32 const line) const noexcept
+    -> line_inputs {
+    auto const control = static_cast<u16>(std::bit_cast<u16>(m_dispcnt) & relevant_dispcnt_bits);
+    if (m_dispcnt.forced_blank != 0) {
+        return {.vram_begin = 0, .vram_end = 0, .control = control, .uses_palette = false};
+    }
+    auto const frame = m_dispcnt.frame != 0 ? back_frame_offset : 0;
+    auto const bg2   = m_dispcnt.screen_display_bg2 != 0;
+    switch (bg2 ? m_dispcnt.bg_mode : 0u) {
+        case 3: {
+            auto const begin = line * screen_width * 2;
+            return {.vram_begin = begin, .vram_end = begin + screen_width * 2, .control = control, .uses_palette = false};
+        }
+        case 4: {
+            auto const begin = frame + line * screen_width;
+            return {.vram_begin = begin, .vram_end = begin + screen_width, .control = control, .uses_palette = true};
+        }
+        case 5: {
+            if (line >= 128) break;
+            auto const begin = frame + line * 160 * 2;
+            return {.vram_begin = begin, .vram_end = begin + 160 * 2, .control = control, .uses_palette = true};
+        }
+        default: break;
+    }
+    // whatever is left only shows backdrop for now
+    return {.vram_begin = 0, .vram_end = 0, .control = control, .uses_palette = true};
+}
+
+auto ppu::is_dirty(u32 const line, line_inputs const& inputs) const noexcept
+    -> bool {
+    auto const& state = m_lines[line];
+    if (state.drawn_at == 0 or state.control != inputs.control) return true;
+    if (inputs.uses_palette and m_pram_stamp >= state.drawn_at) return true;
+    auto const first = inputs.vram_begin / vram_block_size;
+    auto const last  = (inputs.vram_end + vram_block_size - 1) / vram_block_size;
+    for (auto block = first; block < last; ++block) {
+        if (m_vram_stamps[block] >= state.drawn_at) return true;
+    }
+    return false;
+}
+
+auto ppu::render_line(u32 const line) noexcept
+    -> void {
+    auto const inputs = inputs_of(line);
+    if (not is_dirty(line, inputs)) return;
+    m_lines[line] = {.drawn_at = m_line_clock, .control = inputs.control};
+
+    auto const backdrop = mmu::read<u16>(m_pram, 0);
+    if (m_dispcnt.forced_blank != 0) {
+        fill(line, 0, white);
+        return;
+    }
+    switch (m_dispcnt.screen_display_bg2 != 0 ? m_dispcnt.bg_mode : 0u) {
+        case 3:
+            draw_bitmap(line, inputs.vram_begin, screen_width);
+            break;
+        case 4:
+            draw_paletted(line, inputs.vram_begin);
+            break;
+        case 5:
+            if (line >= 128) {
+                fill(line, 0, backdrop);
+                break;
+            }
+            draw_bitmap(line, inputs.vram_begin, 160);
+            fill(line, 160, backdrop);
+            break;
+        default:
+            fill(line, 0, backdrop);
+            break;
+    }
+}
+
+auto ppu::draw_bitmap(u32 const line, u32 const vram_offset, u32 const width) noexcept
+    -> void {
+    auto const source = std::span{m_vram}.subspan(vram_offset, width * 2);
+    convert_bgr555(m_format, source, line_pixels(line));
+}
+auto ppu::draw_paletted(u32 const line, u32 const vram_offset) noexcept
+    -> void {
+    // look colors up first so the whole line can be converted in one go
+    auto colors = std::array<std::byte, screen_width * 2>{};
+    for (u32 x = 0; x < screen_width; ++x) {
+        auto const index = std::to_integer<u32>(m_vram.data()[vram_offset + x]);
+        std::memcpy(colors.data() + x * 2, m_pram.data() + index * 2, 2);
+    }
+    convert_bgr555(m_format, colors, line_pixels(line));
 }
-auto ppu::mode3() noexcept
+auto ppu::fill(u32 const line, u32 const from, u16 const color) noexcept
     -> void {
-    auto bitmap_view = std::span<std::byte, 0x14000>{m_vram};
-    //Just for now
-    for (u32 i = 0; i < bitmap_view.size(); i += 2) {
-        auto [red, green, blue] = gbacolor_to_rgb(mmu::read<u16>(bitmap_view, i));
-        m_display[3 * i]     = red;
-        m_display[3 * i + 1] = green;
-        m_display[3 * i + 2] = blue;
+    auto colors = std::array<std::byte, screen_width * 2>{};
+    for (u32 x = from; x < screen_width; ++x) {
+        std::memcpy(colors.data() + x * 2, &color, sizeof(color));
     }
+    auto const source = std::span{colors}.subspan(from * 2);
+    convert_bgr555(m_format, source, line_pixels(line) + from * bytes_per_pixel(m_format));
 }
 } // namespace ppu
 
@@ -6,8 +6,10 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include "spdlog/spdlog.h"
+#include <algorithm>
 #include <cstdint>
 #include <mutex>
+#include <string>
 
 namespace fgba::gui {
 
@@ -95,7 +97,7 @@ frame::~frame() {
     glfwSwapBuffers(m_window);
 }
 
-auto draw_main_gui(gameboy_advance &gba, display const& disp) -> void {
+auto draw_main_gui(emulation_thread& emu, display& disp) -> void {
      #ifdef IMGUI_HAS_VIEWPORT
     ImGuiViewport* viewport = ImGui::GetMainViewport();
     ImGui::SetNextWindowPos(viewport->GetWorkPos());
@@ -137,6 +139,7 @@ auto draw_main_gui(gameboy_advance &gba, display const& disp) -> void {
             ImGui::MenuItem("Paste", "Cmd+V", &display_cpu_data);
             ImGui::EndMenu();
         } 
+        draw_emulation_menu(emu);
         if (ImGui::BeginMenu("Tools")) {
             ImGui::MenuItem("cpu data", nullptr, &display_cpu_data);
             ImGui::EndMenu();
@@ -151,7 +154,10 @@ auto draw_main_gui(gameboy_advance &gba, display const& disp) -> void {
         } 
         ImGui::EndMenuBar();
         if (display_cpu_data) {
-            draw_cpu_registers_dump(gba.dump_cpu_state().get_regitsters_contents());
+            // emulator keeps running, so this is the state at the end of the last frame
+            auto& snapshots = emu.get_cpu_snapshots();
+            snapshots.acquire();
+            draw_cpu_registers_dump(snapshots.front());
         }
         ImGui::BeginChild("##");
         // ImGui::ShowDemoWindow();
@@ -162,7 +168,58 @@ auto draw_main_gui(gameboy_advance &gba, display const& disp) -> void {
     ImGui::PopStyleVar();
 }
 
-auto draw_emu_display(display const& disp) -> void {
+auto draw_emulation_menu(emulation_thread& emu) -> void {
+    using enum emulation_thread::command_type;
+    if (ImGui::BeginMenu("Emulation")) {
+        auto const running = emu.is_running();
+        if (ImGui::MenuItem(running ? "Pause" : "Run")) {
+            emu.post({.type = running ? pause : resume, .argument = 0});
+        }
+        if (ImGui::MenuItem("Step frame", nullptr, false, not running)) {
+            emu.post({.type = step_frame, .argument = 0});
+        }
+        ImGui::Separator();
+        if (ImGui::MenuItem("Reset")) {
+            emu.post({.type = reset, .argument = 0});
+        }
+        if (ImGui::MenuItem("Reset skipping bios")) {
+            emu.post({.type = reset, .argument = 1});
+        }
+        ImGui::Separator();
+        if (ImGui::BeginMenu("Run ahead")) {
+            auto const current = emu.get_run_ahead();
+            for (u32 frames = 0; frames <= 3; ++frames) {
+                auto const label = frames == 0 ? std::string{"Off"} : fmt::format("{} frame{}", frames, frames == 1 ? "" : "s");
+                if (ImGui::MenuItem(label.c_str(), nullptr, current == frames)) {
+                    emu.post({.type = set_run_ahead, .argument = frames});
+                }
+            }
+            ImGui::EndMenu();
+        }
+        if (ImGui::MenuItem("Rewind a second")) {
+            auto const interval = std::max(emu.get_rewind_config().interval, 1u);
+            emu.post({.type = rewind, .argument = (60 + interval - 1) / interval});
+        }
+        for (auto const [label, type] : {std::pair{"Save state", save_state}, std::pair{"Load state", load_state}}) {
+            if (ImGui::BeginMenu(label)) {
+                for (u32 slot = 0; slot < emulation_thread::state_slot_count; ++slot) {
+                    if (ImGui::MenuItem(fmt::format("Slot {}", slot + 1).c_str())) {
+                        emu.post({.type = type, .argument = slot});
+                    }
+                }
+                ImGui::EndMenu();
+            }
+        }
+        ImGui::Separator();
+        auto const recording = emu.is_recording();
+        if (ImGui::MenuItem(recording ? "Stop recording" : "Start recording")) {
+            emu.post({.type = recording ? stop_recording : start_recording, .argument = 0});
+        }
+        ImGui::EndMenu();
+    }
+}
+
+auto draw_emu_display(display& disp) -> void {
     ImGuiWindowFlags const display_window_f =
          ImGuiWindowFlags_NoResize
         |ImGuiWindowFlags_NoCollapse
@@ -1,53 +1,116 @@
 #include "gui/display.hpp"
 #include "emulator/cpudefines.hpp"
 #include "glad/gl.h"
+#include <cstring>
 #include <expected>
 
 namespace fgba::gui {
 
-display::display(lcd_display_view view) noexcept
-    : m_view{view} {
+auto display::gl_format_of(pixel_format const format) noexcept
+    -> gl_format {
+    switch (format) {
+        case pixel_format::rgb888:
+            return {GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 1};
+        case pixel_format::rgba8888:
+            return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4};
+        // bytes b, g, r, a in memory, drivers usually upload this without a conversion pass
+        case pixel_format::bgra8888:
+            return {GL_RGBA8, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, 4};
+        case pixel_format::rgb565:
+            return {GL_RGB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2};
+        // gba colors as they are, top bit ends up in alpha and alpha is never looked at
+        case pixel_format::bgr555:
+        default:
+            return {GL_RGB5, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, 2};
+    }
+}
+
+display::display(lcd_frame_mailbox& frames) noexcept
+    : m_frames{&frames},
+      m_pixel_format{pixel_format::bgra8888},
+      m_format{gl_format_of(m_pixel_format)} {
     glGenTextures(1, &m_texture_id);
     glBindTexture(GL_TEXTURE_2D, m_texture_id);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
+    // it is shown 1:1, mipmaps would have to be regenerated every frame for nothing
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-    
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 
-        // 240,
-        // 160,
-        static_cast<int>(m_view.extent(1)), // cast away the warning just as god inteneded
-        static_cast<int>(m_view.extent(2)), // jokes aside it is fine since display is 240x160
-        0, GL_RGB, GL_UNSIGNED_BYTE, m_view.data_handle()
-    );
-    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    allocate_texture(m_pixel_format);
+
+    glGenBuffers(static_cast<GLsizei>(m_upload_buffers.size()), m_upload_buffers.data());
 }
 display::display(display&& other) noexcept
-    : m_view{other.m_view}, m_texture_id{other.m_texture_id} {
+    : m_frames{other.m_frames},
+      m_pixel_format{other.m_pixel_format},
+      m_format{other.m_format},
+      m_texture_id{other.m_texture_id},
+      m_upload_buffers{other.m_upload_buffers},
+      m_next_upload_buffer{other.m_next_upload_buffer} {
     other.m_texture_id = 0;
+    other.m_upload_buffers = {};
 } 
 auto display::operator=(display&& other) noexcept
     -> display& {
-    m_view = other.m_view;
+    glDeleteTextures(1, &m_texture_id);
+    glDeleteBuffers(static_cast<GLsizei>(m_upload_buffers.size()), m_upload_buffers.data());
+    m_frames = other.m_frames;
+    m_pixel_format = other.m_pixel_format;
+    m_format = other.m_format;
     m_texture_id = other.m_texture_id;
+    m_upload_buffers = other.m_upload_buffers;
+    m_next_upload_buffer = other.m_next_upload_buffer;
     other.m_texture_id = 0;
+    other.m_upload_buffers = {};
 
     return *this;
 }
 display::~display() {
     glDeleteTextures(1, &m_texture_id);
+    glDeleteBuffers(static_cast<GLsizei>(m_upload_buffers.size()), m_upload_buffers.data());
 }
-auto display::update() const noexcept
+auto display::allocate_texture(pixel_format const format) noexcept
     -> void {
+    m_pixel_format = format;
+    m_format = gl_format_of(format);
     glBindTexture(GL_TEXTURE_2D, m_texture_id);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 
-        static_cast<int>(m_view.extent(1)), 
-        static_cast<int>(m_view.extent(2)), 
-        GL_RGB, GL_UNSIGNED_BYTE, m_view.data_handle()
+    glTexImage2D(GL_TEXTURE_2D, 0, m_format.internal_format,
+        static_cast<int>(lcd_width),
+        static_cast<int>(lcd_height),
+        0, m_format.format, m_format.type, nullptr
+    );
+}
+auto display::update() noexcept
+    -> void {
+    if (not m_frames->acquire()) return;
+    auto const& frame = m_frames->front();
+    if (frame.format != m_pixel_format) allocate_texture(frame.format);
+
+    auto const size = static_cast<GLsizeiptr>(frame.size_bytes());
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_upload_buffers[m_next_upload_buffer]);
+    m_next_upload_buffer = (m_next_upload_buffer + 1) % m_upload_buffers.size();
+    // orphaning the old storage lets the driver hand out a fresh one
+    // instead of blocking until the previous upload from this buffer is done
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    auto* const mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
     );
+    if (mapped != nullptr) {
+        std::memcpy(mapped, frame.pixels.data(), frame.size_bytes());
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        // with an unpack buffer bound the pointer is an offset into it,
+        // so the copy into the texture happens on the gpu timeline
+        glBindTexture(GL_TEXTURE_2D, m_texture_id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, m_format.unpack_alignment);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
+            static_cast<int>(lcd_width),
+            static_cast<int>(lcd_height),
+            m_format.format, m_format.type, nullptr
+        );
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
 auto display::get_handle() const noexcept
@@ -0,0 +1,30 @@
+#include "gui/keyboard.hpp"
+#include "emulator/mmu/keypad.hpp"
+
+#include <array>
+#include <utility>
+
+namespace fgba::gui {
+
+auto read_keypad(GLFWwindow* window) noexcept
+    -> u16 {
+    static constexpr auto bindings = std::array{
+        std::pair{GLFW_KEY_X,         key::a},
+        std::pair{GLFW_KEY_Z,         key::b},
+        std::pair{GLFW_KEY_BACKSPACE, key::select},
+        std::pair{GLFW_KEY_ENTER,     key::start},
+        std::pair{GLFW_KEY_RIGHT,     key::right},
+        std::pair{GLFW_KEY_LEFT,      key::left},
+        std::pair{GLFW_KEY_UP,        key::up},
+        std::pair{GLFW_KEY_DOWN,      key::down},
+        std::pair{GLFW_KEY_S,         key::r},
+        std::pair{GLFW_KEY_A,         key::l},
+    };
+    auto keys = u16{0};
+    for (auto const& [glfw_key, gba_key] : bindings) {
+        if (glfwGetKey(window, glfw_key) == GLFW_PRESS) keys |= key_mask(gba_key);
+    }
+    return keys;
+}
+
+}
@@ -0,0 +1,232 @@
+#include <fmt/core.h>
+
+#include "emulator/gbaemu.hpp"
+#include "emulator/movie.hpp"
+#include "fgba-defines.hpp"
+#include "utility/fatexception.hpp"
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct options {
+    std::filesystem::path rom;
+    std::optional<std::filesystem::path> bios;
+    u64 cycles = 60 * fgba::gameboy_advance::cycles_per_frame;
+    u32 run_ahead = 0;
+    std::optional<std::filesystem::path> replay;
+    std::optional<std::filesystem::path> checksums;
+    std::optional<std::filesystem::path> verify;
+};
+
+constexpr std::string_view usage =
+    "usage: fgba-headless <rom> [--bios <path>] [--frames <n> | --cycles <n>] [--run-ahead <n>]\n"
+    "                           [--replay <movie>] [--checksums <path>] [--verify <path>]\n"
+    "runs the emulator with no presentation as fast as it can and reports throughput\n"
+    "with run-ahead every frame is followed by n more which are rolled back, like the frontend does it\n"
+    "replay plays a recorded movie from its start state for as many frames as it has\n"
+    "checksums writes a hash of the machine after every frame, verify compares against such a file\n"
+    "and reports the first frame which went different\n";
+
+[[nodiscard]]auto parse_count(std::string_view const arg)
+    -> u64 {
+    auto result = u64{0};
+    auto const [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), result);
+    if (ec != std::errc{} or end != arg.data() + arg.size()) {
+        throw fgba::runtime_error{fmt::format("\"{}\" is not a count", arg)};
+    }
+    return result;
+}
+
+[[nodiscard]]auto parse_options(std::span<char const* const> const args)
+    -> options {
+    auto result = options{};
+    auto rom    = std::optional<std::filesystem::path>{};
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        auto const arg = std::string_view{args[i]};
+        auto const next = [&] {
+            if (i + 1 >= args.size()) {
+                throw fgba::runtime_error{fmt::format("{} expects a value", arg)};
+            }
+            return std::string_view{args[++i]};
+        };
+        if (arg == "--bios") {
+            result.bios = next();
+        } else if (arg == "--frames") {
+            result.cycles = parse_count(next()) * fgba::gameboy_advance::cycles_per_frame;
+        } else if (arg == "--cycles") {
+            result.cycles = parse_count(next());
+        } else if (arg == "--run-ahead") {
+            result.run_ahead = static_cast<u32>(parse_count(next()));
+        } else if (arg == "--replay") {
+            result.replay = next();
+        } else if (arg == "--checksums") {
+            result.checksums = next();
+        } else if (arg == "--verify") {
+            result.verify = next();
+        } else if (not rom.has_value()) {
+            rom = arg;
+        } else {
+            throw fgba::runtime_error{fmt::format("unexpected argument {}", arg)};
+        }
+    }
+    if (not rom.has_value()) {
+        throw fgba::runtime_error{"rom wasn't specified"};
+    }
+    if (result.run_ahead != 0 and (result.replay or result.checksums or result.verify)) {
+        throw fgba::runtime_error{"run-ahead doesn't go together with replaying or checksums"};
+    }
+    result.rom = std::move(*rom);
+    return result;
+}
+
+[[nodiscard]]auto read_checksums(std::filesystem::path const& path)
+    -> std::vector<u64> {
+    auto file = std::ifstream{path};
+    if (not file) {
+        throw fgba::runtime_error{fmt::format("couldn't open {}", path.string())};
+    }
+    auto result = std::vector<u64>{};
+    auto frame  = u64{0};
+    auto hash   = u64{0};
+    while (file >> frame >> std::hex >> hash >> std::dec) {
+        if (frame != result.size()) {
+            throw fgba::runtime_error{fmt::format("{} skips from frame {} to {}", path.string(), result.size(), frame)};
+        }
+        result.push_back(hash);
+    }
+    return result;
+}
+
+} // namespace
+
+auto main(int argc, char const* argv[]) -> int try {
+    auto const args = std::span{argv, static_cast<std::size_t>(argc)}.subspan(1);
+    if (args.empty()) {
+        fmt::print(stderr, "{}", usage);
+        return 1;
+    }
+    auto const options = parse_options(args);
+
+    // machine is way too big for the stack
+    auto gba = std::make_unique<fgba::gameboy_advance>();
+    if (options.bios.has_value()) {
+        gba->load_bios(*options.bios);
+    }
+    gba->load_gamerom(options.rom);
+    gba->reset(not options.bios.has_value());
+
+    auto movie = std::optional<fgba::movie>{};
+    auto scratch = std::vector<std::byte>{};
+    if (options.replay.has_value()) {
+        movie = fgba::read_movie(*options.replay);
+        fgba::start_replay(*gba, *movie);
+    }
+    auto const expected = options.verify.has_value() ? read_checksums(*options.verify) : std::vector<u64>{};
+    auto checksums = std::vector<u64>{};
+    auto const frame_by_frame = movie.has_value() or options.checksums.has_value() or options.verify.has_value();
+    auto const frame_limit = movie.has_value() ? u64{movie->keys.size()} : options.cycles / fgba::gameboy_advance::cycles_per_frame;
+
+    auto const retired_before = gba->retired_instructions();
+    auto const start = std::chrono::steady_clock::now();
+    auto cycles = u64{0};
+    // hashing is not emulation, its time is taken out of the results
+    auto hashing = std::chrono::steady_clock::duration{};
+    if (frame_by_frame) {
+        for (u64 frame = 0; frame < frame_limit; ++frame) {
+            if (movie.has_value()) gba->set_keys(movie->keys[frame]);
+            cycles += gba->run_frame();
+            auto const hash_start = std::chrono::steady_clock::now();
+            checksums.push_back(fgba::state_checksum(*gba, scratch));
+            hashing += std::chrono::steady_clock::now() - hash_start;
+        }
+    } else if (options.run_ahead == 0) {
+        cycles = gba->run_for(options.cycles);
+    } else {
+        while (cycles < options.cycles) {
+            cycles += gba->run_frame_ahead(options.run_ahead);
+        }
+    }
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start - hashing);
+
+    auto const instructions = gba->retired_instructions() - retired_before;
+    auto const frames = static_cast<double>(cycles) / fgba::gameboy_advance::cycles_per_frame;
+    auto const speed  = static_cast<double>(cycles) / elapsed.count() / fgba::gameboy_advance::clock_rate;
+    fmt::print(
+        "frames:       {:.1f}\n"
+        "instructions: {}\n"
+        "cycles:       {}\n"
+        "elapsed:      {:.3f}s\n"
+        "frames/s:     {:.1f}\n"
+        "instr/s:      {:.0f}\n"
+        "speed:        {:.0f}%\n",
+        frames,
+        instructions,
+        cycles,
+        elapsed.count(),
+        frames / elapsed.count(),
+        static_cast<double>(instructions) / elapsed.count(),
+        speed * 100
+    );
+    if (options.checksums.has_value()) {
+        auto file = std::ofstream{*options.checksums, std::ios::trunc};
+        for (std::size_t frame = 0; frame < checksums.size(); ++frame) {
+            file << frame << ' ' << std::hex << checksums[frame] << std::dec << '\n';
+        }
+        if (not file) {
+            throw fgba::runtime_error{fmt::format("couldn't write {}", options.checksums->string())};
+        }
+    }
+    if (options.verify.has_value()) {
+        auto const compared = std::min(expected.size(), checksums.size());
+        auto frame = std::size_t{0};
+        while (frame < compared and expected[frame] == checksums[frame]) ++frame;
+        if (frame != compared) {
+            fmt::print("verify:       diverged on frame {}\n", frame);
+            return 1;
+        }
+        fmt::print("verify:       {} frames match\n", compared);
+        if (expected.size() != checksums.size()) {
+            fmt::print("verify:       {} frames were expected, {} ran\n", expected.size(), checksums.size());
+        }
+    }
+    if (options.run_ahead != 0) {
+        // what the rollback itself costs on top of running the extra frames
+        constexpr auto rounds = 100;
+        auto state = std::vector<std::byte>{};
+        gba->save_state(state);
+        auto const save_start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < rounds; ++i) gba->save_state(state);
+        auto const load_start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < rounds; ++i) gba->load_state(state);
+        auto const load_end = std::chrono::steady_clock::now();
+        auto const per_round = [&](auto const from, auto const to) {
+            return std::chrono::duration<double, std::micro>(to - from).count() / rounds;
+        };
+        auto const frame_ms = elapsed.count() * 1000 / frames;
+        fmt::print(
+            "run-ahead:    {} frames\n"
+            "frame cost:   {:.3f}ms per shown frame, {:.3f}ms budget\n"
+            "state save:   {:.1f}us\n"
+            "state load:   {:.1f}us\n"
+            "state size:   {} bytes\n",
+            options.run_ahead,
+            frame_ms,
+            1000.0 * fgba::gameboy_advance::cycles_per_frame / fgba::gameboy_advance::clock_rate,
+            per_round(save_start, load_start),
+            per_round(load_start, load_end),
+            state.size()
+        );
+    }
+} catch (fgba::runtime_error const& e) {
+    fmt::print(stderr, "{}\n", e);
+    return 1;
+}
@@ -0,0 +1,146 @@
+#include <fmt/core.h>
+
+#include "emulator/cpu/lockstep.hpp"
+#include "emulator/mmu/memory-arena.hpp"
+#include "emulator/mmu/mmu.hpp"
+#include "emulator/ppu/ppu.hpp"
+#include "emulator/scheduler.hpp"
+#include "fgba-defines.hpp"
+#include "utility/fatexception.hpp"
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+struct options {
+    std::filesystem::path rom;
+    std::optional<std::filesystem::path> bios;
+    u64 instructions = 10'000'000;
+    fgba::cpu::engine engine = fgba::cpu::engine::blocks;
+};
+
+constexpr std::string_view usage =
+    "usage: fgba-lockstep <rom> [--bios <path>] [--instructions <n>] [--engine blocks|interpreter]\n"
+    "runs the rom on two cpus, one through the interpreter and one through the engine,\n"
+    "compares them after every step of the engine and stops at the first difference.\n"
+    "blocks is whatever execute_block runs them with in this build\n"
+    "only the cpus run, video and timers stay where reset left them\n";
+
+[[nodiscard]]auto parse_count(std::string_view const arg)
+    -> u64 {
+    auto result = u64{0};
+    auto const [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), result);
+    if (ec != std::errc{} or end != arg.data() + arg.size()) {
+        throw fgba::runtime_error{fmt::format("\"{}\" is not a count", arg)};
+    }
+    return result;
+}
+
+[[nodiscard]]auto parse_engine(std::string_view const arg)
+    -> fgba::cpu::engine {
+    if (arg == "blocks") return fgba::cpu::engine::blocks;
+    if (arg == "interpreter") return fgba::cpu::engine::interpreter;
+    throw fgba::runtime_error{fmt::format("there is no engine called {}", arg)};
+}
+
+[[nodiscard]]auto parse_options(std::span<char const* const> const args)
+    -> options {
+    auto result = options{};
+    auto rom    = std::optional<std::filesystem::path>{};
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        auto const arg = std::string_view{args[i]};
+        auto const next = [&] {
+            if (i + 1 >= args.size()) {
+                throw fgba::runtime_error{fmt::format("{} expects a value", arg)};
+            }
+            return std::string_view{args[++i]};
+        };
+        if (arg == "--bios") {
+            result.bios = next();
+        } else if (arg == "--instructions") {
+            result.instructions = parse_count(next());
+        } else if (arg == "--engine") {
+            result.engine = parse_engine(next());
+        } else if (not rom.has_value()) {
+            rom = arg;
+        } else {
+            throw fgba::runtime_error{fmt::format("unexpected argument {}", arg)};
+        }
+    }
+    if (not rom.has_value()) {
+        throw fgba::runtime_error{"rom wasn't specified"};
+    }
+    result.rom = std::move(*rom);
+    return result;
+}
+
+// memory side of a gba, the cpu is the harness's
+struct machine {
+    fgba::mmu::memory_arena arena;
+    fgba::scheduler scheduler;
+    fgba::ppu::ppu ppu{scheduler, arena};
+    fgba::mmu::memory_managment_unit mmu{ppu, arena};
+};
+
+[[nodiscard]]auto make_machine(options const& options)
+    -> std::unique_ptr<machine> {
+    auto result = std::make_unique<machine>();
+    if (options.bios.has_value()) {
+        result->mmu.load_bios(*options.bios);
+    }
+    result->mmu.load_gamerom(options.rom);
+    return result;
+}
+
+// same state gameboy_advance::reset leaves the cpu in
+auto boot(fgba::cpu::arm7tdmi& processor, bool const skip_bios)
+    -> void {
+    if (skip_bios) {
+        processor.skip_bios();
+    } else {
+        processor.reset();
+    }
+}
+
+} // namespace
+
+auto main(int argc, char const* argv[]) -> int try {
+    auto const args = std::span{argv, static_cast<std::size_t>(argc)}.subspan(1);
+    if (args.empty()) {
+        fmt::print(stderr, "{}", usage);
+        return 1;
+    }
+    auto const options = parse_options(args);
+
+    auto const reference = make_machine(options);
+    auto const candidate = make_machine(options);
+    // two cpus with their block caches are too big for the stack as well
+    auto const harness = std::make_unique<fgba::cpu::lockstep<fgba::mmu::memory_managment_unit>>(
+        reference->mmu, candidate->mmu, options.engine
+    );
+    boot(harness->reference(), not options.bios.has_value());
+    boot(harness->candidate(), not options.bios.has_value());
+
+    // something neither engine implements isn't a difference, but whatever ran up to it still matched
+    auto found = std::optional<fgba::cpu::divergence>{};
+    try {
+        found = harness->run(options.instructions);
+    } catch (fgba::runtime_error const& e) {
+        fmt::print("{} instructions match, then: {}\n", harness->candidate().retired(), e);
+        return 1;
+    }
+    if (found.has_value()) {
+        fmt::print("{}", found->report);
+        return 1;
+    }
+    fmt::print("{} instructions match\n", harness->candidate().retired());
+} catch (fgba::runtime_error const& e) {
+    fmt::print(stderr, "{}\n", e);
+    return 1;
+}
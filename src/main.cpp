@@ -3,11 +3,15 @@
 #include <spdlog/spdlog.h>
 
 #include "gui/devgui/maingui.hpp"
+#include "gui/keyboard.hpp"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include "utility/scopeguard.hpp"
 #include "utility/fatexception.hpp"
 #include "emulator/gbaemu.hpp"
+#include "emulator/emulation-thread.hpp"
+#include <chrono>
+#include <memory>
 
 auto main() -> int try {
      
@@ -29,15 +33,27 @@ auto main() -> int try {
             glfwTerminate();
         }
     };
-    fgba::gameboy_advance gba;
-    auto display = fgba::gui::display{gba.get_display_view()};
-
+    // machine is way too big for the stack
+    auto gba = std::make_unique<fgba::gameboy_advance>();
+    auto display = fgba::gui::display{gba->get_frames()};
+    // from here on the machine belongs to the emulation thread
+    auto emu = fgba::emulation_thread{*gba};
 
+    // wake up at least once per emulated frame, so new ones are shown even without input
+    auto const refresh_timeout = std::chrono::duration<double>{fgba::emulation_thread::frame_duration}.count();
+    auto keys = u16{0};
     while (glfwWindowShouldClose(window.get()) == 0) {
-        glfwWaitEvents();
+        glfwWaitEventsTimeout(refresh_timeout);
         auto new_frame = fgba::gui::frame(window.get());
 
-        fgba::gui::draw_main_gui(gba, display);
+        // typing into some imgui widget doesn't press buttons
+        auto const held = ImGui::GetIO().WantCaptureKeyboard ? u16{0} : fgba::gui::read_keypad(window.get());
+        // when the queue is full the keys are sent again next time around
+        if (held != keys and emu.post({.type = fgba::emulation_thread::command_type::set_keys, .argument = held})) {
+            keys = held;
+        }
+
+        fgba::gui::draw_main_gui(emu, display);
     }
 } catch (fgba::runtime_error const& e) {
     spdlog::error("{}", e);
@@ -0,0 +1,45 @@
+#ifndef FGBA_TESTS_FLAT_MEMORY_HPP_ZKQWPXMRVD
+#define FGBA_TESTS_FLAT_MEMORY_HPP_ZKQWPXMRVD
+
+#include <array>
+
+#include "emulator/cpu/bus.hpp"
+#include "emulator/cpudefines.hpp"
+#include "fgba-defines.hpp"
+
+namespace fgba::test {
+
+// just enough memory for the cpu to run from, it wraps around. narrow reads come back
+// repeated over the whole bus and narrow writes only touch their lane, same as the mmu
+struct flat_memory {
+    std::array<u32, 0x200> words{};
+
+    auto memory_access_read(cpu::address address, cpu::data_size mas, word& data_bus) const noexcept
+        -> void {
+        auto const stored = words[(address.value >> 2) % words.size()];
+        switch (mas) {
+            case cpu::data_size::hword: data_bus = word{(stored >> (address.value & 0b10) * 8 & 0xffff) * 0x0001'0001_u32}; break;
+            case cpu::data_size::byte:  data_bus = word{(stored >> (address.value & 0b11) * 8 & 0xff) * 0x0101'0101_u32}; break;
+            default:                    data_bus = word{stored}; break;
+        }
+    }
+    auto memory_access_write(cpu::address address, cpu::data_size mas, word data_bus) noexcept
+        -> void {
+        auto& stored = words[(address.value >> 2) % words.size()];
+        auto const lane = [&](u32 const mask, u32 const shift) {
+            stored = (stored & ~(mask << shift)) | (data_bus.value & mask) << shift;
+        };
+        switch (mas) {
+            case cpu::data_size::hword: lane(0xffff, (address.value & 0b10) * 8); break;
+            case cpu::data_size::byte:  lane(0xff, (address.value & 0b11) * 8); break;
+            default:                    stored = data_bus.value; break;
+        }
+    }
+    // for laying out thumb code
+    auto set_hword(u32 const address, u16 const value) noexcept
+        -> void { memory_access_write(cpu::address{word{address}}, cpu::data_size::hword, word{value}); }
+};
+
+} // namespace fgba::test
+
+#endif
@@ -1,3 +1,30 @@
+#include <catch2/catch_test_macros.hpp>
+#include "emulator/cpu/registermanager.hpp"
+#include "emulator/cpu/shifter.hpp"
+#include "emulator/cpudefines.hpp"
+using namespace fgba;
+using namespace fgba::cpu;
+
+TEST_CASE("Immediate shift amount comes from bits 11 to 7", "[cpu][shifter]") {
+    auto const regs = register_manager{};
+    // mov r0, r1, lsr #3, bits 6 and 5 are the shift type and not part of the amount
+    auto const instruction = word{0xe1a0'01a1};
+    CHECK(shifter::barrel<shifts::lsr, s_bit::off>(instruction, word{0x80}, regs) == word{0x10});
+    auto const [result, carryout] = shifter::barrel<shifts::lsr, s_bit::on>(instruction, word{0x84}, regs);
+    CHECK(result == word{0x10});
+    CHECK(carryout == 1_bit);
+}
+
+TEST_CASE("Register shift amount is the bottom byte of rs", "[cpu][shifter]") {
+    auto regs = register_manager{};
+    // mov r0, r1, lsl r3, bits 11 to 7 read as an immediate would be 6
+    auto const instruction = word{0xe1a0'0311};
+    regs[3] = word{0x102};
+    CHECK(shifter::barrel<shifts::rslsl, s_bit::off>(instruction, word{1}, regs) == word{4});
+    regs[3] = word{0xff00};
+    CHECK(shifter::barrel<shifts::rslsl, s_bit::off>(instruction, word{1}, regs) == word{1});
+}
+
 //#include <catch2/catch_test_macros.hpp>
 //#include <ostream>
 //#include "emulator/cpudefines.hpp"
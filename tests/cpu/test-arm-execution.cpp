@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include <initializer_list>
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+using namespace fgba;
+using namespace fgba::cpu;
+using fgba::test::flat_memory;
+
+namespace {
+
+[[nodiscard]]auto nzcv(arm7tdmi const& cpu)
+    -> u32 { return cpu.get_regitsters_contents().cpsr().val >> 28; }
+[[nodiscard]]auto reg(arm7tdmi const& cpu, u32 const r)
+    -> u32 { return cpu.get_regitsters_contents()[r].value; }
+
+// code goes where reset starts running it
+auto boot(flat_memory& memory, arm7tdmi& cpu, std::initializer_list<u32> const code)
+    -> void {
+    auto address = u32{0};
+    for (auto const opcode : code) memory.words[address++] = opcode;
+    cpu.connect_bus(connector{memory});
+    cpu.reset();
+}
+
+auto step(arm7tdmi& cpu, u32 const instructions)
+    -> void {
+    for (u32 i = 0; i < instructions; ++i) cpu.advance_execution();
+}
+
+}
+
+TEST_CASE("Arm loads rotate, sign extend and write back", "[cpu][arm][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    memory.words[0x104 / 4] = 0x7fff'8001;
+    boot(memory, cpu, {
+        0xe3a0'0c01, // mov r0, #0x100
+        0xe5b0'1004, // ldr r1, [r0, #4]!
+        0xe4d0'2001, // ldrb r2, [r0], #1
+        0xe590'3000, // ldr r3, [r0]
+        0xe1d0'40f0, // ldrsh r4, [r0]
+        0xe1d0'50b0, // ldrh r5, [r0]
+    });
+
+    step(cpu, 3);
+    CHECK(reg(cpu, 1) == 0x7fff'8001);
+    CHECK(reg(cpu, 2) == 0x01);
+    CHECK(reg(cpu, 0) == 0x105);
+    step(cpu, 3);
+    // misaligned words come back rotated
+    CHECK(reg(cpu, 3) == 0x017f'ff80);
+    // signed halfword from an odd address is a signed byte
+    CHECK(reg(cpu, 4) == 0xffff'ff80);
+    CHECK(reg(cpu, 5) == 0x0100'0080);
+}
+
+TEST_CASE("Arm stores write back and store pc 12 ahead", "[cpu][arm][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    boot(memory, cpu, {
+        0xe3a0'0c01, // mov r0, #0x100
+        0xe520'f004, // str pc, [r0, #-4]!
+        0xe1c0'00b2, // strh r0, [r0, #2]
+    });
+
+    step(cpu, 3);
+    CHECK(reg(cpu, 0) == 0xfc);
+    CHECK(memory.words[0xfc / 4] == 0x00fc'0010);
+}
+
+TEST_CASE("Arm block stores write the base back after the first register", "[cpu][arm][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    boot(memory, cpu, {
+        0xe3a0'0c01, // mov r0, #0x100
+        0xe3a0'1d06, // mov r1, #0x180
+        0xe920'0003, // stmdb r0!, {r0, r1}
+        0xe8a1'0003, // stmia r1!, {r0, r1}
+    });
+
+    step(cpu, 4);
+    // base first in the list goes out unchanged, anywhere else it is already written back
+    CHECK(memory.words[0xf8 / 4] == 0x100);
+    CHECK(memory.words[0xfc / 4] == 0x180);
+    CHECK(memory.words[0x180 / 4] == 0xf8);
+    CHECK(memory.words[0x184 / 4] == 0x188);
+    CHECK(reg(cpu, 0) == 0xf8);
+    CHECK(reg(cpu, 1) == 0x188);
+}
+
+TEST_CASE("Arm ldm with pc in the list jumps to what it loaded", "[cpu][arm][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    memory.words[0x100 / 4] = 7;
+    memory.words[0x104 / 4] = 0x40;
+    memory.words[0x40 / 4]  = 0xe3a0'2005; // mov r2, #5
+    boot(memory, cpu, {
+        0xe3a0'0c01, // mov r0, #0x100
+        0xe8b0'8002, // ldmia r0!, {r1, pc}
+        0xe3a0'3009, // mov r3, #9, skipped
+    });
+
+    step(cpu, 2);
+    CHECK(reg(cpu, 1) == 7);
+    CHECK(reg(cpu, 0) == 0x108);
+    CHECK(reg(cpu, registers::pc) == 0x40 + 8);
+    step(cpu, 1);
+    CHECK(reg(cpu, 2) == 5);
+    CHECK(reg(cpu, 3) == 0);
+}
+
+TEST_CASE("Arm multiplies keep both halves and set flags", "[cpu][arm][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    boot(memory, cpu, {
+        0xe3e0'0000, // mvn r0, #0
+        0xe3a0'1002, // mov r1, #2
+        0xe093'2190, // umulls r2, r3, r0, r1
+        0xe0d5'4190, // smulls r4, r5, r0, r1
+        0xe3a0'6000, // mov r6, #0
+        0xe017'0096, // muls r7, r6, r0
+    });
+
+    step(cpu, 3);
+    CHECK(reg(cpu, 2) == 0xffff'fffe);
+    CHECK(reg(cpu, 3) == 1);
+    CHECK(nzcv(cpu) == 0b0000);
+    step(cpu, 1);
+    CHECK(reg(cpu, 4) == 0xffff'fffe);
+    CHECK(reg(cpu, 5) == 0xffff'ffff);
+    CHECK(nzcv(cpu) == 0b1000);
+    step(cpu, 2);
+    CHECK(reg(cpu, 7) == 0);
+    CHECK(nzcv(cpu) == 0b0100);
+}
@@ -0,0 +1,366 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpu/block-cache.hpp"
+#include "emulator/cpu/instruction-impl/implementation.hpp"
+#include "emulator/cpu/opcodes.hpp"
+#include "emulator/cpudefines.hpp"
+#include "emulator/mmu/mmu.hpp"
+#include "emulator/ppu/ppu.hpp"
+#include "emulator/save-state.hpp"
+#include "emulator/scheduler.hpp"
+#include "flat-memory.hpp"
+#ifdef FGBA_ENABLE_JIT
+#include "emulator/cpu/jit/translator.hpp"
+#endif
+using namespace fgba;
+using namespace fgba::cpu;
+using fgba::test::flat_memory;
+
+namespace {
+
+constexpr u32 mov_r0_r1   = 0xe1a0'0001;
+constexpr u32 orr_r0_r1   = 0xe180'0001;
+constexpr u32 add_r0_1    = 0xe280'0001;
+constexpr u32 b_next      = 0xea00'0000;
+// add pc, lr, #0
+constexpr u32 add_pc_lr   = 0xe28e'f000;
+constexpr u32 cmp_r0_r0   = 0xe150'0000;
+constexpr u32 addne_r1_1  = 0x1281'1001;
+constexpr u32 addeq_r2_1  = 0x0282'2001;
+// to 0x14 when it is at 0x4
+constexpr u32 beq_forward = 0x0a00'0002;
+
+struct machine {
+    fgba::mmu::memory_arena arena;
+    scheduler scheduler;
+    ppu::ppu ppu{scheduler, arena};
+    fgba::mmu::memory_managment_unit mmu{ppu, arena};
+    arm7tdmi cpu;
+};
+
+// everything about the bus a state keeps, memory itself aside
+[[nodiscard]]auto bus_state(machine const& gba)
+    -> std::vector<std::byte> {
+    auto buffer = std::vector<std::byte>{};
+    auto state  = state_writer{buffer};
+    gba.cpu.save_state(state);
+    gba.mmu.save_state(state);
+    return buffer;
+}
+
+}
+
+TEST_CASE("Blocks end on branches and before other pc writes", "[cpu][arm][block-cache]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    cpu.connect_bus(connector{memory});
+    block_cache cache;
+
+    memory.words[0] = orr_r0_r1;
+    memory.words[1] = add_r0_1;
+    memory.words[2] = b_next;
+    memory.words[3] = orr_r0_r1;
+
+    memory.words[8] = orr_r0_r1;
+    memory.words[9] = add_pc_lr;
+
+    auto const& with_branch = cache.lookup(cpu, 0x0);
+    CHECK(with_branch.entries.size() == 3);
+    CHECK(with_branch.ends_in_branch);
+
+    auto const& with_pc_write = cache.lookup(cpu, 0x20);
+    CHECK(with_pc_write.entries.size() == 1);
+    CHECK_FALSE(with_pc_write.ends_in_branch);
+}
+
+TEST_CASE("Blocks do not cross code pages", "[cpu][arm][block-cache]") {
+    flat_memory memory;
+    memory.words.fill(orr_r0_r1);
+    arm7tdmi cpu;
+    cpu.connect_bus(connector{memory});
+    block_cache cache;
+
+    auto const& block = cache.lookup(cpu, block_cache::code_page_size - 8);
+    CHECK(block.entries.size() == 2);
+}
+
+TEST_CASE("Writes to a code page throw its blocks away", "[cpu][arm][block-cache]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    cpu.connect_bus(connector{memory});
+    block_cache cache;
+
+    memory.words[0] = orr_r0_r1;
+    memory.words[1] = b_next;
+    REQUIRE(cache.lookup(cpu, 0x0).entries.size() == 2);
+
+    auto const generation = cache.generation();
+    cache.invalidate(block_cache::code_page_size);
+    CHECK(cache.generation() == generation);
+
+    memory.words[1] = add_pc_lr;
+    cache.invalidate(0x4);
+    CHECK(cache.generation() != generation);
+    CHECK(cache.lookup(cpu, 0x0).entries.size() == 1);
+}
+
+TEST_CASE("Writes through a mirror throw blocks away too", "[cpu][arm][block-cache]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    cpu.connect_bus(connector{memory});
+    block_cache cache;
+
+    memory.words[0] = add_r0_1;
+    memory.words[1] = b_next;
+    REQUIRE(cache.lookup(cpu, 0x0300'0000).entries.size() == 2);
+
+    // iwram repeats every 32KiB
+    auto const iwram_generation = cache.generation();
+    cache.invalidate(0x0300'8004);
+    CHECK(cache.generation() != iwram_generation);
+
+    // vram mirrors the object tiles into the upper 32KiB of every 128KiB
+    REQUIRE(cache.lookup(cpu, 0x0601'0000).entries.size() == 2);
+    auto const vram_generation = cache.generation();
+    cache.invalidate(0x0603'8000);
+    CHECK(cache.generation() != vram_generation);
+}
+
+TEST_CASE("Instructions in a block only run when their condition passes", "[cpu][arm][block-cache]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    cpu.connect_bus(connector{memory});
+
+    memory.words[0] = cmp_r0_r0;
+    memory.words[1] = addne_r1_1;
+    memory.words[2] = addeq_r2_1;
+    memory.words[3] = b_next;
+    cpu.reset();
+    cpu.execute_block();
+    CHECK(cpu.get_regitsters_contents()[1].value == 0);
+    CHECK(cpu.get_regitsters_contents()[2].value == 1);
+}
+
+TEST_CASE("Block which ends in a failed branch falls through", "[cpu][arm][block-cache]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    cpu.connect_bus(connector{memory});
+
+    // z is clear after reset, so beq is not taken
+    memory.words[0] = add_r0_1;
+    memory.words[1] = beq_forward;
+    memory.words[2] = add_r0_1;
+    memory.words[3] = b_next;
+    cpu.reset();
+    cpu.execute_block();
+    CHECK(cpu.get_regitsters_contents()[0].value == 1);
+    // next block starts right after the branch, not at its target
+    CHECK(cpu.get_regitsters_contents()[pc].value == 0x8 + 8);
+    cpu.execute_block();
+    CHECK(cpu.get_regitsters_contents()[0].value == 2);
+}
+
+TEST_CASE("Threaded code runs blocks the same as a call per instruction", "[cpu][arm][block-cache]") {
+    flat_memory memory;
+    arm7tdmi called;
+    arm7tdmi threaded;
+    called.connect_bus(connector{memory});
+    threaded.connect_bus(connector{memory});
+    called.reset();
+    threaded.reset();
+
+    auto entries = std::vector<block_cache::entry>{};
+    auto threaded_entries = std::vector<arm::threaded_entry>{};
+    for (auto const opcode : {add_r0_1, mov_r0_r1, add_r0_1, cmp_r0_r0, addne_r1_1, addeq_r2_1}) {
+        auto const instruction = arm::instruction{word{opcode}};
+        auto const spec = decode(instruction);
+        REQUIRE(arm::handler_for(spec) != nullptr);
+        REQUIRE(arm::threaded_handler_for(spec) != nullptr);
+        entries.push_back({arm::handler_for(spec), instruction});
+        threaded_entries.push_back({arm::threaded_handler_for(spec), instruction});
+    }
+    threaded_entries.push_back({arm::threaded_exit(), arm::instruction{}});
+
+    auto const by_call  = arm::run_entries(called, entries, called.code_generation());
+    auto const by_jumps = arm::run_threaded(threaded, threaded_entries.data(), threaded.code_generation());
+    CHECK(by_call.executed == entries.size());
+    CHECK(by_jumps.executed == by_call.executed);
+    CHECK(by_jumps.passed == by_call.passed);
+    for (u32 i = 0; i < 16; ++i) {
+        CHECK(threaded.get_regitsters_contents()[i].value == called.get_regitsters_contents()[i].value);
+    }
+    CHECK(threaded.get_regitsters_contents().cpsr().val == called.get_regitsters_contents().cpsr().val);
+}
+
+TEST_CASE("Decoding a block ahead leaves nothing behind in a state", "[cpu][arm][block-cache]") {
+    auto gba = std::make_unique<machine>();
+    gba->cpu.connect_bus(connector{gba->mmu});
+    gba->cpu.reset();
+    block_cache cache;
+
+    gba->mmu.write<u32>(0x0300'0000, orr_r0_r1);
+    gba->mmu.write<u32>(0x0300'0004, add_r0_1);
+    gba->mmu.write<u32>(0x0300'0008, b_next);
+    // something other than the code on the bus, and the next access somewhere else
+    auto bus = word{};
+    gba->mmu.memory_access_read(cpu::address{0x0200'0000_word}, data_size::word, bus);
+    auto const before = bus_state(*gba);
+
+    auto const& missed = cache.lookup(gba->cpu, 0x0300'0000);
+    REQUIRE(missed.entries.size() == 3);
+    CHECK(bus_state(*gba) == before);
+    auto const& hit = cache.lookup(gba->cpu, 0x0300'0000);
+    CHECK(&hit == &missed);
+    CHECK(bus_state(*gba) == before);
+}
+
+#ifdef FGBA_ENABLE_JIT
+TEST_CASE("Translated blocks end up where the interpreter does", "[cpu][arm][block-cache][jit]") {
+    // native data processing mixed with conditional and flag setting ones which go through handlers
+    constexpr auto program = std::array<u32, 11>{
+        0xe3a0'1055, // mov r1, #0x55
+        0xe1e0'6001, // mvn r6, r1
+        add_r0_1,
+        0xe080'3201, // add r3, r0, r1, lsl #4
+        0xe263'4c01, // rsb r4, r3, #0x100
+        cmp_r0_r0,
+        addne_r1_1,
+        addeq_r2_1,
+        0xe1c4'50a0, // bic r5, r4, r0, lsr #1
+        0xe096'6005, // adds r6, r6, r5
+        0xeaff'fff4, // b 0x0
+    };
+    constexpr u32 runs = block_cache::jit_threshold + 8;
+    flat_memory interpreted_memory;
+    flat_memory translated_memory;
+    std::ranges::copy(program, interpreted_memory.words.begin());
+    std::ranges::copy(program, translated_memory.words.begin());
+    arm7tdmi interpreted;
+    arm7tdmi translated;
+    interpreted.connect_bus(connector{interpreted_memory});
+    translated.connect_bus(connector{translated_memory});
+    interpreted.reset();
+    translated.reset();
+
+    for (u32 i = 0; i < runs * program.size(); ++i) interpreted.advance_execution();
+    for (u32 i = 0; i < runs; ++i) translated.execute_block();
+    for (u32 i = 0; i < 16; ++i) {
+        CHECK(translated.get_regitsters_contents()[i].value == interpreted.get_regitsters_contents()[i].value);
+    }
+    CHECK(translated.get_regitsters_contents().cpsr().val == interpreted.get_regitsters_contents().cpsr().val);
+}
+
+TEST_CASE("Translated loads and stores end up where the interpreter does", "[cpu][arm][block-cache][jit]") {
+    constexpr auto program = std::array<u32, 10>{
+        // data stays out of the code page, a store there would end the block
+        0xe3a0'1c06, // mov r1, #0x600
+        0xe59f'2018, // ldr r2, [pc, #0x18]
+        0xe5a1'2004, // str r2, [r1, #4]!
+        0xe4d1'3001, // ldrb r3, [r1], #1
+        0xe083'4082, // add r4, r3, r2, lsl #1
+        0xe701'4103, // str r4, [r1, -r3, lsl #2]
+        0xe511'5001, // ldr r5, [r1, #-1]
+        0xeaff'fff7, // b 0x0
+        0,
+        0x1234'5611,
+    };
+    constexpr u32 runs = block_cache::jit_threshold + 8;
+    flat_memory interpreted_memory;
+    flat_memory translated_memory;
+    std::ranges::copy(program, interpreted_memory.words.begin());
+    std::ranges::copy(program, translated_memory.words.begin());
+    arm7tdmi interpreted;
+    arm7tdmi translated;
+    interpreted.connect_bus(connector{interpreted_memory});
+    translated.connect_bus(connector{translated_memory});
+    interpreted.reset();
+    translated.reset();
+
+    for (u32 i = 0; i < runs * 8; ++i) interpreted.advance_execution();
+    for (u32 i = 0; i < runs; ++i) translated.execute_block();
+    for (u32 i = 0; i < 16; ++i) {
+        CHECK(translated.get_regitsters_contents()[i].value == interpreted.get_regitsters_contents()[i].value);
+    }
+    CHECK(translated.get_regitsters_contents()[5].value == 0x1234'5611);
+    CHECK(translated_memory.words == interpreted_memory.words);
+}
+
+TEST_CASE("Translated store into its own code page leaves the block", "[cpu][arm][block-cache][jit]") {
+    // stores walk down from the page above into the one the code is in
+    constexpr auto program = std::array<u32, 5>{
+        0xe3a0'1e50, // mov r1, #0x500
+        0xe041'1100, // sub r1, r1, r0, lsl #2
+        0xe581'0000, // str r0, [r1]
+        0xe280'0001, // add r0, r0, #1
+        0xeaff'fffa, // b 0x0
+    };
+    flat_memory interpreted_memory;
+    flat_memory translated_memory;
+    std::ranges::copy(program, interpreted_memory.words.begin());
+    std::ranges::copy(program, translated_memory.words.begin());
+    arm7tdmi interpreted;
+    arm7tdmi translated;
+    interpreted.connect_bus(connector{interpreted_memory});
+    translated.connect_bus(connector{translated_memory});
+    interpreted.reset();
+    translated.reset();
+
+    for (u32 i = 0; i < 0x50 * program.size(); ++i) interpreted.advance_execution();
+    while (translated.retired() < interpreted.retired()) translated.execute_block();
+    CHECK(translated.retired() == interpreted.retired());
+    for (u32 i = 0; i < 16; ++i) {
+        CHECK(translated.get_regitsters_contents()[i].value == interpreted.get_regitsters_contents()[i].value);
+    }
+    CHECK(translated_memory.words == interpreted_memory.words);
+}
+
+TEST_CASE("Loads and stores are translated without handlers", "[cpu][arm][block-cache][jit]") {
+    auto translator = jit::translator{arm::jit_fallback()};
+    auto entries = std::vector<block_cache::entry>{};
+    // literal load doesn't need pc in a host register
+    for (auto const opcode : {0xe59f'2018, 0xe5a1'2004, b_next}) {
+        auto const instruction = arm::instruction{word{opcode}};
+        entries.push_back({arm::handler_for(decode(instruction)), instruction});
+    }
+    auto const native = translator.translate(entries, 0x0);
+    REQUIRE(native.has_value());
+    CHECK(native->code != nullptr);
+    CHECK(native->registers == 0b110);
+}
+
+TEST_CASE("Hot blocks get translated and writes throw the translation away", "[cpu][arm][block-cache][jit]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    cpu.connect_bus(connector{memory});
+    block_cache cache;
+
+    memory.words[0] = add_r0_1;
+    memory.words[1] = mov_r0_r1;
+    memory.words[2] = b_next;
+    for (u32 i = 1; i < block_cache::jit_threshold; ++i) {
+        REQUIRE(cache.native_code(cache.lookup(cpu, 0x0), 0x0).code == nullptr);
+    }
+    auto const native = cache.native_code(cache.lookup(cpu, 0x0), 0x0);
+    CHECK(native.code != nullptr);
+    CHECK(native.registers == 0b11);
+
+    cache.invalidate(0x8);
+    CHECK(cache.native_code(cache.lookup(cpu, 0x0), 0x0).code == nullptr);
+}
+
+TEST_CASE("Blocks with nothing native in them are left to the interpreter", "[cpu][arm][block-cache][jit]") {
+    auto translator = jit::translator{arm::jit_fallback()};
+    auto entries = std::vector<block_cache::entry>{};
+    for (auto const opcode : {cmp_r0_r0, addne_r1_1, b_next}) {
+        auto const instruction = arm::instruction{word{opcode}};
+        entries.push_back({arm::handler_for(decode(instruction)), instruction});
+    }
+    auto const native = translator.translate(entries, 0x0);
+    REQUIRE(native.has_value());
+    CHECK(native->code == nullptr);
+}
+#endif
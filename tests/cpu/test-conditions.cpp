@@ -0,0 +1,47 @@
+#include <catch2/catch_test_macros.hpp>
+#include <utility>
+#include "emulator/cpudefines.hpp"
+using namespace fgba;
+using namespace fgba::cpu;
+
+namespace {
+// straight from the manual
+[[nodiscard]]constexpr auto reference(u32 const flags, condition const cond) noexcept
+    -> bool {
+    bool const n = (flags & ccf::n) != 0;
+    bool const z = (flags & ccf::z) != 0;
+    bool const c = (flags & ccf::c) != 0;
+    bool const v = (flags & ccf::v) != 0;
+    switch (cond) {
+        case condition::eq: return z;
+        case condition::ne: return not z;
+        case condition::cs: return c;
+        case condition::cc: return not c;
+        case condition::mi: return n;
+        case condition::pl: return not n;
+        case condition::vs: return v;
+        case condition::vc: return not v;
+        case condition::hi: return c and not z;
+        case condition::ls: return not c or z;
+        case condition::ge: return n == v;
+        case condition::lt: return n != v;
+        case condition::gt: return not z and n == v;
+        case condition::le: return z or n != v;
+        case condition::al: return true;
+        default:            return false;
+    }
+}
+}
+
+TEST_CASE("Condition table agrees with the manual", "[cpu][conditions]") {
+    for (u32 flags = 0; flags < 16; ++flags) {
+        // whatever sits below the flags doesn't matter
+        auto const psr = (flags << 28) | 0xdf;
+        for (u32 cond = 0; cond < std::to_underlying(condition::count); ++cond) {
+            CAPTURE(flags, cond);
+            CHECK(condition_passed(psr, cond) == reference(psr, static_cast<condition>(cond)));
+            auto const instruction = arm::instruction{word{(cond << 28) | 0x01a0'0000}};
+            CHECK((is_unconditional(instruction) or condition_passed(psr, cond)) == reference(psr, static_cast<condition>(cond)));
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <vector>
+#include "emulator/cpu/registermanager.hpp"
+#include "emulator/cpudefines.hpp"
+#include "emulator/save-state.hpp"
+using namespace fgba;
+using namespace fgba::cpu;
+
+namespace {
+[[nodiscard]]auto nzcv(register_manager const& regs)
+    -> u32 { return regs.cpsr().val >> 28; }
+}
+
+// same results with and without FGBA_LAZY_FLAGS, only when they are worked out differs
+TEST_CASE("Flags come out of the last operation which set them", "[cpu][flags]") {
+    auto regs = register_manager{};
+    regs.cpsr().val = 0xdf;
+
+    // 0x7fffffff + 1, overflows into the sign bit
+    regs.set_arithmetic_flags(word{0x8000'0000}, false, word{0x7fff'ffff}, word{1});
+    CHECK(nzcv(regs) == 0b1001);
+
+    // logical ones leave v alone, even when it is still pending
+    regs.set_arithmetic_flags(word{0}, true, word{0x8000'0000}, word{0x8000'0000});
+    regs.set_logical_flags(word{0x10}, false);
+    CHECK(nzcv(regs) == 0b0001);
+    CHECK_FALSE(regs.carry());
+
+    regs.set_logical_flags(word{0}, true);
+    CHECK(regs.carry());
+    CHECK(nzcv(regs) == 0b0111);
+    // rest of cpsr is untouched
+    CHECK((regs.cpsr().val & 0xff) == 0xdf);
+}
+
+TEST_CASE("Writing cpsr replaces pending flags", "[cpu][flags]") {
+    auto regs = register_manager{};
+    regs.cpsr().val = 0xdf;
+    regs.set_arithmetic_flags(word{0}, true, word{1}, word{0xffff'ffff});
+    regs.cpsr().val = 0x8000'00df;
+    CHECK(nzcv(regs) == 0b1000);
+    CHECK_FALSE(regs.carry());
+}
+
+TEST_CASE("Saved registers don't depend on how flags got worked out", "[cpu][flags]") {
+    auto regs = register_manager{};
+    regs.cpsr().val = 0xdf;
+    auto other = regs;
+    // both come out as n, and whatever the results were otherwise isn't part of the cpu
+    regs.set_logical_flags(word{0x8000'0000}, false);
+    other.set_logical_flags(word{0x8000'0001}, false);
+    CHECK(nzcv(other) == 0b1000);
+
+    auto saved       = std::vector<std::byte>{};
+    auto saved_other = std::vector<std::byte>{};
+    auto state       = state_writer{saved};
+    auto state_other = state_writer{saved_other};
+    regs.save_state(state);
+    other.save_state(state_other);
+    CHECK(saved == saved_other);
+
+    auto loaded = register_manager{};
+    auto reader = state_reader{saved};
+    loaded.load_state(reader);
+    CHECK(nzcv(loaded) == 0b1000);
+    CHECK(loaded.cpsr().val == regs.cpsr().val);
+}
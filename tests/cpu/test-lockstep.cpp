@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <string>
+#include "emulator/cpu/lockstep.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+using namespace fgba;
+using namespace fgba::cpu;
+using fgba::test::flat_memory;
+
+namespace {
+
+// counts r0 up and folds it into r3 over and over, a block of its own
+constexpr auto counting_loop = std::array<u32, 6>{
+    0xe3a0'3b01, // mov r3, #0x400
+    0xe280'0001, // add r0, r0, #1
+    0xe150'0000, // cmp r0, r0
+    0x1282'2001, // addne r2, r2, #1
+    0xe023'3000, // eor r3, r3, r0
+    0xeaff'fffa, // b 0x4
+};
+constexpr u32 add_r0_2 = 0xe280'0002;
+
+auto load(flat_memory& memory)
+    -> void { std::ranges::copy(counting_loop, memory.words.begin()); }
+
+}
+
+TEST_CASE("Engines which agree run to the end", "[cpu][lockstep]") {
+    for (auto const candidate_engine : {engine::interpreter, engine::blocks}) {
+        flat_memory reference;
+        flat_memory candidate;
+        load(reference);
+        load(candidate);
+        auto harness = lockstep{reference, candidate, candidate_engine};
+        harness.reference().reset();
+        harness.candidate().reset();
+
+        CHECK_FALSE(harness.run(1000).has_value());
+        CHECK(harness.candidate().retired() >= 1000);
+        CHECK(harness.reference().retired() == harness.candidate().retired());
+        CHECK(candidate.words == reference.words);
+    }
+}
+
+TEST_CASE("First difference stops the run and says where it happened", "[cpu][lockstep]") {
+    flat_memory reference;
+    flat_memory candidate;
+    load(reference);
+    load(candidate);
+    // stands in for an engine which got add wrong
+    candidate.words[1] = add_r0_2;
+    auto harness = lockstep{reference, candidate, engine::blocks};
+    harness.reference().reset();
+    harness.candidate().reset();
+
+    auto const found = harness.run(1000);
+    REQUIRE(found.has_value());
+    // whole first block goes before anything is compared
+    CHECK(found->instructions == 0);
+    CHECK(found->report.find("add r0, r0, #1") != std::string::npos);
+    CHECK(found->report.find("r0 ") != std::string::npos);
+}
+
+TEST_CASE("Writes are compared along with registers", "[cpu][lockstep]") {
+    flat_memory reference;
+    flat_memory candidate;
+    for (auto* const memory : {&reference, &candidate}) {
+        memory->words[0] = 0xe28f'0009; // add r0, pc, #9
+        memory->words[1] = 0xe12f'ff10; // bx r0
+        memory->set_hword(0x10, 0x2180); // mov r1, #0x80
+        memory->set_hword(0x12, 0x6008); // str r0, [r1]
+        memory->set_hword(0x14, 0xe7fe); // b 0x14
+    }
+    // stands in for an engine which stores too little, registers come out the same
+    candidate.set_hword(0x12, 0x8008); // strh r0, [r1]
+    auto harness = lockstep{reference, candidate, engine::blocks};
+    harness.reference().reset();
+    harness.candidate().reset();
+
+    auto const found = harness.run(1000);
+    REQUIRE(found.has_value());
+    CHECK(found->instructions == 3);
+    CHECK(found->report.find("(thumb)") != std::string::npos);
+    CHECK(found->report.find("r1 ") == std::string::npos);
+    CHECK(found->report.find("writes differ") != std::string::npos);
+}
@@ -0,0 +1,50 @@
+#include "emulator/cpu/opcodes.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <array>
+#include <utility>
+#include "emulator/cpudefines.hpp"
+using namespace fgba;
+using namespace fgba::cpu;
+using enum thumb_instruction::set;
+
+namespace {
+struct decoding_case {
+    u16 opcode;
+    thumb_instruction::set expected;
+};
+}
+
+TEST_CASE("Decoding every thumb format", "[cpu][thumb][decoding]") {
+    auto const [opcode, expected] = GENERATE(values<decoding_case>({
+        {0x0008, lsl_imm},  {0x0808, lsr_imm},  {0x1008, asr_imm},
+        {0x1888, add_reg},  {0x1a88, sub_reg},  {0x1c48, add_imm3}, {0x1e48, sub_imm3},
+        {0x2001, mov_imm},  {0x2801, cmp_imm},  {0x3001, add_imm},  {0x3801, sub_imm},
+        {0x4008, and_},     {0x4240, neg},      {0x4348, mul},      {0x43c8, mvn},
+        {0x4448, add_hi},   {0x4548, cmp_hi},   {0x46c0, mov_hi},   {0x4770, bx},
+        {0x4800, ldr_pc},
+        {0x5088, str_reg},  {0x5488, strb_reg}, {0x5888, ldr_reg},  {0x5c88, ldrb_reg},
+        {0x5288, strh_reg}, {0x5688, ldsb_reg}, {0x5a88, ldrh_reg}, {0x5e88, ldsh_reg},
+        {0x6008, str_imm},  {0x6808, ldr_imm},  {0x7008, strb_imm}, {0x7808, ldrb_imm},
+        {0x8008, strh_imm}, {0x8808, ldrh_imm}, {0x9000, str_sp},   {0x9800, ldr_sp},
+        {0xa000, add_pc},   {0xa800, add_sp},   {0xb080, add_sp_imm},
+        {0xb500, push},     {0xbd00, pop},      {0xc001, stmia},    {0xc801, ldmia},
+        {0xd0fe, b_cond},   {0xdf00, swi},      {0xde00, undefined},
+        {0xe7fe, b},        {0xf000, bl_hi},    {0xf800, bl_lo},
+    }));
+
+    CAPTURE(opcode);
+    CHECK(decode(thumb::instruction{hword{opcode}}).handle() == expected);
+}
+
+TEST_CASE("Decoding thumb alu operations", "[cpu][thumb][decoding]") {
+    constexpr std::array alu{
+        and_, eor, lsl, lsr, asr, adc, sbc, ror,
+        tst,  neg, cmp, cmn, orr, mul, bic, mvn,
+    };
+    for (u16 op = 0; op < alu.size(); ++op) {
+        auto const opcode = static_cast<u16>(0x4000 | op << 6 | 0b001'010);
+        CAPTURE(opcode);
+        CHECK(decode(thumb::instruction{hword{opcode}}).handle() == alu[op]);
+    }
+}
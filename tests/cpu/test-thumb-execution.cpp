@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include <initializer_list>
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpudefines.hpp"
+#include "flat-memory.hpp"
+using namespace fgba;
+using namespace fgba::cpu;
+using fgba::test::flat_memory;
+
+namespace {
+
+constexpr u32 thumb_start = 0x10;
+
+[[nodiscard]]auto nzcv(arm7tdmi const& cpu)
+    -> u32 { return cpu.get_regitsters_contents().cpsr().val >> 28; }
+[[nodiscard]]auto reg(arm7tdmi const& cpu, u32 const r)
+    -> u32 { return cpu.get_regitsters_contents()[r].value; }
+
+auto place(flat_memory& memory, u32 address, std::initializer_list<u16> const code)
+    -> void {
+    for (auto const opcode : code) {
+        memory.set_hword(address, opcode);
+        address += 2;
+    }
+}
+
+// arm code at reset goes straight to thumb_start, so the thumb code runs
+// from the state reset left behind, r0 aside
+auto enter_thumb(flat_memory& memory, arm7tdmi& cpu)
+    -> void {
+    memory.words[0] = 0xe28f'0009; // add r0, pc, #9
+    memory.words[1] = 0xe12f'ff10; // bx r0
+    cpu.connect_bus(connector{memory});
+    cpu.reset();
+    cpu.advance_execution();
+    cpu.advance_execution();
+}
+
+auto step(arm7tdmi& cpu, u32 const instructions)
+    -> void {
+    for (u32 i = 0; i < instructions; ++i) cpu.advance_execution();
+}
+
+}
+
+TEST_CASE("Thumb arithmetic sets all four flags", "[cpu][thumb][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    place(memory, thumb_start, {
+        0x2000, // mov r0, #0
+        0x2101, // mov r1, #1
+        0x1a42, // sub r2, r0, r1
+        0x0853, // lsr r3, r2, #1
+        0x1c5c, // add r4, r3, #1
+        0x2c00, // cmp r4, #0
+    });
+    enter_thumb(memory, cpu);
+    REQUIRE(cpu.get_regitsters_contents().is_thumb());
+
+    step(cpu, 1);
+    CHECK(nzcv(cpu) == 0b0100);
+    step(cpu, 2);
+    // borrow clears carry
+    CHECK(reg(cpu, 2) == 0xffff'ffff);
+    CHECK(nzcv(cpu) == 0b1000);
+    step(cpu, 1);
+    // carry is the last bit shifted out
+    CHECK(reg(cpu, 3) == 0x7fff'ffff);
+    CHECK(nzcv(cpu) == 0b0010);
+    step(cpu, 1);
+    CHECK(reg(cpu, 4) == 0x8000'0000);
+    CHECK(nzcv(cpu) == 0b1001);
+    step(cpu, 1);
+    CHECK(nzcv(cpu) == 0b1010);
+}
+
+TEST_CASE("Both halves of thumb bl make one call", "[cpu][thumb][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    place(memory, thumb_start, {
+        0xf000, // bl 0x40, upper half
+        0xf816, // bl 0x40, lower half
+        0x2109, // mov r1, #9
+    });
+    place(memory, 0x40, {
+        0x2007, // mov r0, #7
+        0x4770, // bx lr
+    });
+    enter_thumb(memory, cpu);
+
+    step(cpu, 1);
+    // first half only parks the upper part of the target in lr
+    CHECK(reg(cpu, registers::lr) == thumb_start + 4);
+    CHECK(reg(cpu, registers::pc) == thumb_start + 6);
+    step(cpu, 1);
+    // returns past the second half, and stays in thumb
+    CHECK(reg(cpu, registers::lr) == ((thumb_start + 4) | 1));
+    CHECK(reg(cpu, registers::pc) == 0x40 + 4);
+    step(cpu, 3);
+    CHECK(reg(cpu, 0) == 7);
+    CHECK(reg(cpu, 1) == 9);
+    CHECK(cpu.get_regitsters_contents().is_thumb());
+}
+
+TEST_CASE("Thumb pop with pc in the list jumps to what it popped", "[cpu][thumb][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    place(memory, thumb_start, {
+        0x2080, // mov r0, #0x80
+        0x4685, // mov sp, r0
+        0xbd02, // pop {r1, pc}
+    });
+    place(memory, 0x40, {
+        0x2205, // mov r2, #5
+    });
+    memory.words[0x80 / 4] = 0x1234;
+    // bit 0 is dropped, pop on armv4t can't leave thumb
+    memory.words[0x84 / 4] = 0x41;
+    enter_thumb(memory, cpu);
+
+    step(cpu, 3);
+    CHECK(reg(cpu, 1) == 0x1234);
+    CHECK(reg(cpu, registers::r13) == 0x88);
+    CHECK(reg(cpu, registers::pc) == 0x40 + 4);
+    step(cpu, 1);
+    CHECK(reg(cpu, 2) == 5);
+    CHECK(cpu.get_regitsters_contents().is_thumb());
+}
+
+TEST_CASE("Thumb halfword loads from odd addresses", "[cpu][thumb][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    place(memory, thumb_start, {
+        0x2080, // mov r0, #0x80
+        0x2101, // mov r1, #1
+        0x5e42, // ldrsh r2, [r0, r1]
+        0x5a44, // ldrh r4, [r0, r1]
+        0x2100, // mov r1, #0
+        0x5e43, // ldrsh r3, [r0, r1]
+    });
+    memory.set_hword(0x80, 0x80ff);
+    enter_thumb(memory, cpu);
+
+    step(cpu, 6);
+    // signed halfword from an odd address is a signed byte
+    CHECK(reg(cpu, 2) == 0xffff'ff80);
+    // unsigned one is rotated instead
+    CHECK(reg(cpu, 4) == 0xff00'0080);
+    CHECK(reg(cpu, 3) == 0xffff'80ff);
+}
+
+TEST_CASE("Thumb hi register operations on pc are jumps", "[cpu][thumb][execution]") {
+    flat_memory memory;
+    arm7tdmi cpu;
+    place(memory, thumb_start, {
+        0x2040, // mov r0, #0x40
+        0x4687, // mov pc, r0
+        0x2309, // mov r3, #9, skipped
+    });
+    place(memory, 0x40, {
+        0x2108, // mov r1, #8
+        0x448f, // add pc, r1
+        0x2309, // mov r3, #9, skipped
+    });
+    place(memory, 0x4e, {
+        0x2203, // mov r2, #3
+    });
+    enter_thumb(memory, cpu);
+
+    step(cpu, 2);
+    CHECK(reg(cpu, registers::pc) == 0x40 + 4);
+    // pc reads as the add plus 4
+    step(cpu, 2);
+    CHECK(reg(cpu, registers::pc) == 0x4e + 4);
+    step(cpu, 1);
+    CHECK(reg(cpu, 2) == 3);
+    CHECK(reg(cpu, 3) == 0);
+    CHECK(cpu.get_regitsters_contents().is_thumb());
+}
@@ -0,0 +1,85 @@
+#ifndef FGBA_TESTS_TEST_MACHINE_HPP_WQMZXHRTLB
+#define FGBA_TESTS_TEST_MACHINE_HPP_WQMZXHRTLB
+
+#include <bit>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <random>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "emulator/gbaemu.hpp"
+#include "fgba-defines.hpp"
+#include "fmt/format.h"
+
+namespace fgba::test {
+
+// file in the temp directory which is gone once the test is done with it
+class scratch_file {
+public:
+    explicit scratch_file(std::string_view const name)
+        : m_path{std::filesystem::temp_directory_path() / fmt::format("fgba-{}-{:08x}", name, std::random_device{}())} {}
+    scratch_file(std::string_view const name, std::span<std::byte const> const contents)
+        : scratch_file{name} {
+        auto file = std::ofstream{m_path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<char const*>(contents.data()), static_cast<std::streamsize>(contents.size())); //NOLINT
+    }
+    scratch_file(scratch_file const&) = delete;
+    auto operator=(scratch_file const&)
+        -> scratch_file& = delete;
+    ~scratch_file() {
+        auto ignored = std::error_code{};
+        std::filesystem::remove(m_path, ignored);
+    }
+    [[nodiscard]]auto path() const noexcept
+        -> std::filesystem::path const& { return m_path; }
+private:
+    std::filesystem::path m_path;
+};
+
+// Goes to thumb and then keeps adding keyinput plus one to r2, storing it at the start of iwram.
+// Keys held on any frame change every state after it.
+[[nodiscard]]inline auto counting_cartridge()
+    -> std::vector<std::byte> {
+    auto result = std::vector<std::byte>{};
+    auto const put = [&](u32 const value, u32 const size) {
+        for (u32 i = 0; i < size; ++i) result.push_back(static_cast<std::byte>(value >> (i * 8)));
+    };
+    put(0xe28f'0001, 4); // add r0, pc, #1
+    put(0xe12f'ff10, 4); // bx r0
+    for (u16 const opcode : std::initializer_list<u16>{
+        0x2103, // mov r1, #3
+        0x0609, // lsl r1, r1, #24
+        0x2404, // mov r4, #4
+        0x0624, // lsl r4, r4, #24
+        0x2513, // mov r5, #0x13
+        0x012d, // lsl r5, r5, #4
+        0x1964, // add r4, r4, r5
+        0x8823, // loop: ldrh r3, [r4]
+        0x18d2, // add r2, r2, r3
+        0x3201, // add r2, #1
+        0x600a, // str r2, [r1]
+        0xe7fa, // b loop
+    }) {
+        put(opcode, 2);
+    }
+    return result;
+}
+
+// cartridge loaded and the cpu where bios would have left it
+[[nodiscard]]inline auto boot(std::filesystem::path const& cartridge)
+    -> std::unique_ptr<gameboy_advance> {
+    auto gba = std::make_unique<gameboy_advance>();
+    gba->load_gamerom(cartridge);
+    gba->reset(true);
+    return gba;
+}
+
+} // namespace fgba::test
+
+#endif
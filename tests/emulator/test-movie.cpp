@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+#include "emulator/gbaemu.hpp"
+#include "emulator/movie.hpp"
+#include "test-machine.hpp"
+#include "utility/fatexception.hpp"
+using namespace fgba;
+using fgba::test::boot;
+using fgba::test::counting_cartridge;
+using fgba::test::scratch_file;
+
+TEST_CASE("Movies play back the frames they recorded", "[movie]") {
+    auto const cartridge = scratch_file{"cartridge", counting_cartridge()};
+    auto gba = boot(cartridge.path());
+    gba->run_frame();
+
+    auto recording = start_movie(*gba);
+    for (auto const keys : std::initializer_list<u16>{0b0, 0b1, 0b11, 0b1000'0000, 0b0}) {
+        gba->set_keys(keys);
+        recording.keys.push_back(keys);
+        gba->run_frame();
+    }
+    auto scratch = std::vector<std::byte>{};
+    auto const expected = state_checksum(*gba, scratch);
+
+    auto const file = scratch_file{"movie"};
+    write_movie(file.path(), recording);
+    auto const movie = read_movie(file.path());
+    CHECK(movie.keys == recording.keys);
+    CHECK(movie.start_state == recording.start_state);
+    CHECK(movie.cartridge_hash == recording.cartridge_hash);
+
+    auto replay = boot(cartridge.path());
+    start_replay(*replay, movie);
+    for (auto const keys : movie.keys) {
+        replay->set_keys(keys);
+        replay->run_frame();
+    }
+    CHECK(state_checksum(*replay, scratch) == expected);
+}
+
+TEST_CASE("Movies refuse to play on another cartridge", "[movie]") {
+    auto const cartridge = scratch_file{"cartridge", counting_cartridge()};
+    auto gba = boot(cartridge.path());
+    auto const movie = start_movie(*gba);
+
+    auto other_rom = counting_cartridge();
+    other_rom.push_back(std::byte{0xff});
+    auto const other = scratch_file{"cartridge", other_rom};
+    auto replay = boot(other.path());
+    CHECK_THROWS_AS(start_replay(*replay, movie), runtime_error);
+    // same cartridge goes through
+    auto same = boot(cartridge.path());
+    CHECK_NOTHROW(start_replay(*same, movie));
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <vector>
+#include "emulator/rewind-buffer.hpp"
+using namespace fgba;
+
+namespace {
+// stand in for a save state, a few bytes change from one to the next
+[[nodiscard]]auto state_at(u32 const frame)
+    -> std::vector<std::byte> {
+    auto state = std::vector<std::byte>(64 * 1024);
+    for (u32 i = 0; i < 16; ++i) {
+        state[(frame * 131 + i * 977) % state.size()] = static_cast<std::byte>(frame + i + 1);
+    }
+    state[0] = static_cast<std::byte>(frame);
+    return state;
+}
+}
+
+TEST_CASE("Stepping back walks snapshots in reverse", "[rewind]") {
+    auto rewind = rewind_buffer{{.memory_budget = 64 * 1024, .interval = 1}};
+    for (u32 frame = 0; frame < 10; ++frame) {
+        rewind.push(state_at(frame));
+    }
+    CHECK(rewind.depth() == 9);
+    // deltas are only as big as what changed
+    CHECK(rewind.bytes_used() < 9 * 256);
+    for (u32 frame = 9; frame-- > 0;) {
+        auto const state = rewind.step_back();
+        REQUIRE(state.has_value());
+        CHECK(std::ranges::equal(*state, state_at(frame)));
+    }
+    CHECK_FALSE(rewind.step_back().has_value());
+}
+
+TEST_CASE("Oldest snapshots go once the budget runs out", "[rewind]") {
+    auto rewind = rewind_buffer{{.memory_budget = 2048, .interval = 1}};
+    for (u32 frame = 0; frame < 200; ++frame) {
+        rewind.push(state_at(frame));
+        REQUIRE(rewind.bytes_used() <= 2048);
+    }
+    REQUIRE(rewind.depth() > 4);
+    REQUIRE(rewind.depth() < 199);
+    // whatever is left is still the most recent history
+    auto const depth = rewind.depth();
+    for (u32 step = 1; step <= depth; ++step) {
+        auto const state = rewind.step_back();
+        REQUIRE(state.has_value());
+        CHECK(std::ranges::equal(*state, state_at(199 - step)));
+    }
+}
+
+TEST_CASE("Snapshots are taken every interval frames", "[rewind]") {
+    auto rewind = rewind_buffer{{.memory_budget = 4096, .interval = 3}};
+    auto taken = 0;
+    for (u32 frame = 0; frame < 12; ++frame) {
+        if (rewind.frame_finished()) ++taken;
+    }
+    CHECK(taken == 4);
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <vector>
+#include "emulator/gbaemu.hpp"
+#include "emulator/save-state.hpp"
+#include "test-machine.hpp"
+#include "utility/fatexception.hpp"
+using namespace fgba;
+using fgba::test::boot;
+using fgba::test::counting_cartridge;
+using fgba::test::scratch_file;
+
+TEST_CASE("Loading a state puts the machine back where it was", "[save-state]") {
+    auto const compression = GENERATE(save_compression::none, save_compression::zero_runs);
+    auto const cartridge = scratch_file{"cartridge", counting_cartridge()};
+    auto gba = boot(cartridge.path());
+    gba->set_keys(0b1);
+    gba->run_frame();
+
+    auto const state = gba->save_state(compression);
+    auto const saved = gba->save_state();
+    auto const pc    = gba->dump_cpu_state().get_regitsters_contents().pc().value;
+    gba->set_keys(0b10);
+    gba->run_frame();
+    auto const later = gba->save_state();
+    REQUIRE(later != saved);
+
+    gba->load_state(state);
+    CHECK(gba->save_state() == saved);
+    CHECK(gba->dump_cpu_state().get_regitsters_contents().pc().value == pc);
+    // and it goes on the same way it did the first time, keys held are part of the state
+    gba->set_keys(0b10);
+    gba->run_frame();
+    CHECK(gba->save_state() == later);
+}
+
+TEST_CASE("Reset goes back to how the machine was at power on", "[save-state]") {
+    auto const cartridge = scratch_file{"cartridge", counting_cartridge()};
+    auto gba   = boot(cartridge.path());
+    auto fresh = boot(cartridge.path());
+    gba->set_keys(0b1);
+    gba->run_frame();
+    gba->reset(true);
+    gba->set_keys(0);
+    CHECK(gba->save_state() == fresh->save_state());
+}
+
+TEST_CASE("Run-ahead leaves the machine where a plain frame would", "[save-state][run-ahead]") {
+    auto const cartridge = scratch_file{"cartridge", counting_cartridge()};
+    auto ahead = boot(cartridge.path());
+    auto plain = boot(cartridge.path());
+    for (auto const keys : std::initializer_list<u16>{0b1, 0b11, 0b0}) {
+        ahead->set_keys(keys);
+        plain->set_keys(keys);
+        ahead->run_frame_ahead(2);
+        plain->run_frame();
+        CHECK(ahead->save_state() == plain->save_state());
+    }
+}
+
+TEST_CASE("States which don't fit are refused", "[save-state]") {
+    auto const cartridge = scratch_file{"cartridge", counting_cartridge()};
+    auto gba = boot(cartridge.path());
+    auto const state = gba->save_state();
+
+    auto other_version = state;
+    other_version[8] = std::byte{0x7f};
+    CHECK_THROWS_AS(gba->load_state(other_version), runtime_error);
+    auto const truncated = std::span{state}.first(state.size() / 2);
+    CHECK_THROWS_AS(gba->load_state(truncated), runtime_error);
+    CHECK_THROWS_AS(gba->load_state(std::span{state}.subspan(1)), runtime_error);
+}
@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+#include <utility>
+#include <vector>
+#include "emulator/scheduler.hpp"
+using namespace fgba;
+
+namespace {
+using event_log = std::vector<std::pair<event_type, u64>>;
+template<event_type Type>
+auto record(void* const context, u64 const deadline) noexcept
+    -> void {
+    static_cast<event_log*>(context)->emplace_back(Type, deadline);
+}
+}
+
+TEST_CASE("Events fire in deadline order once time reaches them", "[scheduler]") {
+    auto sched = scheduler{};
+    auto fired = event_log{};
+    sched.set_handler(event_type::ppu_hblank, record<event_type::ppu_hblank>, &fired);
+    sched.set_handler(event_type::ppu_line_end, record<event_type::ppu_line_end>, &fired);
+
+    sched.schedule_in(event_type::ppu_line_end, 20);
+    sched.schedule_in(event_type::ppu_hblank, 10);
+    CHECK(sched.next_deadline() == 10);
+
+    sched.advance(9);
+    CHECK(fired.empty());
+    // both are due, late ones still get their own deadline
+    sched.advance(30);
+    CHECK(fired == std::vector{
+        std::pair{event_type::ppu_hblank, u64{10}},
+        std::pair{event_type::ppu_line_end, u64{20}},
+    });
+    CHECK(sched.next_deadline() == scheduler::never);
+}
+
+TEST_CASE("Scheduling again moves the event and cancel drops it", "[scheduler]") {
+    auto sched = scheduler{};
+    auto fired = event_log{};
+    sched.set_handler(event_type::ppu_hblank, record<event_type::ppu_hblank>, &fired);
+
+    sched.schedule_in(event_type::ppu_hblank, 10);
+    sched.schedule_in(event_type::ppu_hblank, 50);
+    sched.advance(20);
+    CHECK(fired.empty());
+    CHECK(sched.is_scheduled(event_type::ppu_hblank));
+    sched.advance(30);
+    REQUIRE(fired.size() == 1);
+    CHECK(fired[0].second == 50);
+    CHECK_FALSE(sched.is_scheduled(event_type::ppu_hblank));
+
+    sched.schedule_in(event_type::ppu_hblank, 5);
+    sched.cancel(event_type::ppu_hblank);
+    sched.advance(100);
+    CHECK(fired.size() == 1);
+}
+
+TEST_CASE("Handlers can schedule their follow ups", "[scheduler]") {
+    auto sched = scheduler{};
+    auto count = 0;
+    struct context { scheduler* sched; int* count; } ctx{&sched, &count};
+    sched.set_handler(event_type::ppu_hblank, [](void* const self, u64 const deadline) noexcept {
+        auto& [sched, count] = *static_cast<context*>(self);
+        ++*count;
+        sched->schedule_at(event_type::ppu_hblank, deadline + 10);
+    }, &ctx);
+    sched.schedule_in(event_type::ppu_hblank, 10);
+
+    // one big step still fires every period it covered
+    sched.advance(95);
+    CHECK(count == 9);
+    CHECK(sched.next_deadline() == 100);
+}
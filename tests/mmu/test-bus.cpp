@@ -0,0 +1,56 @@
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include "emulator/cpudefines.hpp"
+#include "emulator/mmu/mmu.hpp"
+#include "emulator/ppu/ppu.hpp"
+#include "emulator/scheduler.hpp"
+using namespace fgba;
+using namespace fgba::mmu;
+
+namespace {
+struct machine {
+    memory_arena arena;
+    scheduler scheduler;
+    ppu::ppu ppu{scheduler, arena};
+    memory_managment_unit mmu{ppu, arena};
+};
+}
+
+TEST_CASE("Byte writes to palette and background tiles fill the whole halfword", "[mmu]") {
+    auto gba = std::make_unique<machine>();
+    gba->mmu.write<u8>(0x0500'0011, 0x3c);
+    CHECK(gba->mmu.read<u16>(0x0500'0010) == 0x3c3c);
+    gba->mmu.write<u8>(0x0600'0100, 0xa5);
+    CHECK(gba->mmu.read<u16>(0x0600'0100) == 0xa5a5);
+    // mirrors land in the same place
+    gba->mmu.write<u8>(0x0502'0020, 0x01);
+    CHECK(gba->mmu.read<u16>(0x0500'0020) == 0x0101);
+}
+
+TEST_CASE("Byte writes to oam and object tiles are ignored", "[mmu]") {
+    auto gba = std::make_unique<machine>();
+    gba->mmu.write<u16>(0x0700'0000, 0x1234);
+    gba->mmu.write<u8>(0x0700'0000, 0xff);
+    CHECK(gba->mmu.read<u16>(0x0700'0000) == 0x1234);
+    gba->mmu.write<u16>(0x0601'0000, 0);
+    gba->mmu.write<u16>(0x0601'7ffe, 0);
+    gba->mmu.write<u8>(0x0601'0000, 0xff);
+    gba->mmu.write<u8>(0x0601'7fff, 0xff);
+    CHECK(gba->mmu.read<u16>(0x0601'0000) == 0);
+    CHECK(gba->mmu.read<u16>(0x0601'7ffe) == 0);
+    // halfwords still go through
+    gba->mmu.write<u16>(0x0601'0000, 0x5678);
+    CHECK(gba->mmu.read<u16>(0x0601'0000) == 0x5678);
+}
+
+TEST_CASE("Unmapped memory reads back the last value on the bus", "[mmu]") {
+    auto gba = std::make_unique<machine>();
+    gba->mmu.write<u32>(0x0300'0000, 0xdead'beef);
+    auto bus = word{};
+    gba->mmu.memory_access_read(cpu::address{0x0300'0000_word}, cpu::data_size::word, bus);
+
+    gba->mmu.memory_access_read(cpu::address{0x1000'0000_word}, cpu::data_size::word, bus);
+    CHECK(bus.value == 0xdead'beef);
+    CHECK(gba->mmu.read<u16>(0x0100'0002) == 0xdead);
+    CHECK(gba->mmu.read<u8>(0x0100'0001) == 0xbe);
+}
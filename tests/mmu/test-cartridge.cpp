@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include "emulator/mmu/mapped-file.hpp"
+#include "emulator/mmu/mmu.hpp"
+#include "emulator/ppu/ppu.hpp"
+#include "emulator/scheduler.hpp"
+#include "utility/fatexception.hpp"
+using namespace fgba;
+using namespace fgba::mmu;
+
+namespace {
+// rom which removes itself once the test is done with it
+struct temporary_rom {
+    explicit temporary_rom(std::size_t size)
+        : path{std::filesystem::temp_directory_path() / "fgba-test-cartridge.gba"} {
+        auto file = std::ofstream{path, std::ios::binary | std::ios::trunc};
+        for (std::size_t i = 0; i < size; ++i) {
+            file.put(static_cast<char>(i * 7));
+        }
+    }
+    ~temporary_rom() { std::filesystem::remove(path); }
+    temporary_rom(temporary_rom const&) = delete;
+    auto operator=(temporary_rom const&) -> temporary_rom& = delete;
+
+    std::filesystem::path path;
+};
+
+struct machine {
+    memory_arena arena;
+    scheduler scheduler;
+    ppu::ppu ppu{scheduler, arena};
+    memory_managment_unit mmu{ppu, arena};
+};
+}
+
+TEST_CASE("Every wait state window reads the same cartridge", "[mmu][cartridge]") {
+    auto const rom = temporary_rom{0x102};
+    auto gba = std::make_unique<machine>();
+    gba->mmu.load_gamerom(rom.path);
+
+    for (u32 window : {0x0800'0000u, 0x0a00'0000u, 0x0c00'0000u}) {
+        CAPTURE(window);
+        CHECK(gba->mmu.read<u8>(window + 0x03) == 0x15);
+        CHECK(gba->mmu.read<u16>(window + 0x10) == 0x7770);
+        CHECK(gba->mmu.read<u32>(window + 0x20) == 0xf5ee'e7e0);
+        // last halfword doesn't make a whole word, slow path picks it up
+        CHECK(gba->mmu.read<u16>(window + 0x100) == 0x0700);
+    }
+}
+
+TEST_CASE("Reads past the end of the cartridge are open bus", "[mmu][cartridge]") {
+    auto const rom = temporary_rom{0x100};
+    auto gba = std::make_unique<machine>();
+    gba->mmu.load_gamerom(rom.path);
+
+    CHECK(gba->mmu.read<u16>(0x0800'0100) == 0x0080);
+    CHECK(gba->mmu.read<u32>(0x0800'0100) == 0x0081'0080);
+    CHECK(gba->mmu.read<u8>(0x0800'0203) == 0x01);
+    CHECK(gba->mmu.read<u16>(0x0900'0246) == 0x0123);
+}
+
+TEST_CASE("Without a cartridge the whole window is open bus", "[mmu][cartridge]") {
+    auto gba = std::make_unique<machine>();
+    CHECK(gba->mmu.read<u16>(0x0800'0000) == 0x0000);
+    CHECK(gba->mmu.read<u32>(0x0800'1234) == 0x091b'091a);
+}
+
+TEST_CASE("Cartridges which can't be mapped are refused", "[mmu][cartridge]") {
+    CHECK_THROWS_AS(mapped_file{"this/rom/does/not/exist.gba"}, runtime_error);
+    auto const empty = temporary_rom{0};
+    CHECK_THROWS_AS(mapped_file{empty.path}, runtime_error);
+}
@@ -0,0 +1,35 @@
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include "emulator/mmu/keypad.hpp"
+#include "emulator/mmu/mmu.hpp"
+#include "emulator/ppu/ppu.hpp"
+#include "emulator/scheduler.hpp"
+using namespace fgba;
+using namespace fgba::mmu;
+
+TEST_CASE("Keyinput is active low", "[mmu][keypad]") {
+    auto pad = keypad{};
+    CHECK(pad.keyinput() == keypad::all_keys);
+    pad.set_pressed(key_mask(key::a) | key_mask(key::up));
+    CHECK(pad.keyinput() == (keypad::all_keys & ~(key_mask(key::a) | key_mask(key::up))));
+    // there are only ten buttons
+    pad.set_pressed(0xffff);
+    CHECK(pad.keyinput() == 0);
+}
+
+TEST_CASE("Keypad is reachable through io", "[mmu][keypad]") {
+    auto arena = std::make_unique<memory_arena>();
+    auto sched = std::make_unique<scheduler>();
+    auto ppu   = std::make_unique<ppu::ppu>(*sched, *arena);
+    auto mmu   = std::make_unique<memory_managment_unit>(*ppu, *arena);
+    CHECK(mmu->read<u16>(keypad::keyinput_addr) == 0x03ff);
+    mmu->get_keypad().set_pressed(key_mask(key::start));
+    CHECK(mmu->read<u16>(keypad::keyinput_addr) == 0x03f7);
+    CHECK(mmu->read<u8>(keypad::keyinput_addr) == 0xf7);
+
+    // keyinput is read only
+    mmu->write<u16>(keypad::keyinput_addr, 0);
+    CHECK(mmu->read<u16>(keypad::keyinput_addr) == 0x03f7);
+    mmu->write<u16>(keypad::keycnt_addr, 0xffff);
+    CHECK(mmu->read<u16>(keypad::keycnt_addr) == 0xc3ff);
+}
@@ -0,0 +1,32 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <cstddef>
+#include "emulator/cpudefines.hpp"
+#include "emulator/mmu/memory-arena.hpp"
+#include "emulator/mmu/memoryprimitives.hpp"
+#include "emulator/mmu/mmu.hpp"
+using namespace fgba;
+using namespace fgba::mmu;
+
+TEST_CASE("Fresh memory is either zeroes or poison", "[mmu][memory]") {
+    auto zeroed_arena = memory_arena{mem_fill::zero};
+    auto const zeroed = zeroed_arena.claim<ewram_spec>();
+    CHECK(std::ranges::all_of(zeroed, [](std::byte b) { return b == std::byte{0}; }));
+
+    auto poisoned_arena = memory_arena{mem_fill::poison};
+    auto const poisoned = poisoned_arena.claim<ewram_spec>();
+    CHECK(std::ranges::all_of(poisoned, [](std::byte b) { return b == uninitialized_byte; }));
+}
+
+TEST_CASE("Arena lays regions out like the address map", "[mmu][memory]") {
+    auto arena = memory_arena{mem_fill::zero};
+    auto ewram = arena.claim<ewram_spec>();
+    auto sram  = arena.claim<sram_spec>();
+    CHECK(ewram.data() == arena.base() + (std::size_t{0x2} << memory_arena::slot_shift));
+    CHECK(sram.data() == arena.base() + (std::size_t{0xe} << memory_arena::slot_shift));
+    CHECK(arena.region(0x2).size() == ewram_spec::bounds::size);
+    CHECK(arena.region(0x3).empty());
+
+    ewram.data()[0x100] = std::byte{0x42};
+    CHECK(arena.region(0x2)[0x100] == std::byte{0x42});
+}
@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include "emulator/cpu/arm7tdmi.hpp"
+#include "emulator/cpudefines.hpp"
+#include "emulator/mmu/mmu.hpp"
+#include "emulator/mmu/waitstates.hpp"
+#include "emulator/ppu/ppu.hpp"
+#include "emulator/scheduler.hpp"
+using namespace fgba;
+using namespace fgba::mmu;
+using cpu::data_size;
+
+TEST_CASE("Internal memory timings don't depend on waitcnt", "[mmu][waitstates]") {
+    auto table = waitstate_table{};
+    table.set_waitcnt(0x4317);
+    CHECK(table.cycles(0x0300'0000, data_size::word, false) == 1);
+    CHECK(table.cycles(0x0200'0000, data_size::hword, false) == 3);
+    CHECK(table.cycles(0x0200'0000, data_size::word, true) == 6);
+    CHECK(table.cycles(0x0600'0000, data_size::hword, false) == 1);
+    CHECK(table.cycles(0x0600'0000, data_size::word, false) == 2);
+}
+
+TEST_CASE("Cartridge timings follow waitcnt", "[mmu][waitstates]") {
+    auto table = waitstate_table{};
+    // power on, 4/2 for ws0, 4/4 for ws1, 4/8 for ws2, 4 for sram
+    CHECK(table.cycles(0x0800'0000, data_size::hword, false) == 5);
+    CHECK(table.cycles(0x0800'0000, data_size::hword, true) == 3);
+    CHECK(table.cycles(0x0900'0000, data_size::word, false) == 8);
+    CHECK(table.cycles(0x0a00'0000, data_size::hword, true) == 5);
+    CHECK(table.cycles(0x0d00'0000, data_size::hword, true) == 9);
+    CHECK(table.cycles(0x0e00'0000, data_size::word, false) == 5);
+
+    // what most games use, 3/1 for ws0 and 8 for sram
+    table.set_waitcnt(0x4317);
+    CHECK(table.cycles(0x0800'0000, data_size::hword, false) == 4);
+    CHECK(table.cycles(0x0800'0000, data_size::hword, true) == 2);
+    CHECK(table.cycles(0x0800'0000, data_size::word, false) == 6);
+    CHECK(table.cycles(0x0800'0000, data_size::word, true) == 4);
+    CHECK(table.cycles(0x0e00'0000, data_size::byte, false) == 9);
+}
+
+TEST_CASE("Waitcnt is reachable through io and accesses in a row are sequential", "[mmu][waitstates]") {
+    auto arena = std::make_unique<memory_arena>();
+    auto sched = std::make_unique<scheduler>();
+    auto ppu   = std::make_unique<ppu::ppu>(*sched, *arena);
+    auto mmu   = std::make_unique<memory_managment_unit>(*ppu, *arena);
+    mmu->write<u16>(waitstate_table::waitcnt_addr, 0x4317);
+    CHECK(mmu->read<u16>(waitstate_table::waitcnt_addr) == 0x4317);
+
+    auto data = word{};
+    CHECK(mmu->memory_access_read(cpu::address{0x0800'0000_word}, data_size::word, data) == 6);
+    CHECK(mmu->memory_access_read(cpu::address{0x0800'0004_word}, data_size::word, data) == 4);
+    CHECK(mmu->memory_access_read(cpu::address{0x0800'0010_word}, data_size::word, data) == 6);
+}
+
+TEST_CASE("Multiplier stops early on small operands", "[cpu][waitstates]") {
+    CHECK(cpu::multiplier_cycles(0x0000'00ff_word) == 1);
+    CHECK(cpu::multiplier_cycles(0xffff'ff80_word) == 1);
+    CHECK(cpu::multiplier_cycles(0xffff'ff80_word, false) == 4);
+    CHECK(cpu::multiplier_cycles(0x0000'ff00_word) == 2);
+    CHECK(cpu::multiplier_cycles(0x00ff'0000_word) == 3);
+    CHECK(cpu::multiplier_cycles(0x1200'0000_word) == 4);
+}
@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+#include "emulator/cpudefines.hpp"
+#include "emulator/ppu/color-conversion.hpp"
+#include "fgba-defines.hpp"
+using namespace fgba;
+using namespace fgba::ppu;
+
+namespace {
+struct single_pixel_case {
+    pixel_format format;
+    std::vector<std::byte> expected;
+};
+[[nodiscard]]auto bytes(std::initializer_list<u8> const values)
+    -> std::vector<std::byte> {
+    auto ret = std::vector<std::byte>{};
+    for (auto value : values) ret.push_back(static_cast<std::byte>(value));
+    return ret;
+}
+}
+
+TEST_CASE("Color conversion of a single pixel", "[ppu][color]") {
+    // r = 31, g = 1, b = 16, top bit is ignored
+    auto const source = bytes({0x3f, 0xc0});
+    auto const [format, expected] = GENERATE(values<single_pixel_case>({
+        {pixel_format::rgb888,   bytes({0xf8, 0x08, 0x80})},
+        {pixel_format::rgba8888, bytes({0xf8, 0x08, 0x80, 0xff})},
+        {pixel_format::bgra8888, bytes({0x80, 0x08, 0xf8, 0xff})},
+        // r << 11 | g << 6 | b, little endian
+        {pixel_format::rgb565,   bytes({0x50, 0xf8})},
+        {pixel_format::bgr555,   bytes({0x3f, 0xc0})},
+    }));
+    auto destination = std::vector<std::byte>(bytes_per_pixel(format));
+    convert_bgr555(conversion_kernel::scalar, format, source, destination.data());
+    CHECK(destination == expected);
+}
+
+TEST_CASE("Every color conversion kernel agrees with the scalar one", "[ppu][color]") {
+    auto const kernel = GENERATE(conversion_kernel::sse2, conversion_kernel::avx2);
+    if (not is_supported(kernel)) SKIP("kernel isn't supported here");
+    auto const format = GENERATE(
+        pixel_format::rgb888, pixel_format::rgba8888, pixel_format::bgra8888,
+        pixel_format::rgb565, pixel_format::bgr555
+    );
+    // lengths around vector widths, so tails get their share
+    auto const pixels = GENERATE(std::size_t{1}, 7, 8, 9, 15, 16, 17, 31, 240);
+
+    auto source = std::vector<std::byte>(pixels * 2);
+    u32 seed = 0x1234'5678;
+    for (auto& byte : source) {
+        seed = seed * 1'103'515'245 + 12'345;
+        byte = static_cast<std::byte>(seed >> 16);
+    }
+    // canary after the end makes sure nothing is written past the last pixel
+    auto expected = std::vector<std::byte>(pixels * bytes_per_pixel(format) + 32, std::byte{0xeb});
+    auto actual   = expected;
+    convert_bgr555(conversion_kernel::scalar, format, source, expected.data());
+    convert_bgr555(kernel, format, source, actual.data());
+
+    CAPTURE(pixels, format);
+    CHECK(actual == expected);
+}
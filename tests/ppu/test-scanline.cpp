@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include "emulator/cpudefines.hpp"
+#include "emulator/mmu/mmu.hpp"
+#include "emulator/ppu/ppu.hpp"
+#include "emulator/scheduler.hpp"
+using namespace fgba;
+
+namespace {
+
+constexpr u32 dispcnt_address  = 0x0400'0000;
+constexpr u32 dispstat_address = 0x0400'0004;
+constexpr u32 vcount_address   = 0x0400'0006;
+constexpr u32 vram_address     = 0x0600'0000;
+// mode 3 with bg2 on
+constexpr u16 bitmap_mode      = 0x0403;
+
+[[nodiscard]]auto red_of(ppu::ppu const& ppu, u32 x, u32 y)
+    -> u32 {
+    auto const view = ppu.get_display_view();
+    REQUIRE(view.format == pixel_format::rgba8888);
+    return std::to_integer<u32>(view.rows.data_handle()[y * view.rows.extent(1) + x * 4]);
+}
+
+struct machine {
+    machine() { ppu.set_pixel_format(pixel_format::rgba8888); }
+    mmu::memory_arena arena;
+    scheduler scheduler;
+    ppu::ppu ppu{scheduler, arena};
+    mmu::memory_managment_unit mmu{ppu, arena};
+};
+
+}
+
+TEST_CASE("Beam walks through the frame", "[ppu]") {
+    auto gba = std::make_unique<machine>();
+    auto& [arena, scheduler, ppu, mmu] = *gba;
+
+    CHECK(mmu.read<u16>(vcount_address) == 0);
+    scheduler.advance(ppu::hdraw_cycles);
+    CHECK((mmu.read<u16>(dispstat_address) & 0b010) != 0);
+    scheduler.advance(ppu::hblank_cycles);
+    CHECK(mmu.read<u16>(vcount_address) == 1);
+    CHECK((mmu.read<u16>(dispstat_address) & 0b010) == 0);
+
+    scheduler.advance(ppu::cycles_per_line * (ppu::screen_height - 1));
+    CHECK(mmu.read<u16>(vcount_address) == ppu::screen_height);
+    CHECK((mmu.read<u16>(dispstat_address) & 0b001) != 0);
+
+    scheduler.advance(ppu::cycles_per_line * (ppu::lines_per_frame - ppu::screen_height));
+    CHECK(mmu.read<u16>(vcount_address) == 0);
+    CHECK((mmu.read<u16>(dispstat_address) & 0b001) == 0);
+}
+
+TEST_CASE("Vcount match and read only status bits", "[ppu]") {
+    auto gba = std::make_unique<machine>();
+    auto& [arena, scheduler, ppu, mmu] = *gba;
+
+    mmu.write<u16>(dispstat_address, 0x0507);
+    CHECK(mmu.read<u16>(dispstat_address) == 0x0500);
+    scheduler.advance(ppu::cycles_per_line * 5);
+    CHECK(mmu.read<u16>(dispstat_address) == 0x0504);
+}
+
+TEST_CASE("Lines are redrawn only when what they show changes", "[ppu]") {
+    auto gba = std::make_unique<machine>();
+    auto& [arena, scheduler, ppu, mmu] = *gba;
+
+    mmu.write<u16>(dispcnt_address, bitmap_mode);
+    mmu.write<u16>(vram_address, 0x001f);
+    scheduler.advance(ppu::cycles_per_frame);
+    REQUIRE(red_of(ppu, 0, 0) == 0xf8);
+    // write happened on the same line it was drawn, that is worth one more redraw
+    scheduler.advance(ppu::cycles_per_frame);
+
+    // goes around the mmu, so ppu can't know about it
+    constexpr u16 sneaky = 0x0001;
+    std::memcpy(ppu.get_vram().data(), &sneaky, sizeof(sneaky));
+    scheduler.advance(ppu::cycles_per_frame);
+    CHECK(red_of(ppu, 0, 0) == 0xf8);
+
+    mmu.write<u16>(vram_address + 2, 0x0002);
+    scheduler.advance(ppu::cycles_per_frame);
+    CHECK(red_of(ppu, 0, 0) == 0x08);
+    CHECK(red_of(ppu, 1, 0) == 0x10);
+
+    // forced blank changes the control bits, everything is redrawn white
+    mmu.write<u16>(dispcnt_address, bitmap_mode | 0x80);
+    scheduler.advance(ppu::cycles_per_frame);
+    CHECK(red_of(ppu, 0, 100) == 0xf8);
+}
+
+TEST_CASE("Finished frames are handed off at vblank", "[ppu]") {
+    auto gba = std::make_unique<machine>();
+    auto& [arena, scheduler, ppu, mmu] = *gba;
+    auto& frames = ppu.get_frames();
+    // power on picture
+    REQUIRE(frames.acquire());
+
+    mmu.write<u16>(dispcnt_address, bitmap_mode);
+    mmu.write<u16>(vram_address, 0x001f);
+    scheduler.advance(ppu::cycles_per_line * ppu::screen_height - 1);
+    CHECK_FALSE(frames.acquire());
+    scheduler.advance(1);
+    REQUIRE(frames.acquire());
+
+    auto const& frame = frames.front();
+    CHECK(frame.number == 1);
+    CHECK(frame.format == pixel_format::rgba8888);
+    CHECK(std::to_integer<u32>(frame.view().rows.data_handle()[0]) == 0xf8);
+}
+
+TEST_CASE("Frames which are going to be rolled back are not handed off", "[ppu]") {
+    auto gba = std::make_unique<machine>();
+    auto& [arena, scheduler, ppu, mmu] = *gba;
+    auto& frames = ppu.get_frames();
+    REQUIRE(frames.acquire());
+
+    ppu.set_frame_publishing(false);
+    scheduler.advance(ppu::cycles_per_frame);
+    CHECK_FALSE(frames.acquire());
+    ppu.set_frame_publishing(true);
+    scheduler.advance(ppu::cycles_per_frame);
+    REQUIRE(frames.acquire());
+    // the hidden one still happened
+    CHECK(frames.front().number == 2);
+}
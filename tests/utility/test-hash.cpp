@@ -0,0 +1,23 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <vector>
+#include "utility/hash.hpp"
+using namespace fgba;
+
+TEST_CASE("Hash tells blobs apart", "[utility][hash]") {
+    auto data = std::vector<std::byte>(4099);
+    for (std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<std::byte>(i * 7);
+    auto const hash = hash_bytes(data);
+    CHECK(hash == hash_bytes(data));
+    CHECK(hash != hash_bytes(data, 1));
+    // a bit flipped anywhere, tail included, shows up
+    for (auto const at : {std::size_t{0}, std::size_t{2048}, data.size() - 1}) {
+        auto changed = data;
+        changed[at] ^= std::byte{1};
+        CHECK(hash != hash_bytes(changed));
+    }
+    // trailing zeroes still count
+    auto longer = data;
+    longer.push_back(std::byte{0});
+    CHECK(hash != hash_bytes(longer));
+}
@@ -0,0 +1,41 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <thread>
+#include "utility/spsc-queue.hpp"
+using namespace fgba;
+
+TEST_CASE("Spsc queue keeps order and refuses when full", "[utility]") {
+    auto queue = spsc_queue<int, 4>{};
+    CHECK_FALSE(queue.try_pop().has_value());
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.try_push(i));
+    }
+    CHECK_FALSE(queue.try_push(4));
+
+    CHECK(queue.try_pop() == 0);
+    CHECK(queue.try_push(4));
+    for (int i = 1; i <= 4; ++i) {
+        CHECK(queue.try_pop() == i);
+    }
+    CHECK_FALSE(queue.try_pop().has_value());
+}
+
+TEST_CASE("Spsc queue loses nothing between threads", "[utility]") {
+    constexpr std::uint32_t count = 200'000;
+    auto queue = spsc_queue<std::uint32_t, 64>{};
+
+    auto producer = std::jthread{[&] {
+        for (std::uint32_t i = 0; i < count; ++i) {
+            while (not queue.try_push(i)) {}
+        }
+    }};
+    std::uint32_t expected = 0;
+    bool in_order = true;
+    while (expected != count) {
+        auto const value = queue.try_pop();
+        if (not value.has_value()) continue;
+        in_order = in_order and *value == expected;
+        ++expected;
+    }
+    CHECK(in_order);
+}
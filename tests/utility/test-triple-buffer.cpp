@@ -0,0 +1,54 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <thread>
+#include "utility/triple-buffer.hpp"
+using namespace fgba;
+
+TEST_CASE("Triple buffer hands over the newest value", "[utility]") {
+    auto buffer = triple_buffer<int>{};
+    CHECK_FALSE(buffer.acquire());
+
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+    REQUIRE(buffer.acquire());
+    CHECK(buffer.front() == 2);
+    // nothing new, front stays where it was
+    CHECK_FALSE(buffer.acquire());
+    CHECK(buffer.front() == 2);
+
+    buffer.back() = 3;
+    buffer.publish();
+    REQUIRE(buffer.acquire());
+    CHECK(buffer.front() == 3);
+}
+
+TEST_CASE("Triple buffer never hands out a half written value", "[utility]") {
+    struct value {
+        std::uint64_t first;
+        std::uint64_t payload[15];
+        std::uint64_t last;
+    };
+    constexpr std::uint64_t count = 200'000;
+    auto buffer = triple_buffer<value>{};
+
+    auto producer = std::jthread{[&] {
+        for (std::uint64_t i = 1; i <= count; ++i) {
+            auto& back = buffer.back();
+            back.first = i;
+            for (auto& word : back.payload) word = i;
+            back.last = i;
+            buffer.publish();
+        }
+    }};
+    std::uint64_t seen = 0;
+    bool torn = false;
+    while (seen != count) {
+        if (not buffer.acquire()) continue;
+        auto const& front = buffer.front();
+        torn = torn or front.first != front.last or front.first < seen;
+        seen = front.first;
+    }
+    CHECK_FALSE(torn);
+}
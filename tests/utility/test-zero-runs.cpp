@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <vector>
+#include "utility/zero-runs.hpp"
+using namespace fgba;
+
+namespace {
+[[nodiscard]]auto round_trip(std::vector<std::byte> const& data)
+    -> bool {
+    auto encoded = std::vector<std::byte>{};
+    zero_runs_encode(data, encoded);
+    auto decoded = std::vector<std::byte>(data.size(), std::byte{0xcc});
+    return zero_runs_decode(encoded, decoded) and decoded == data;
+}
+}
+
+TEST_CASE("Zero runs survive a round trip", "[utility][zero-runs]") {
+    CHECK(round_trip({}));
+    CHECK(round_trip(std::vector<std::byte>(4096)));
+    CHECK(round_trip(std::vector<std::byte>(13, std::byte{0x5a})));
+
+    // literals with short gaps, long gaps and a few zeroes right at the end
+    auto mixed = std::vector<std::byte>(1000);
+    for (std::size_t i = 0; i < mixed.size(); ++i) {
+        if (i % 97 < 40 and i % 5 != 0) mixed[i] = static_cast<std::byte>(i);
+    }
+    mixed[997] = std::byte{1};
+    CHECK(round_trip(mixed));
+}
+
+TEST_CASE("Mostly empty memory shrinks to almost nothing", "[utility][zero-runs]") {
+    auto memory = std::vector<std::byte>(256 * 1024);
+    memory[0x1000] = std::byte{0x12};
+    memory[0x3'0000] = std::byte{0x34};
+    auto encoded = std::vector<std::byte>{};
+    zero_runs_encode(memory, encoded);
+    CHECK(encoded.size() < 16);
+}
+
+TEST_CASE("Broken streams are refused", "[utility][zero-runs]") {
+    auto data = std::vector<std::byte>(64, std::byte{0x11});
+    auto encoded = std::vector<std::byte>{};
+    zero_runs_encode(data, encoded);
+
+    auto too_small = std::vector<std::byte>(32);
+    CHECK_FALSE(zero_runs_decode(encoded, too_small));
+    auto too_big = std::vector<std::byte>(65);
+    CHECK_FALSE(zero_runs_decode(encoded, too_big));
+    encoded.pop_back();
+    CHECK_FALSE(zero_runs_decode(encoded, data));
+}